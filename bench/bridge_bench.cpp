@@ -0,0 +1,557 @@
+// Headless bridge benchmark: starts a NodeThread without the QML engine and drives
+// testPing / testDelayedPing (js/src/test.js) with a fixed number of requests in flight.
+// Reports round-trip latency percentiles, throughput and C++ heap allocations per message.
+//
+//   bridge_bench --action ping --messages 20000 --concurrency 8 --payload 256
+//   bridge_bench --action delayed --delay 5 --concurrency 64 --json
+//   bridge_bench --compare 200          # native fast path vs Node, per claimed action
+//   bridge_bench --registry 100000      # heap allocations per CallbackRegistry add/take, must be 0
+//   bridge_bench --startup queued --gui-work 400   # startup order, see startupBench()
+//   bridge_bench --lanes 5000           # interactive latency under a background flood, timeouts
+//
+// The crypto actions (keccak, address, mnemonic) measure crypto0.js on __nativeCrypto;
+// run them again with NODE_NATIVE_CRYPTO=0 for the ethers path. --warmup 0 keeps the
+// first request, which pays for loading ethers, in the figures.
+//
+// Startup time and the idle V8 heap cover the core bundle only; with --warmup 0, "first"
+// includes loading the chunk that handles the action (js/src/ChunkLoader.ts).
+//
+//   bridge_bench --action mnemonic --messages 50 --warmup 0
+
+#include "include/bridge_metrics.h"
+#include "include/callback_registry.h"
+#include "include/native_handlers.h"
+#include "include/node_thread.h"
+#include "include/sysfs_handlers.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSemaphore>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Counts every C++ heap allocation in the process (Qt, Node, V8's C++ side; not the V8
+// JS heap, which is mmap-backed). Relaxed atomics keep the counting itself cheap.
+static std::atomic<quint64> s_allocations{0};
+
+void *operator new(std::size_t size) {
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+	std::free(p);
+}
+
+static qint64 nowNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Closed-loop driver: keeps `concurrency` requests in flight until `total` have completed.
+// Completions arrive on the Node thread and immediately send the next request from there.
+class BenchRun {
+public:
+	BenchRun(NodeThread *thread, const QString &action, const QJsonObject &params, int total, int concurrency) : m_thread(thread), m_action(action), m_params(params), m_total(total), m_concurrency(qMax(1, concurrency)), m_latenciesNs(size_t(total)), m_errors(0), m_sent(0), m_completed(0) {}
+
+	void run() {
+		const int initial = qMin(m_concurrency, m_total);
+		for (int i = 0; i < initial; i++) sendNext();
+		m_done.acquire();
+	}
+
+	const std::vector<qint64> &latencies() const { return m_latenciesNs; }
+	int errors() const { return m_errors.load(); }
+
+private:
+	void sendNext() {
+		const int index = m_sent.fetch_add(1);
+		if (index >= m_total) return;
+		const qint64 started = nowNs();
+		m_thread->sendMessage(m_action, m_params, [this, index, started](const QJsonObject &result) {
+			m_latenciesNs[size_t(index)] = nowNs() - started;
+			if (result.value("status").toString() != QLatin1String("success")) m_errors.fetch_add(1);
+			if (m_completed.fetch_add(1) + 1 == m_total) m_done.release();
+			else sendNext();
+		});
+	}
+
+	NodeThread *m_thread;
+	const QString m_action;
+	const QJsonObject m_params;
+	const int m_total;
+	const int m_concurrency;
+	std::vector<qint64> m_latenciesNs;
+	std::atomic<int> m_errors;
+	std::atomic<int> m_sent;
+	std::atomic<int> m_completed;
+	QSemaphore m_done;
+};
+
+static double percentileUs(const std::vector<qint64> &sorted, double p) {
+	if (sorted.empty()) return 0;
+	const size_t rank = size_t(p * double(sorted.size() - 1));
+	return double(sorted[rank]) / 1000.0;
+}
+
+// Sequential requests through the native handler registry; empty if the handler declines
+static std::vector<qint64> runNative(NativeHandlerRegistry &registry, const QString &action, int count) {
+	std::vector<qint64> latencies;
+	latencies.reserve(size_t(count));
+	QSemaphore done;
+	bool declined = false;
+	for (int i = 0; i < count && !declined; i++) {
+		const qint64 started = nowNs();
+		registry.dispatch(action, QJsonObject(), [&](const std::optional<QJsonObject> &result) {
+			if (result) latencies.push_back(nowNs() - started);
+			else declined = true;
+			done.release();
+		});
+		done.acquire();
+	}
+	if (declined) latencies.clear();
+	return latencies;
+}
+
+// Native fast path vs the JS handler for every action the sysfs handlers claim
+static QJsonObject compareNative(NodeThread *thread, int count) {
+	NativeHandlerRegistry registry;
+	registerSysfsHandlers(registry);
+
+	QJsonObject actions;
+	for (const QString &action : registry.actions()) {
+		std::vector<qint64> native = runNative(registry, action, count);
+		BenchRun node(thread, action, QJsonObject(), count, 1);
+		node.run();
+		std::vector<qint64> viaNode = node.latencies();
+		std::sort(native.begin(), native.end());
+		std::sort(viaNode.begin(), viaNode.end());
+
+		QJsonObject entry{{"node", QJsonObject{{"p50Us", percentileUs(viaNode, 0.50)}, {"p99Us", percentileUs(viaNode, 0.99)}, {"errors", node.errors()}}}};
+		// Declined on this machine (e.g. no backlight), so there is nothing to compare
+		entry.insert("native", native.empty() ? QJsonValue() : QJsonValue(QJsonObject{{"p50Us", percentileUs(native, 0.50)}, {"p99Us", percentileUs(native, 0.99)}}));
+		actions.insert(action, entry);
+	}
+	return actions;
+}
+
+// add/take round trips on the callback registry, with and without a deadline. The callback
+// captures one pointer, like NodeJS::msg()'s, so std::function keeps it inline. Returns the
+// heap allocations counted while they ran.
+static quint64 registryAllocations(CallbackRegistry &registry, int roundTrips, int *fired) {
+	const quint64 before = s_allocations.load();
+	for (int i = 0; i < roundTrips; i++) {
+		const qint64 deadline = (i & 1) ? CallbackRegistry::now() + 1000 : 0;
+		const quint64 id = registry.add([fired](const QJsonObject &) { (*fired)++; }, deadline, CallbackTrace{nullptr, i, 0});
+		registry.markStarted(id, i + 1);
+		CallbackTrace trace;
+		CallbackRegistry::Callback callback = registry.take(id, &trace);
+		if (callback) callback(QJsonObject());
+	}
+	return s_allocations.load() - before;
+}
+
+// Time to the first reply and to the first frame, from initialize(). The GUI thread's own
+// startup (QML engine, first frame) is stood in for by sleeping guiWorkMs on this thread.
+//   blocking: the order before the pre-init queue. The caller waits for ready() like the old
+//             blocking msg() did, then does the GUI work and sends the first request.
+//   queued:   the order main() uses now. The first request is queued right after
+//             initialize() and the GUI work runs while Node boots.
+// Node can be set up once per process, so each mode needs its own run.
+static QJsonObject startupBench(bool queued, int guiWorkMs) {
+	NodeThread thread;
+	QSemaphore ready;
+	QSemaphore replied;
+	std::atomic<bool> failed{false};
+	std::atomic<qint64> readyNs{0};
+	std::atomic<qint64> replyNs{0};
+	QObject::connect(
+		&thread, &NodeThread::ready, &thread,
+		[&]() {
+			readyNs = nowNs();
+			ready.release();
+		},
+		Qt::DirectConnection);
+	QObject::connect(
+		&thread, &NodeThread::initializationFailed, &thread,
+		[&](const QString &error) {
+			qCritical() << "bridge_bench:" << error;
+			failed = true;
+			ready.release();
+			replied.release();
+		},
+		Qt::DirectConnection);
+	auto onReply = [&](const QJsonObject &) {
+		replyNs = nowNs();
+		replied.release();
+	};
+
+	const qint64 begin = nowNs();
+	if (!thread.initialize()) return QJsonObject();
+	const qint64 initializeNs = nowNs() - begin;
+	qint64 blockedNs = initializeNs;
+	qint64 frameNs = 0;
+	if (queued) {
+		thread.sendMessage("testPing", QJsonObject(), onReply);
+		QThread::msleep(ulong(guiWorkMs));
+		frameNs = nowNs() - begin;
+		replied.acquire();
+	} else {
+		ready.acquire();
+		blockedNs = nowNs() - begin;
+		QThread::msleep(ulong(guiWorkMs));
+		frameNs = nowNs() - begin;
+		if (!failed) thread.sendMessage("testPing", QJsonObject(), onReply);
+		replied.acquire();
+	}
+	if (queued && !failed) ready.acquire();
+	thread.shutdown();
+	if (failed) return QJsonObject();
+
+	return QJsonObject{
+		{"mode", queued ? "queued" : "blocking"},
+		{"guiWorkMs", guiWorkMs},
+		// How long initialize() (and, blocking, the wait for ready()) held the GUI thread
+		{"callerBlockedMs", double(blockedNs) / 1e6},
+		{"nodeReadyMs", double(readyNs - begin) / 1e6},
+		{"firstFrameMs", double(frameNs) / 1e6},
+		{"firstReplyMs", double(replyNs - begin) / 1e6},
+	};
+}
+
+// Priority lanes and deadlines under load. Floods the background lane with `flood`
+// testReplay requests, then sends interactive pings one at a time while the flood drains.
+// A ping sent on the background lane right after the flood shows what plain FIFO order
+// would cost. Then two sets of requests must time out: ones whose handler never replies
+// (testDelayedPing), which must be told within their deadline plus slackMs, and background
+// ones that expire while still queued behind a second flood, which must never run.
+static QJsonObject lanesBench(NodeThread *thread, int flood, int boundMs, int slackMs, bool *ok) {
+	static const int kProbes = 200;
+	static const int kExpiring = 20;
+	static const int kExpiryTimeoutMs = 100;
+	const QJsonObject floodParams{{"resultBytes", 16384}};
+	NodeRequestOptions background;
+	background.priority = NodeRequestOptions::Priority::Background;
+
+	QSemaphore floodDone;
+	std::atomic<int> floodLeft{flood};
+	auto sendFlood = [&]() {
+		floodLeft = flood;
+		for (int i = 0; i < flood; i++) {
+			thread->sendMessage(
+				"testReplay", floodParams,
+				[&](const QJsonObject &) {
+					floodLeft.fetch_sub(1);
+					floodDone.release();
+				},
+				background);
+		}
+	};
+
+	// Interactive pings while background work is still queued
+	sendFlood();
+	QSemaphore fifoDone;
+	std::atomic<qint64> fifoNs{0};
+	const qint64 fifoSent = nowNs();
+	thread->sendMessage(
+		"testPing", QJsonObject(),
+		[&](const QJsonObject &) {
+			fifoNs = nowNs() - fifoSent;
+			fifoDone.release();
+		},
+		background);
+
+	std::vector<qint64> loaded;
+	for (int i = 0; i < kProbes && floodLeft.load() > 0; i++) {
+		QSemaphore done;
+		const qint64 sent = nowNs();
+		thread->sendMessage("testPing", QJsonObject(), [&done](const QJsonObject &) { done.release(); });
+		done.acquire();
+		// Only count pings that overlapped the flood from start to finish
+		if (floodLeft.load() > 0) loaded.push_back(nowNs() - sent);
+	}
+	floodDone.acquire(flood);
+	fifoDone.acquire();
+	std::sort(loaded.begin(), loaded.end());
+
+	// Timeouts: handlers that never reply, and requests that expire while queued
+	QSemaphore expired;
+	std::atomic<int> lateOrWrong{0};
+	// lateAfterMs < 0: no time limit, only the timeout error itself is checked
+	auto expectTimeout = [&](int lateAfterMs) {
+		const qint64 sent = nowNs();
+		return [&, sent, lateAfterMs](const QJsonObject &result) {
+			const qint64 elapsedMs = (nowNs() - sent) / 1000000;
+			if (result.value("message").toString() != QLatin1String("Request timed out") || (lateAfterMs >= 0 && elapsedMs > lateAfterMs)) lateOrWrong.fetch_add(1);
+			expired.release();
+		};
+	};
+	NodeRequestOptions expiring;
+	expiring.timeoutMs = kExpiryTimeoutMs;
+	for (int i = 0; i < kExpiring; i++) thread->sendMessage("testDelayedPing", QJsonObject{{"delay", kExpiryTimeoutMs * 50}}, expectTimeout(kExpiryTimeoutMs + slackMs), expiring);
+	bool allExpired = expired.tryAcquire(kExpiring, kExpiryTimeoutMs + slackMs + 1000);
+	sendFlood();
+	NodeRequestOptions queuedExpiring = background;
+	queuedExpiring.timeoutMs = 1;
+	// The deadline timer runs once the loop is through the queue, so these are only checked
+	// for getting the timeout instead of a pong
+	for (int i = 0; i < kExpiring; i++) thread->sendMessage("testPing", QJsonObject(), expectTimeout(-1), queuedExpiring);
+	allExpired = expired.tryAcquire(kExpiring, 30000) && allExpired;
+	floodDone.acquire(flood);
+
+	const double p99Ms = double(loaded.empty() ? 0 : loaded[size_t(0.99 * double(loaded.size() - 1))]) / 1e6;
+	*ok = !loaded.empty() && p99Ms <= boundMs && allExpired && lateOrWrong.load() == 0;
+	return QJsonObject{
+		{"flood", flood},
+		{"probesUnderLoad", int(loaded.size())},
+		{"interactiveP50Ms", double(loaded.empty() ? 0 : loaded[loaded.size() / 2]) / 1e6},
+		{"interactiveP99Ms", p99Ms},
+		{"interactiveMaxMs", double(loaded.empty() ? 0 : loaded.back()) / 1e6},
+		{"boundMs", boundMs},
+		{"fifoPingMs", double(fifoNs.load()) / 1e6},
+		{"timeoutsExpected", 2 * kExpiring},
+		{"timeoutsLateOrWrong", lateOrWrong.load() + (allExpired ? 0 : 1)},
+	};
+}
+
+int main(int argc, char *argv[]) {
+	argv = uv_setup_args(argc, argv);
+	QCoreApplication app(argc, argv);
+	app.setApplicationName("bridge_bench");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Round-trip benchmark for the Qt <-> Node.js bridge");
+	parser.addHelpOption();
+	parser.addOptions({
+		{"action", "ping (testPing), delayed (testDelayedPing), keccak, address or mnemonic.", "name", "ping"},
+		{"messages", "Requests to measure.", "count", "20000"},
+		{"warmup", "Requests sent before measuring.", "count", "2000"},
+		{"concurrency", "Requests kept in flight.", "count", "1"},
+		{"payload", "Bytes of string payload sent with each request.", "bytes", "0"},
+		{"delay", "Handler delay in ms for testDelayedPing.", "ms", "10"},
+		{"loop", "NodeThread loop mode: event or poll.", "mode", "event"},
+		{"compare", "Instead of pinging, time each native fast-path action against its JS handler, count requests each.", "count"},
+		{"startup", "Instead of pinging, time startup in mode queued (pre-init queue) or blocking (wait for ready first).", "mode"},
+		{"gui-work", "GUI thread startup work simulated by --startup.", "ms", "400"},
+		{"lanes", "Instead of pinging, check interactive latency and timeouts while count background requests are queued.", "count"},
+		{"lane-bound", "Interactive p99 allowed by --lanes.", "ms", "50"},
+		{"registry", "Instead of pinging, count heap allocations over count CallbackRegistry add/take round trips (no Node).", "count"},
+		{"json", "Print the result as one JSON object."},
+	});
+	parser.process(app);
+
+	if (parser.isSet("registry")) {
+		const int roundTrips = qMax(1, parser.value("registry").toInt());
+		QJsonObject result{{"roundTrips", roundTrips}};
+		// The slot table is allocated up front; a first pass warms up anything lazily created
+		CallbackRegistry registry(64);
+		int fired = 0;
+		registryAllocations(registry, 16, &fired);
+		fired = 0;
+		const quint64 allocations = registryAllocations(registry, roundTrips, &fired);
+		result.insert("allocations", qint64(allocations));
+		result.insert("fired", fired);
+
+		QTextStream out(stdout);
+		if (parser.isSet("json")) out << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+		else out << QString("CallbackRegistry: %1 add/take round trips, %2 allocations").arg(roundTrips).arg(allocations) << Qt::endl;
+		// Non-zero exit so the check can gate a build
+		return allocations == 0 && fired == roundTrips ? 0 : 1;
+	}
+
+	if (parser.isSet("startup")) {
+		const QString mode = parser.value("startup");
+		if (mode != QLatin1String("queued") && mode != QLatin1String("blocking")) {
+			qCritical() << "bridge_bench: Unknown startup mode" << mode;
+			return 1;
+		}
+		const QJsonObject result = startupBench(mode == QLatin1String("queued"), qMax(0, parser.value("gui-work").toInt()));
+		if (result.isEmpty()) return 1;
+
+		QTextStream out(stdout);
+		if (parser.isSet("json")) {
+			out << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+			return 0;
+		}
+		out << QString("startup, %1, %2 ms GUI work").arg(mode).arg(result["guiWorkMs"].toInt()) << Qt::endl;
+		out << QString("  caller blocked: %1 ms").arg(result["callerBlockedMs"].toDouble(), 0, 'f', 1) << Qt::endl;
+		out << QString("  Node ready:     %1 ms").arg(result["nodeReadyMs"].toDouble(), 0, 'f', 1) << Qt::endl;
+		out << QString("  first frame:    %1 ms").arg(result["firstFrameMs"].toDouble(), 0, 'f', 1) << Qt::endl;
+		out << QString("  first reply:    %1 ms").arg(result["firstReplyMs"].toDouble(), 0, 'f', 1) << Qt::endl;
+		return 0;
+	}
+
+	// Bench name -> bridge action and its fixed parameters
+	static const QHash<QString, QPair<QString, QJsonObject>> kActions = {
+		{"ping", {"testPing", {}}},
+		{"delayed", {"testDelayedPing", {}}},
+		{"keccak", {"cryptoKeccak256", {{"input", "The quick brown fox jumps over the lazy dog"}}}},
+		{"address", {"cryptoValidateAddress", {{"address", "0x5aaeb6053f3e94c9b9a09f33669435e7ef1beaed"}}}},
+		{"mnemonic", {"cryptoWalletFromMnemonic", {{"mnemonic", "test test test test test test test test test test test junk"}}}},
+	};
+	const auto selected = kActions.constFind(parser.value("action"));
+	if (selected == kActions.constEnd()) {
+		qCritical() << "bridge_bench: Unknown action" << parser.value("action");
+		return 1;
+	}
+	const bool delayed = selected->first == QLatin1String("testDelayedPing");
+	const QString action = selected->first;
+	const int messages = qMax(1, parser.value("messages").toInt());
+	const int warmup = qMax(0, parser.value("warmup").toInt());
+	const int concurrency = qMax(1, parser.value("concurrency").toInt());
+	const int payloadBytes = qMax(0, parser.value("payload").toInt());
+
+	QJsonObject params = selected->second;
+	if (payloadBytes > 0) params.insert("payload", QString(payloadBytes, QLatin1Char('x')));
+	if (delayed) params.insert("delay", qMax(0, parser.value("delay").toInt()));
+
+	NodeThread thread;
+	if (parser.value("loop") == QLatin1String("poll")) thread.setLoopMode(NodeThread::LoopMode::Polling);
+
+	QSemaphore started;
+	std::atomic<bool> failed{false};
+	QObject::connect(&thread, &NodeThread::ready, &thread, [&started]() { started.release(); }, Qt::DirectConnection);
+	QObject::connect(
+		&thread, &NodeThread::initializationFailed, &thread,
+		[&started, &failed](const QString &error) {
+			qCritical() << "bridge_bench:" << error;
+			failed = true;
+			started.release();
+		},
+		Qt::DirectConnection);
+
+	QElapsedTimer startup;
+	startup.start();
+	thread.initialize();
+	started.acquire();
+	if (failed) return 1;
+	const qint64 startupMs = startup.elapsed();
+
+	if (parser.isSet("compare")) {
+		const QJsonObject actions = compareNative(&thread, qMax(1, parser.value("compare").toInt()));
+		thread.shutdown();
+
+		QTextStream out(stdout);
+		if (parser.isSet("json")) {
+			out << QJsonDocument(QJsonObject{{"compare", actions}}).toJson(QJsonDocument::Compact) << Qt::endl;
+			return 0;
+		}
+		for (auto it = actions.constBegin(); it != actions.constEnd(); ++it) {
+			const QJsonObject node = it.value()["node"].toObject();
+			const QJsonObject native = it.value()["native"].toObject();
+			QString line = QString("%1: node p50 %2 us, p99 %3 us").arg(it.key(), -24).arg(node["p50Us"].toDouble(), 0, 'f', 1).arg(node["p99Us"].toDouble(), 0, 'f', 1);
+			if (native.isEmpty()) line += " | native declined";
+			else line += QString(" | native p50 %1 us, p99 %2 us").arg(native["p50Us"].toDouble(), 0, 'f', 1).arg(native["p99Us"].toDouble(), 0, 'f', 1);
+			out << line << Qt::endl;
+		}
+		return 0;
+	}
+
+	if (parser.isSet("lanes")) {
+		bool ok = false;
+		const QJsonObject result = lanesBench(&thread, qMax(1, parser.value("lanes").toInt()), qMax(1, parser.value("lane-bound").toInt()), 250, &ok);
+		thread.shutdown();
+
+		QTextStream out(stdout);
+		if (parser.isSet("json")) {
+			out << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+			return ok ? 0 : 1;
+		}
+		out << QString("lanes, %1 background requests queued").arg(result["flood"].toInt()) << Qt::endl;
+		out << QString("  interactive:  p50 %1 ms, p99 %2 ms, max %3 ms over %4 pings (bound %5 ms)").arg(result["interactiveP50Ms"].toDouble(), 0, 'f', 2).arg(result["interactiveP99Ms"].toDouble(), 0, 'f', 2).arg(result["interactiveMaxMs"].toDouble(), 0, 'f', 2).arg(result["probesUnderLoad"].toInt()).arg(result["boundMs"].toInt()) << Qt::endl;
+		out << QString("  FIFO order:   %1 ms for a ping behind the flood").arg(result["fifoPingMs"].toDouble(), 0, 'f', 1) << Qt::endl;
+		out << QString("  timeouts:     %1 expected, %2 late, wrong or missing").arg(result["timeoutsExpected"].toInt()).arg(result["timeoutsLateOrWrong"].toInt()) << Qt::endl;
+		if (!ok) out << "  FAILED" << Qt::endl;
+		return ok ? 0 : 1;
+	}
+
+	// V8 heap once the bundle has loaded, before any request. NodeThread samples it on its
+	// first loop pass.
+	QVariantMap idleHeap = BridgeMetrics::instance().snapshot().value("heap").toMap();
+	while (idleHeap.value("sampledAgoMs").toLongLong() < 0) {
+		QThread::msleep(1);
+		idleHeap = BridgeMetrics::instance().snapshot().value("heap").toMap();
+	}
+
+	if (warmup > 0) BenchRun(&thread, action, params, warmup, concurrency).run();
+
+	BenchRun run(&thread, action, params, messages, concurrency);
+	const quint64 allocationsBefore = s_allocations.load();
+	const qint64 begin = nowNs();
+	run.run();
+	const qint64 elapsedNs = nowNs() - begin;
+	const quint64 allocations = s_allocations.load() - allocationsBefore;
+
+	std::vector<qint64> sorted = run.latencies();
+	std::sort(sorted.begin(), sorted.end());
+
+	const double seconds = double(elapsedNs) / 1e9;
+	QJsonObject result{
+		{"action", action},
+		{"loop", parser.value("loop")},
+		{"messages", messages},
+		{"concurrency", concurrency},
+		{"payloadBytes", payloadBytes},
+		{"errors", run.errors()},
+		{"startupMs", startupMs},
+		{"idleHeapUsedKiB", double(idleHeap.value("used").toULongLong()) / 1024},
+		{"seconds", seconds},
+		{"messagesPerSecond", double(messages) / seconds},
+		// The first request measured; with --warmup 0 that includes any lazy loading
+		{"firstUs", run.latencies().front() / 1000.0},
+		{"p50Us", percentileUs(sorted, 0.50)},
+		{"p99Us", percentileUs(sorted, 0.99)},
+		{"p999Us", percentileUs(sorted, 0.999)},
+		{"maxUs", percentileUs(sorted, 1.0)},
+		{"allocationsPerMessage", double(allocations) / double(messages)},
+		// Where the time went, from the bridge's own histograms (warmup included)
+		{"stages", QJsonObject::fromVariantMap(BridgeMetrics::instance().snapshot().value("actions").toMap().value(action).toMap())},
+	};
+
+	thread.shutdown();
+
+	QTextStream out(stdout);
+	if (parser.isSet("json")) {
+		out << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+		return run.errors() ? 1 : 0;
+	}
+
+	out << QString("%1 x %2, concurrency %3, payload %4 B, %5 loop").arg(action).arg(messages).arg(concurrency).arg(payloadBytes).arg(parser.value("loop")) << Qt::endl;
+	out << QString("  startup:    %1 ms").arg(startupMs) << Qt::endl;
+	out << QString("  idle heap:  %1 KiB used").arg(result["idleHeapUsedKiB"].toDouble(), 0, 'f', 0) << Qt::endl;
+	out << QString("  throughput: %1 msg/s (%2 s)").arg(result["messagesPerSecond"].toDouble(), 0, 'f', 0).arg(seconds, 0, 'f', 2) << Qt::endl;
+	out << QString("  first:      %1 us").arg(result["firstUs"].toDouble(), 0, 'f', 1) << Qt::endl;
+	out << QString("  latency:    p50 %1 us, p99 %2 us, p999 %3 us, max %4 us").arg(result["p50Us"].toDouble(), 0, 'f', 1).arg(result["p99Us"].toDouble(), 0, 'f', 1).arg(result["p999Us"].toDouble(), 0, 'f', 1).arg(result["maxUs"].toDouble(), 0, 'f', 1) << Qt::endl;
+	out << QString("  allocs:     %1 per message").arg(result["allocationsPerMessage"].toDouble(), 0, 'f', 1) << Qt::endl;
+	if (run.errors()) out << QString("  errors:     %1").arg(run.errors()) << Qt::endl;
+	return run.errors() ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+// Replays a bridge trace recorded with BRIDGE_TRACE_FILE into a headless NodeThread.
+// Requests are sent at their recorded offsets (scaled by --speed) with their recorded
+// priority and timeout, and recorded cancellations are repeated. Actions that touch the
+// system are stubbed with testReplay, which answers after the recorded handler time with a
+// result of the recorded size; test* actions and anything listed in --live run for real.
+//
+//   BRIDGE_TRACE_FILE=/tmp/ui.trace ./wallet          # record
+//   bridge_replay /tmp/ui.trace --speed 4             # replay 4x faster
+//   bridge_replay /tmp/ui.trace --speed 0 --json      # as fast as possible
+
+#include "include/bridge_metrics.h"
+#include "include/bridge_recorder.h"
+#include "include/node_thread.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSemaphore>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <atomic>
+#include <map>
+#include <memory>
+
+struct Outcome {
+	qint64 jsUs = 0;
+	qint64 resultBytes = 0;
+	bool ok = true;
+	bool completed = false;
+};
+
+int main(int argc, char *argv[]) {
+	argv = uv_setup_args(argc, argv);
+	QCoreApplication app(argc, argv);
+	app.setApplicationName("bridge_replay");
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Replays a recorded bridge trace into a headless NodeThread");
+	parser.addHelpOption();
+	parser.addPositionalArgument("trace", "Trace file written with BRIDGE_TRACE_FILE.");
+	parser.addOptions({
+		{"speed", "Time scale, 2 = twice as fast, 0 = no pauses.", "factor", "1"},
+		{"live", "Comma-separated actions to run for real instead of stubbing.", "actions"},
+		{"loop", "NodeThread loop mode: event or poll.", "mode", "event"},
+		{"json", "Print the result as one JSON object."},
+	});
+	parser.process(app);
+	if (parser.positionalArguments().size() != 1) parser.showHelp(1);
+
+	QList<BridgeRecorder::Record> records;
+	QString error;
+	if (!BridgeRecorder::read(parser.positionalArguments().first(), &records, &error)) {
+		qCritical() << "bridge_replay:" << error;
+		return 1;
+	}
+
+	const double speed = qMax(0.0, parser.value("speed").toDouble());
+	QSet<QString> live;
+	for (const QString &action : parser.value("live").split(QLatin1Char(','), Qt::SkipEmptyParts)) live.insert(action.trimmed());
+
+	// Outcomes by recorded ID, and one round-trip histogram per recorded action. The map
+	// is complete before any request is sent, so callbacks only read it.
+	QHash<quint64, Outcome> outcomes;
+	std::map<QString, std::unique_ptr<LatencyHistogram>> latencies;
+	int sends = 0;
+	qint64 recordedUs = 0;
+	for (const BridgeRecorder::Record &record : records) {
+		recordedUs = qMax(recordedUs, record.timeUs);
+		if (record.type == BridgeRecorder::Type::Send) {
+			sends++;
+			if (!latencies.count(record.action)) latencies[record.action] = std::make_unique<LatencyHistogram>();
+		} else if (record.type == BridgeRecorder::Type::Complete) {
+			Outcome &outcome = outcomes[record.id];
+			outcome.jsUs = record.jsUs;
+			outcome.resultBytes = record.resultBytes;
+			outcome.ok = record.ok;
+			outcome.completed = true;
+		}
+	}
+	if (sends == 0) {
+		qCritical() << "bridge_replay: trace contains no requests";
+		return 1;
+	}
+	LatencyHistogram total;
+
+	NodeThread thread;
+	if (parser.value("loop") == QLatin1String("poll")) thread.setLoopMode(NodeThread::LoopMode::Polling);
+
+	QSemaphore started;
+	std::atomic<bool> failed{false};
+	QObject::connect(&thread, &NodeThread::ready, &thread, [&started]() { started.release(); }, Qt::DirectConnection);
+	QObject::connect(
+		&thread, &NodeThread::initializationFailed, &thread,
+		[&started, &failed](const QString &message) {
+			qCritical() << "bridge_replay:" << message;
+			failed = true;
+			started.release();
+		},
+		Qt::DirectConnection);
+	thread.initialize();
+	started.acquire();
+	if (failed) return 1;
+
+	std::atomic<int> outstanding{0};
+	std::atomic<int> errors{0};
+	int stubbed = 0, cancelled = 0;
+	QHash<quint64, quint64> replayIds; // recorded ID -> ID in this run
+
+	const qint64 begin = BridgeMetrics::nowUs();
+	for (const BridgeRecorder::Record &record : records) {
+		if (speed > 0) {
+			const qint64 wait = begin + qint64(double(record.timeUs) / speed) - BridgeMetrics::nowUs();
+			if (wait > 0) QThread::usleep(quint64(wait));
+		}
+
+		if (record.type == BridgeRecorder::Type::Cancel) {
+			if (thread.cancel(replayIds.value(record.id))) {
+				cancelled++;
+				outstanding--;
+			}
+			continue;
+		}
+		if (record.type != BridgeRecorder::Type::Send) continue;
+
+		QString action = record.action;
+		QJsonObject params = record.params;
+		if (!action.startsWith(QLatin1String("test")) && !live.contains(action)) {
+			// Unfinished requests (timed out or cancelled) hang on until their timeout
+			const Outcome outcome = outcomes.value(record.id);
+			const double delayMs = outcome.completed ? double(outcome.jsUs) / 1000.0 : double(record.timeoutMs > 0 ? record.timeoutMs : NodeRequestOptions::kDefaultTimeoutMs);
+			params = QJsonObject{{"delay", delayMs}, {"resultBytes", outcome.resultBytes}, {"ok", outcome.ok}, {"request", record.params}};
+			action = QStringLiteral("testReplay");
+			stubbed++;
+		}
+
+		NodeRequestOptions options;
+		options.priority = record.background ? NodeRequestOptions::Priority::Background : NodeRequestOptions::Priority::Interactive;
+		options.timeoutMs = record.timeoutMs;
+
+		LatencyHistogram *histogram = latencies[record.action].get();
+		const qint64 sent = BridgeMetrics::nowUs();
+		outstanding++;
+		const quint64 id = thread.sendMessage(
+			action, params,
+			[histogram, &total, &outstanding, &errors, sent](const QJsonObject &result) {
+				const qint64 elapsed = BridgeMetrics::nowUs() - sent;
+				histogram->record(elapsed);
+				total.record(elapsed);
+				if (result.value("status").toString() != QLatin1String("success")) errors++;
+				outstanding--;
+			},
+			options);
+		replayIds.insert(record.id, id);
+	}
+
+	// Stragglers finish, time out or were cancelled above
+	while (outstanding.load() > 0) QThread::msleep(5);
+	const qint64 elapsedUs = BridgeMetrics::nowUs() - begin;
+	thread.shutdown();
+
+	QJsonObject actions;
+	for (const auto &entry : latencies) actions.insert(entry.first, QJsonObject::fromVariantMap(entry.second->snapshot()));
+	const QJsonObject result{
+		{"trace", parser.positionalArguments().first()},
+		{"speed", speed},
+		{"requests", sends},
+		{"stubbed", stubbed},
+		{"cancelled", cancelled},
+		{"errors", errors.load()},
+		{"recordedMs", recordedUs / 1000},
+		{"replayedMs", elapsedUs / 1000},
+		{"roundTrip", QJsonObject::fromVariantMap(total.snapshot())},
+		{"actions", actions},
+	};
+
+	QTextStream out(stdout);
+	if (parser.isSet("json")) {
+		out << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+		return 0;
+	}
+
+	const QVariantMap all = total.snapshot();
+	out << QString("%1 requests (%2 stubbed, %3 cancelled, %4 errors), recorded %5 ms, replayed %6 ms at speed %7").arg(sends).arg(stubbed).arg(cancelled).arg(errors.load()).arg(recordedUs / 1000).arg(elapsedUs / 1000).arg(speed) << Qt::endl;
+	out << QString("  all: p50 %1 us, p99 %2 us, p999 %3 us, max %4 us").arg(all["p50Us"].toULongLong()).arg(all["p99Us"].toULongLong()).arg(all["p999Us"].toULongLong()).arg(all["maxUs"].toULongLong()) << Qt::endl;
+	for (const auto &entry : latencies) {
+		const QVariantMap stats = entry.second->snapshot();
+		out << QString("  %1: %2 x, p50 %3 us, p99 %4 us, max %5 us").arg(entry.first).arg(stats["count"].toULongLong()).arg(stats["p50Us"].toULongLong()).arg(stats["p99Us"].toULongLong()).arg(stats["maxUs"].toULongLong()) << Qt::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,9 @@
+#!/bin/bash
+
+# Builds the app together with build/linux/bridge_bench and bridge_replay (headless bridge tools).
+# Pass --arm64 to cross-compile with arm64-toolchain.cmake instead of a native build.
+if [ "$1" = "--arm64" ]; then
+ CMAKE_ARGS="-DBUILD_BRIDGE_BENCH=ON" ./build-cross-x86-arm64.sh
+else
+ CMAKE_ARGS="-DBUILD_BRIDGE_BENCH=ON" ./build.sh
+fi
@@ -92,7 +92,8 @@ cmake ../.. \
   -DNODEJS_LOG=ON \
   -DCMAKE_MESSAGE_LOG_LEVEL=DEBUG \
     -DCMAKE_BUILD_TYPE=Release \
-    -DCMAKE_TOOLCHAIN_FILE=../../arm64-toolchain.cmake   
+    -DCMAKE_TOOLCHAIN_FILE=../../arm64-toolchain.cmake \
+    ${CMAKE_ARGS:-}
 #   --debug-find 
 
 
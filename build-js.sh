@@ -26,6 +26,13 @@ if [ -d "js" ]; then
   echo "ERROR: JavaScript bundle was not created!"
   exit 1
  fi
+ # Chunks loaded on demand, embedded next to the bundle (see CMakeLists.txt)
+ for CHUNK in system wifi battery firewall speedtest crypto addressbook; do
+  if [ ! -f "js/dist/chunks/$CHUNK.cjs" ]; then
+   echo "ERROR: JavaScript bundle chunk $CHUNK was not created!"
+   exit 1
+  fi
+ done
  BUNDLE_SIZE=$(du -h js/dist/bundle.cjs | cut -f1)
  echo "✅ JavaScript bundle created: js/dist/bundle.cjs ($BUNDLE_SIZE)"
 fi
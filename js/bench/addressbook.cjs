@@ -0,0 +1,101 @@
+#!/usr/bin/env node
+
+// crypto2* address book actions on a large book, under plain node, through handleMessage
+// like the app sends them. Reports the latency of lookups, validation, full and paged reads
+// and change diffs (src/AddressBookStore.ts), the size of what each sends back, and the
+// log size before and after compaction. The book lives in a temporary WALLET_DATA_DIR.
+//
+// Usage: bun run build && node bench/addressbook.cjs [entries]
+
+const { execFileSync } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { performance } = require('perf_hooks');
+
+const reloadOnly = process.argv[2] === '--reload';
+const entryCount = reloadOnly ? 0 : Number(process.argv[2] || 10000);
+const dataDir = reloadOnly ? process.env.WALLET_DATA_DIR : fs.mkdtempSync(path.join(os.tmpdir(), 'addressbook-bench-'));
+const logFile = path.join(dataDir, 'addressbook.jsonl');
+process.env.WALLET_DATA_DIR = dataDir;
+
+const { send } = require('./harness.cjs');
+
+// Lower case addresses, so no checksum has to be computed for them
+const address = (i) => '0x' + (i + 1).toString(16).padStart(40, '0');
+const kib = (bytes) => (bytes / 1024).toFixed(1);
+let failures = 0;
+
+function check(ok, message) {
+	if (ok) return;
+	console.log(`  FAILED: ${message}`);
+	failures++;
+}
+
+// Runs an action a number of times and reports the mean latency and the size of one reply
+async function step(name, runs, action, data) {
+	let result;
+	const start = performance.now();
+	for (let i = 0; i < runs; i++) result = await send(action, typeof data === 'function' ? data(i) : data);
+	const ms = (performance.now() - start) / runs;
+	console.log(`${name.padEnd(34)} ${ms.toFixed(3).padStart(9)} ms  ${kib(JSON.stringify(result).length).padStart(8)} KiB reply`);
+	return result;
+}
+
+async function reloadBook() {
+	const start = performance.now();
+	const result = await send('crypto2getAddressBookItems', { limit: 1 });
+	console.log(`reload of ${result.total} entries from the log: ${(performance.now() - start).toFixed(1)} ms`);
+	process.exit(0);
+}
+
+(async () => {
+	if (reloadOnly) return reloadBook();
+	console.log(`${entryCount} entries in ${dataDir}\n`);
+
+	const start = performance.now();
+	for (let i = 0; i < entryCount; i++) await send('crypto2addAddressBookItem', { name: `Contact ${i}`, address: address(i) });
+	console.log(`${'add, one message per entry'.padEnd(34)} ${((performance.now() - start) / entryCount).toFixed(3).padStart(9)} ms`);
+
+	const found = await step('find by address', 1000, 'crypto2findAddressBookItemByAddress', (i) => ({ address: address((i * 7919) % entryCount).toUpperCase().replace('0X', '0x') }));
+	check(found && found.name, 'lookup by address');
+	await step('find by GUID', 1000, 'crypto2findAddressBookItemByID', { guid: found.guid });
+	const duplicate = await step('validate, duplicate address', 1000, 'crypto2validateAddressBookItem', (i) => ({ name: 'x', address: address(i % entryCount) }));
+	check(!duplicate.isValid, 'duplicate address accepted');
+	await step('validate, new address', 1000, 'crypto2validateAddressBookItem', (i) => ({ name: 'x', address: address(entryCount + i) }));
+
+	const full = await step('all items', 10, 'crypto2getAddressBookItems', {});
+	check(full.data.length === entryCount && full.total === entryCount, 'full list length');
+	const page = await step('one page of 200', 100, 'crypto2getAddressBookItems', (i) => ({ offset: (i * 200) % entryCount, limit: 200 }));
+	check(page.data.length === Math.min(200, entryCount), 'page length');
+
+	const version = full.version;
+	const edited = await send('crypto2editAddressBookItem', { itemGuid: found.guid, name: 'Renamed', address: found.address });
+	check(edited.isValid, 'edit');
+	const changes = await step('changes after one edit', 100, 'crypto2getAddressBookChanges', { since: version });
+	check(changes.changed.length === 1 && changes.changed[0].item.name === 'Renamed' && changes.removed.length === 0, 'diff after edit');
+	await send('crypto2deleteAddressBookItem', { itemGuid: found.guid });
+	const afterDelete = await send('crypto2getAddressBookChanges', { since: version });
+	check(afterDelete.changed.length === 0 && afterDelete.removed[0] === found.guid && afterDelete.total === entryCount - 1, 'diff after delete');
+
+	// Rewriting every name doubles the log past the compaction threshold
+	const logBefore = fs.statSync(logFile).size;
+	const items = (await send('crypto2getAddressBookItems', {})).data;
+	const renameStart = performance.now();
+	for (const item of items) await send('crypto2editAddressBookItem', { itemGuid: item.guid, name: item.name + '*', address: item.address });
+	const renameMs = performance.now() - renameStart;
+	const logAfter = fs.statSync(logFile).size;
+	console.log(`\nlog ${kib(logBefore)} KiB, after ${items.length} edits ${kib(logAfter)} KiB (${renameMs.toFixed(0)} ms, compacted as it grew)`);
+	check(logAfter < 2 * logBefore, 'log not compacted');
+
+	// First access in a new process: loads the chunk and replays the (compacted) log
+	const reload = execFileSync(process.execPath, [__filename, '--reload'], { env: { ...process.env, WALLET_DATA_DIR: dataDir }, encoding: 'utf8' }).trim();
+	console.log(reload);
+
+	fs.rmSync(dataDir, { recursive: true, force: true });
+	if (failures) {
+		console.log(`\n${failures} check(s) failed`);
+		process.exit(1);
+	}
+	process.exit(0);
+})();
@@ -0,0 +1,59 @@
+#!/usr/bin/env node
+
+// Cost of the lazily-loaded chunks under plain node: for one read-only action per chunk,
+// a fresh process loads the core bundle, reports its idle heap, sends the action and
+// reports how long the first reply took (chunk load included) and the heap after it.
+// Compare before and after a change to src/ChunkLoader.ts or build.mjs.
+//
+// Usage: bun run build && node bench/chunks.cjs
+
+const { execFileSync } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { performance } = require('perf_hooks');
+
+// Chunk -> an action it handles that changes nothing, and its parameters
+const ACTIONS = {
+	system: ['timeGetCurrentTimezone', {}],
+	wifi: ['wifiGetInterfaceInfo', {}],
+	battery: ['batteryCheckStatus', {}],
+	firewall: ['firewallGetStatus', {}],
+	crypto: ['cryptoValidateAddress', { address: '0x5aaeb6053f3e94c9b9a09f33669435e7ef1beaed' }],
+	addressbook: ['crypto2hasAddressBookItems', {}],
+};
+
+const mib = (bytes) => (bytes / 1024 / 1024).toFixed(2);
+
+function heapUsed() {
+	global.gc();
+	return process.memoryUsage().heapUsed;
+}
+
+function measure(action, data) {
+	global.__nativeCallback = () => {
+		const firstMs = performance.now() - start;
+		const after = heapUsed();
+		console.log(JSON.stringify({ idleHeap: idle, firstMs, heapAfter: after }));
+		process.exit(0);
+	};
+	global.__nativeEmit = () => {};
+	require(path.join(__dirname, '..', 'dist', 'bundle.cjs'));
+	const idle = heapUsed();
+	const start = performance.now();
+	global.handleMessage({ messageId: 1, action, data });
+}
+
+if (process.argv[2] === '--one') {
+	measure(process.argv[3], JSON.parse(process.argv[4]));
+} else {
+	// The address book is opened in an empty data directory, not the real one
+	const dataDir = fs.mkdtempSync(path.join(os.tmpdir(), 'chunks-bench-'));
+	console.log(`${'chunk'.padEnd(12)} ${'idle heap'.padStart(10)} ${'first reply'.padStart(12)} ${'heap after'.padStart(11)}`);
+	for (const [chunk, [action, data]] of Object.entries(ACTIONS)) {
+		const output = execFileSync(process.execPath, ['--expose-gc', __filename, '--one', action, JSON.stringify(data)], { env: { ...process.env, WALLET_DATA_DIR: dataDir }, encoding: 'utf8' });
+		const result = JSON.parse(output.trim().split('\n').pop());
+		console.log(`${chunk.padEnd(12)} ${(mib(result.idleHeap) + ' MiB').padStart(10)} ${(result.firstMs.toFixed(1) + ' ms').padStart(12)} ${(mib(result.heapAfter) + ' MiB').padStart(11)}`);
+	}
+	fs.rmSync(dataDir, { recursive: true, force: true });
+}
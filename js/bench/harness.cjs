@@ -0,0 +1,27 @@
+// Shared by the bench scripts: loads the built bundle under plain node with the natives
+// the app would provide, and sends actions through handleMessage like the app does.
+// The bundle reads its environment when it loads, so set process.env before requiring this.
+
+const path = require('path');
+
+const pending = new Map();
+let nextId = 1;
+global.__nativeCallback = (messageId, result) => {
+	const resolve = pending.get(messageId);
+	pending.delete(messageId);
+	if (resolve) resolve(result);
+};
+global.__nativeEmit = () => {};
+
+require(path.join(__dirname, '..', 'dist', 'bundle.cjs'));
+
+// Resolves with the reply to one action
+function send(action, data) {
+	const messageId = nextId++;
+	return new Promise((resolve) => {
+		pending.set(messageId, resolve);
+		global.handleMessage({ messageId, action, data });
+	});
+}
+
+module.exports = { send };
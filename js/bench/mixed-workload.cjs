@@ -0,0 +1,58 @@
+#!/usr/bin/env node
+
+// Mixed workload against the built bundle under plain node: a steady stream of cheap
+// requests (testPing) while CPU-bound requests (cryptoGenerateKeyPair) run alongside.
+// Reports ping latency and throughput of both; compare NODE_WORKER_POOL_SIZE=0 (inline)
+// with the default worker pool.
+//
+// Usage: bun run build && node bench/mixed-workload.cjs [seconds] [concurrent keypairs]
+
+const { performance } = require('perf_hooks');
+
+const seconds = Number(process.argv[2] || 10);
+const heavyConcurrency = Number(process.argv[3] || 2);
+const pingIntervalMs = 10;
+
+const { send } = require('./harness.cjs');
+
+function percentile(sorted, p) {
+	if (sorted.length === 0) return 0;
+	return sorted[Math.min(sorted.length - 1, Math.floor((p / 100) * sorted.length))];
+}
+
+(async () => {
+	const deadline = performance.now() + seconds * 1000;
+	const pingLatencies = [];
+	let heavyDone = 0;
+
+	const heavyLoop = async () => {
+		while (performance.now() < deadline) {
+			const result = await send('cryptoGenerateKeyPair');
+			if (result.status !== 'success') throw new Error(result.message);
+			heavyDone++;
+		}
+	};
+
+	const pingLoop = async () => {
+		while (performance.now() < deadline) {
+			const start = performance.now();
+			await send('testPing');
+			pingLatencies.push(performance.now() - start);
+			await new Promise((resolve) => setTimeout(resolve, pingIntervalMs));
+		}
+	};
+
+	const started = performance.now();
+	await Promise.all([pingLoop(), ...Array.from({ length: heavyConcurrency }, heavyLoop)]);
+	const elapsed = (performance.now() - started) / 1000;
+
+	pingLatencies.sort((a, b) => a - b);
+	console.log(`worker pool size: ${process.env.NODE_WORKER_POOL_SIZE ?? 'default'}, duration: ${elapsed.toFixed(1)} s`);
+	console.log(`cryptoGenerateKeyPair: ${heavyDone} done, ${(heavyDone / elapsed).toFixed(2)}/s`);
+	console.log(`testPing: ${pingLatencies.length} done, ${(pingLatencies.length / elapsed).toFixed(1)}/s`);
+	console.log(`testPing latency ms: p50 ${percentile(pingLatencies, 50).toFixed(2)}, p99 ${percentile(pingLatencies, 99).toFixed(2)}, max ${percentile(pingLatencies, 100).toFixed(2)}`);
+	process.exit(0);
+})().catch((error) => {
+	console.error('Benchmark failed:', error);
+	process.exit(1);
+});
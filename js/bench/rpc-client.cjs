@@ -0,0 +1,126 @@
+#!/usr/bin/env node
+
+// cryptoGetBalance / cryptoGetLatestBlock against a local mock JSON-RPC server, under plain
+// node. Checks how many HTTP requests, JSON-RPC calls and TCP connections each step costs
+// (pooling, batching and the block cache in src/RpcClient.ts) and reports its latency.
+// With ethers installed, the old way (a JsonRpcProvider per call) is measured first.
+//
+// Usage: bun run build && node bench/rpc-client.cjs [addresses] [server latency ms]
+
+const http = require('http');
+const { performance } = require('perf_hooks');
+
+const addressCount = Number(process.argv[2] || 100);
+const serverLatencyMs = Number(process.argv[3] || 20);
+const blockTtlMs = 300;
+const maxBatchSize = 50; // RpcClient.ts MAX_BATCH_SIZE
+
+process.env.NODE_RPC_BLOCK_TTL_MS = String(blockTtlMs);
+
+const { send } = require('./harness.cjs');
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+// Mock node: answers after serverLatencyMs, like a remote endpoint would
+let blockNumber = 19000000;
+const counts = { connections: 0, httpRequests: 0, calls: 0 };
+
+function answer(request) {
+	counts.calls++;
+	const reply = (result) => ({ jsonrpc: '2.0', id: request.id, result });
+	switch (request.method) {
+		case 'eth_chainId':
+		case 'net_version':
+			return reply(request.method === 'eth_chainId' ? '0x1' : '1');
+		case 'eth_blockNumber':
+			return reply('0x' + blockNumber.toString(16));
+		case 'eth_getBalance':
+			return reply('0x' + (BigInt(request.params[0]) % 10n ** 21n).toString(16));
+		case 'eth_getBlockByNumber':
+			return reply({ number: request.params[0], hash: '0x' + '11'.repeat(32), timestamp: '0x65000000', gasUsed: '0xe4e1c0', gasLimit: '0x1c9c380', transactions: [] });
+		default:
+			return { jsonrpc: '2.0', id: request.id, error: { code: -32601, message: `Method not found: ${request.method}` } };
+	}
+}
+
+const server = http.createServer((req, res) => {
+	counts.httpRequests++;
+	const chunks = [];
+	req.on('data', (chunk) => chunks.push(chunk));
+	req.on('end', () => {
+		const body = JSON.parse(Buffer.concat(chunks).toString('utf8'));
+		const response = Array.isArray(body) ? body.map(answer) : answer(body);
+		setTimeout(() => {
+			res.setHeader('content-type', 'application/json');
+			res.end(JSON.stringify(response));
+		}, serverLatencyMs);
+	});
+});
+server.on('connection', () => counts.connections++);
+
+const addresses = Array.from({ length: addressCount }, (_, i) => '0x' + (i + 1).toString(16).padStart(40, '0'));
+const batches = Math.ceil(addressCount / maxBatchSize);
+let failures = 0;
+
+// Runs one step and checks what it cost against the expected request and call counts
+async function step(name, run, expected) {
+	const before = { ...counts };
+	const start = performance.now();
+	await run();
+	const ms = performance.now() - start;
+	const cost = { httpRequests: counts.httpRequests - before.httpRequests, calls: counts.calls - before.calls, connections: counts.connections - before.connections };
+	let line = `${name.padEnd(38)} ${ms.toFixed(1).padStart(8)} ms  ${String(cost.httpRequests).padStart(4)} requests  ${String(cost.calls).padStart(4)} calls  ${String(cost.connections).padStart(3)} new connections`;
+	if (expected && (cost.httpRequests !== expected.httpRequests || cost.calls !== expected.calls)) {
+		line += `  MISMATCH, expected ${expected.httpRequests} requests / ${expected.calls} calls`;
+		failures++;
+	}
+	console.log(line);
+}
+
+async function balances(url) {
+	const result = await send('cryptoGetBalance', { addresses, rpcUrl: url });
+	if (result.status !== 'success' || result.balances.length !== addressCount) throw new Error(result.message || 'wrong balance count');
+}
+
+server.listen(0, '127.0.0.1', async () => {
+	const url = `http://127.0.0.1:${server.address().port}`;
+	console.log(`${addressCount} addresses, mock server latency ${serverLatencyMs} ms, block number TTL ${blockTtlMs} ms\n`);
+
+	let ethers = null;
+	try {
+		ethers = require('ethers');
+	} catch {
+		console.log('ethers not installed, skipping the JsonRpcProvider-per-call baseline');
+	}
+	if (ethers) {
+		await step('JsonRpcProvider per address', async () => {
+			await Promise.all(
+				addresses.map(async (address) => {
+					const provider = new ethers.JsonRpcProvider(url);
+					await provider.getBalance(address);
+					provider.destroy();
+				})
+			);
+		});
+	}
+
+	await step('balances, cold', () => balances(url), { httpRequests: 1 + batches, calls: 1 + addressCount });
+	await step('balances, same block', () => balances(url), { httpRequests: 0, calls: 0 });
+	await sleep(blockTtlMs);
+	await step('balances, block unchanged after TTL', () => balances(url), { httpRequests: 1, calls: 1 });
+	blockNumber++;
+	await sleep(blockTtlMs);
+	await step('balances, new block', () => balances(url), { httpRequests: 1 + batches, calls: 1 + addressCount });
+	await step('latest block', () => send('cryptoGetLatestBlock', { rpcUrl: url }), { httpRequests: 1, calls: 1 });
+	await step('latest block, same block', () => send('cryptoGetLatestBlock', { rpcUrl: url }), { httpRequests: 0, calls: 0 });
+	// Separate messages in the same loop iteration still share one block number request and one batch
+	const singles = addresses.slice(0, 10);
+	await step(`${singles.length} single-address messages, one tick`, () => Promise.all(singles.map((address) => send('cryptoGetBalance', { address, rpcUrl: `${url}/single` }))), { httpRequests: 2, calls: 1 + singles.length });
+
+	server.close();
+	if (failures) {
+		console.log(`\n${failures} step(s) did not match the expected request counts`);
+		process.exit(1);
+	}
+	process.exit(0);
+});
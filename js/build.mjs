@@ -1,24 +1,48 @@
 import { build } from 'esbuild';
 
-await build({
-  entryPoints: ['src/index.ts'],
+// The core bundle (src/index.ts -> dist/bundle.cjs) and one chunk per domain
+// (src/chunks/<name>.ts -> dist/chunks/<name>.cjs), all embedded in the QRC by CMakeLists.txt.
+// Chunks are loaded on the first action they handle, see src/ChunkLoader.ts.
+const CHUNKS = ['system', 'wifi', 'battery', 'firewall', 'speedtest', 'crypto', 'addressbook'];
+
+// Modules with state that must exist only once. Chunks do not bundle their own copy but
+// require 'core:<name>', which ChunkLoader.ts answers with the core's instance.
+const SHARED = ['EventQueue', 'CommandBroker'];
+
+const sharedModules = {
+  name: 'shared-modules',
+  setup(build) {
+    build.onResolve({ filter: new RegExp(`^\\.\\.?/(.*/)?(${SHARED.join('|')})$`) }, (args) => {
+      if (args.importer.includes('node_modules')) return undefined;
+      return { path: `core:${args.path.split('/').pop()}`, external: true };
+    });
+  }
+};
+
+const common = {
   bundle: true,
-  platform: 'node',
+  platform: 'node', // Node.js built-ins stay external
   target: 'node18',
-  format: 'esm',
-  outfile: 'dist/bundle.js',
-  external: [
-    // Mark Node.js built-ins as external
-    'child_process',
-    'util',
-    'crypto',
-    'fs',
-    'path',
-    'os'
-  ],
+  format: 'cjs',
+  conditions: ['node', 'import', 'require'],
   sourcemap: true,
   minify: false, // Keep readable for debugging
   logLevel: 'info'
-}).catch(() => process.exit(1));
+};
+
+await Promise.all([
+  build({
+    ...common,
+    entryPoints: ['src/index.ts'],
+    outfile: 'dist/bundle.cjs'
+  }),
+  build({
+    ...common,
+    entryPoints: CHUNKS.map((name) => ({ in: `src/chunks/${name}.ts`, out: name })),
+    outdir: 'dist/chunks',
+    outExtension: { '.js': '.cjs' },
+    plugins: [sharedModules]
+  })
+]).catch(() => process.exit(1));
 
-console.log('Bundle created successfully!');
\ No newline at end of file
+console.log('Bundle created successfully!');
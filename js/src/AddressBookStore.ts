@@ -0,0 +1,363 @@
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { randomUUID } from 'crypto';
+import { nativeCrypto } from './NativeCrypto';
+
+// Address book backend for the crypto2* actions.
+//
+// Items live in memory with hash indexes on GUID and on the normalized (lower case)
+// address, so lookups and duplicate checks do not scan the list. Every change gets a
+// version number. changesSince() returns only the rows added, edited or removed after a
+// version the caller already has, so the page can patch its list instead of reloading it.
+//
+// Changes are appended to a JSONL log, one record per change. Replaying the log on load
+// rebuilds the book. Once the log holds far more records than there are items, it is
+// compacted: rewritten as one record per item and swapped in with a rename.
+
+export interface AddressBookItem {
+	guid: string;
+	name: string;
+	address: string;
+}
+
+export interface ValidationResult {
+	isValid: boolean;
+	error?: string;
+}
+
+export interface AddressBookChanges {
+	version: number;
+	total: number;
+	// The caller's version is too old (or unknown) for a diff: reload everything
+	reset?: boolean;
+	// Added or edited rows with their position in the current order, by ascending index
+	changed: { index: number; item: AddressBookItem }[];
+	removed: string[];
+}
+
+type LogRecord =
+	| { v: number; op: 'put'; guid: string; name: string; address: string }
+	| { v: number; op: 'del'; guid: string }
+	| { v: number; op: 'order'; guids: string[] }
+	| { v: number; op: 'clear' }
+	| { v: number; op: 'base' };
+
+// Changes kept in memory for diffs; older versions get a reset
+const MAX_CHANGE_LOG = 5000;
+// Compact once the log has this many records and more than twice as many as items
+const COMPACT_MIN_RECORDS = 1000;
+const MAX_NAME_LENGTH = 100;
+
+const ADDRESS_PATTERN = /^0x[0-9a-fA-F]{40}$/;
+
+// Qt's AppDataLocation for the app on Linux, unless WALLET_DATA_DIR says otherwise
+export function defaultAddressBookFile(): string {
+	const dataHome = process.env.XDG_DATA_HOME || path.join(os.homedir(), '.local', 'share');
+	const dir = process.env.WALLET_DATA_DIR || path.join(dataHome, 'LiberSoft', 'Matchbox Wallet');
+	return path.join(dir, 'addressbook.jsonl');
+}
+
+function normalizeAddress(address: string): string {
+	return address.toLowerCase();
+}
+
+let keccak256: ((data: Uint8Array) => Uint8Array) | null = null;
+
+// EIP-55 form of a hex address, computed like ethers.getAddress() does but with only the
+// keccak-256 ethers itself uses (@noble/hashes), not the rest of ethers
+function checksumAddress(address: string): string {
+	if (!keccak256) keccak256 = require('@noble/hashes/sha3').keccak_256;
+	const hex = address.slice(2).toLowerCase();
+	const hash = keccak256!(Buffer.from(hex, 'ascii'));
+	let result = '0x';
+	for (let i = 0; i < hex.length; i++) {
+		const nibble = i % 2 === 0 ? hash[i >> 1] >> 4 : hash[i >> 1] & 0x0f;
+		result += nibble >= 8 ? hex[i].toUpperCase() : hex[i];
+	}
+	return result;
+}
+
+// Mixed-case addresses must carry a valid EIP-55 checksum, like ethers.getAddress() checks
+function checksumMatches(address: string): boolean {
+	const lower = address.slice(2) === address.slice(2).toLowerCase();
+	const upper = address.slice(2) === address.slice(2).toUpperCase();
+	if (lower || upper) return true;
+	const native = nativeCrypto();
+	if (native) return native.checksumAddress(address) === address;
+	try {
+		return checksumAddress(address) === address;
+	} catch {
+		return false;
+	}
+}
+
+export class AddressBookStore {
+	readonly file: string;
+	private readonly items = new Map<string, AddressBookItem>();
+	private readonly byAddress = new Map<string, string>();
+	private order: string[] = [];
+	// guid -> index in order, rebuilt on demand after removals and reorders
+	private positions = new Map<string, number>();
+	private positionsValid = true;
+
+	private currentVersion = 0;
+	private readonly changeLog: { version: number; guid: string }[] = [];
+	// Diffs can only be computed from this version on
+	private diffFloor = 0;
+
+	private fd: number | null = null;
+	private logRecords = 0;
+
+	constructor(file: string = defaultAddressBookFile()) {
+		this.file = file;
+	}
+
+	get version(): number {
+		return this.currentVersion;
+	}
+
+	get size(): number {
+		return this.order.length;
+	}
+
+	// Replays the log. Returns false when there was none yet.
+	load(): boolean {
+		let text: string;
+		try {
+			text = fs.readFileSync(this.file, 'utf8');
+		} catch (error: any) {
+			if (error.code !== 'ENOENT') throw error;
+			return false;
+		}
+		let damaged = false;
+		for (const line of text.split('\n')) {
+			if (line === '') continue;
+			let record: LogRecord;
+			try {
+				record = JSON.parse(line);
+			} catch {
+				// A write cut short by a crash or power loss; everything before it is intact
+				damaged = true;
+				break;
+			}
+			this.replay(record);
+			this.logRecords++;
+		}
+		this.diffFloor = this.currentVersion;
+		if (damaged) this.compact();
+		return true;
+	}
+
+	all(): AddressBookItem[] {
+		return this.order.map((guid) => this.items.get(guid)!);
+	}
+
+	page(offset: number, limit: number): { items: AddressBookItem[]; total: number; version: number } {
+		const start = Math.max(0, offset);
+		return { items: this.order.slice(start, start + Math.max(0, limit)).map((guid) => this.items.get(guid)!), total: this.order.length, version: this.currentVersion };
+	}
+
+	changesSince(since: number): AddressBookChanges {
+		const result: AddressBookChanges = { version: this.currentVersion, total: this.order.length, changed: [], removed: [] };
+		if (!Number.isInteger(since) || since < this.diffFloor || since > this.currentVersion) {
+			result.reset = true;
+			return result;
+		}
+		const seen = new Set<string>();
+		for (let i = this.changeLog.length - 1; i >= 0 && this.changeLog[i].version > since; i--) {
+			const guid = this.changeLog[i].guid;
+			if (seen.has(guid)) continue;
+			seen.add(guid);
+			const item = this.items.get(guid);
+			if (item) result.changed.push({ index: this.positionOf(guid), item });
+			else result.removed.push(guid);
+		}
+		result.changed.sort((a, b) => a.index - b.index);
+		return result;
+	}
+
+	findByAddress(address: string): AddressBookItem | null {
+		if (typeof address !== 'string') return null;
+		const guid = this.byAddress.get(normalizeAddress(address.trim()));
+		return guid ? this.items.get(guid)! : null;
+	}
+
+	findByGuid(guid: string): AddressBookItem | null {
+		return this.items.get(guid) ?? null;
+	}
+
+	validate(name: string, address: string, excludeGuid?: string): ValidationResult {
+		name = typeof name === 'string' ? name.trim() : '';
+		address = typeof address === 'string' ? address.trim() : '';
+		if (!name) return { isValid: false, error: 'Name is required' };
+		if (name.length > MAX_NAME_LENGTH) return { isValid: false, error: `Name is longer than ${MAX_NAME_LENGTH} characters` };
+		if (!address) return { isValid: false, error: 'Address is required' };
+		if (!ADDRESS_PATTERN.test(address) || !checksumMatches(address)) return { isValid: false, error: 'Invalid address' };
+		const existing = this.byAddress.get(normalizeAddress(address));
+		if (existing && existing !== excludeGuid) return { isValid: false, error: `Address already saved as "${this.items.get(existing)!.name}"` };
+		return { isValid: true };
+	}
+
+	add(name: string, address: string): ValidationResult & { item?: AddressBookItem } {
+		const validation = this.validate(name, address);
+		if (!validation.isValid) return validation;
+		const item = { guid: randomUUID(), name: name.trim(), address: address.trim() };
+		this.write([this.put(item)]);
+		return { isValid: true, item };
+	}
+
+	edit(guid: string, name: string, address: string): ValidationResult & { item?: AddressBookItem } {
+		if (!this.items.has(guid)) return { isValid: false, error: 'Item not found' };
+		const validation = this.validate(name, address, guid);
+		if (!validation.isValid) return validation;
+		const item = { guid, name: name.trim(), address: address.trim() };
+		this.write([this.put(item)]);
+		return { isValid: true, item };
+	}
+
+	remove(guid: string): ValidationResult {
+		if (!this.items.has(guid)) return { isValid: false, error: 'Item not found' };
+		this.write([this.apply({ v: this.currentVersion + 1, op: 'del', guid })]);
+		return { isValid: true };
+	}
+
+	// New order by GUID; items left out keep their relative order after the ones given
+	reorder(guids: string[]): ValidationResult {
+		if (!Array.isArray(guids)) return { isValid: false, error: 'Expected a list of items' };
+		const given = new Set(guids.filter((guid) => this.items.has(guid)));
+		const order = [...given, ...this.order.filter((guid) => !given.has(guid))];
+		if (order.every((guid, i) => guid === this.order[i])) return { isValid: true };
+		this.write([this.apply({ v: this.currentVersion + 1, op: 'order', guids: order })]);
+		return { isValid: true };
+	}
+
+	// Adds the valid items that are not in the book yet (by address); with replace the book
+	// is cleared first. Invalid items are reported and skipped.
+	importItems(entries: { name: string; address: string }[], replace = false): { isValid: boolean; imported: number; errors: string[] } {
+		const errors: string[] = [];
+		const records: LogRecord[] = [];
+		const pending = new Set<string>();
+		if (replace) records.push(this.apply({ v: this.currentVersion + 1, op: 'clear' }));
+		entries.forEach((entry, i) => {
+			const validation = this.validate(entry?.name, entry?.address);
+			const key = validation.isValid ? normalizeAddress(entry.address.trim()) : '';
+			if (!validation.isValid || pending.has(key)) {
+				errors.push(`Item ${i + 1}: ${validation.error ?? 'Duplicate address'}`);
+				return;
+			}
+			pending.add(key);
+			records.push(this.put({ guid: randomUUID(), name: entry.name.trim(), address: entry.address.trim() }));
+		});
+		this.write(records);
+		return { isValid: errors.length === 0, imported: records.length - (replace ? 1 : 0), errors };
+	}
+
+	// Rewrites the log as one record per item
+	compact(): void {
+		this.close();
+		const lines = [JSON.stringify({ v: this.currentVersion, op: 'base' })];
+		for (const guid of this.order) {
+			const { name, address } = this.items.get(guid)!;
+			lines.push(JSON.stringify({ v: this.currentVersion, op: 'put', guid, name, address }));
+		}
+		const temp = this.file + '.tmp';
+		fs.mkdirSync(path.dirname(this.file), { recursive: true });
+		const fd = fs.openSync(temp, 'w');
+		try {
+			fs.writeSync(fd, lines.join('\n') + '\n');
+			fs.fsyncSync(fd);
+		} finally {
+			fs.closeSync(fd);
+		}
+		fs.renameSync(temp, this.file);
+		this.logRecords = lines.length;
+	}
+
+	close(): void {
+		if (this.fd === null) return;
+		fs.closeSync(this.fd);
+		this.fd = null;
+	}
+
+	private put(item: AddressBookItem): LogRecord {
+		return this.apply({ v: this.currentVersion + 1, op: 'put', ...item });
+	}
+
+	// Applies a new change in memory and records it for diffs
+	private apply(record: LogRecord): LogRecord {
+		this.replay(record);
+		if (record.op === 'put' || record.op === 'del') {
+			this.changeLog.push({ version: record.v, guid: record.guid });
+			if (this.changeLog.length > MAX_CHANGE_LOG) {
+				const dropped = this.changeLog.splice(0, this.changeLog.length - MAX_CHANGE_LOG);
+				this.diffFloor = dropped[dropped.length - 1].version;
+			}
+		} else {
+			// Order changed or the book was cleared: every position may have moved
+			this.changeLog.length = 0;
+			this.diffFloor = record.v;
+		}
+		return record;
+	}
+
+	private replay(record: LogRecord): void {
+		this.currentVersion = Math.max(this.currentVersion, record.v);
+		switch (record.op) {
+			case 'put': {
+				const previous = this.items.get(record.guid);
+				if (previous) this.byAddress.delete(normalizeAddress(previous.address));
+				else {
+					this.positions.set(record.guid, this.order.length);
+					this.order.push(record.guid);
+				}
+				this.items.set(record.guid, { guid: record.guid, name: record.name, address: record.address });
+				this.byAddress.set(normalizeAddress(record.address), record.guid);
+				break;
+			}
+			case 'del': {
+				const previous = this.items.get(record.guid);
+				if (!previous) break;
+				this.items.delete(record.guid);
+				this.byAddress.delete(normalizeAddress(previous.address));
+				this.order.splice(this.positionOf(record.guid), 1);
+				this.positions.delete(record.guid);
+				this.positionsValid = false;
+				break;
+			}
+			case 'order':
+				this.order = record.guids.filter((guid) => this.items.has(guid));
+				this.positionsValid = false;
+				break;
+			case 'clear':
+				this.items.clear();
+				this.byAddress.clear();
+				this.order = [];
+				this.positions.clear();
+				this.positionsValid = true;
+				break;
+			case 'base':
+				break;
+		}
+	}
+
+	private positionOf(guid: string): number {
+		if (!this.positionsValid) {
+			this.positions.clear();
+			this.order.forEach((g, i) => this.positions.set(g, i));
+			this.positionsValid = true;
+		}
+		return this.positions.get(guid) ?? -1;
+	}
+
+	private write(records: LogRecord[]): void {
+		if (records.length === 0) return;
+		if (this.fd === null) {
+			fs.mkdirSync(path.dirname(this.file), { recursive: true });
+			this.fd = fs.openSync(this.file, 'a');
+		}
+		fs.writeSync(this.fd, records.map((record) => JSON.stringify(record)).join('\n') + '\n');
+		this.logRecords += records.length;
+		if (this.logRecords > COMPACT_MIN_RECORDS && this.logRecords > 2 * this.order.length) this.compact();
+	}
+}
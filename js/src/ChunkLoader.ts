@@ -0,0 +1,67 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import * as vm from 'vm';
+import * as EventQueue from './EventQueue';
+import * as CommandBroker from './CommandBroker';
+
+// The bundle is split so startup only compiles and runs what the first messages need:
+// the core (index.ts, this file, the event queue and the command broker) and one chunk
+// per domain (src/chunks/, built by build.mjs into dist/chunks/). A chunk is loaded on
+// the first action it handles. Inside the app NodeThread serves chunks from the QRC
+// (__nativeRequireChunk), each with its own code cache; under plain node they are read
+// from next to the bundle.
+
+export type Handlers = { [key: string]: (params?: any) => any };
+
+// Action prefix -> chunk. Actions are named <domain><Verb>, e.g. wifiScanNetworks, crypto2addAddressBookItem
+const CHUNKS: { [prefix: string]: string } = {
+	battery: 'battery',
+	power: 'battery',
+	time: 'system',
+	audio: 'system',
+	display: 'system',
+	wifi: 'wifi',
+	system: 'system',
+	firewall: 'firewall',
+	speed: 'speedtest',
+	crypto: 'crypto',
+	crypto2: 'addressbook',
+};
+
+// Modules with state that must exist only once. build.mjs leaves them out of the chunks,
+// which require them by these ids and get the core's instance.
+const SHARED: { [id: string]: any } = {
+	'core:EventQueue': EventQueue,
+	'core:CommandBroker': CommandBroker,
+};
+
+const loaded = new Map<string, Handlers>();
+
+export function chunkForAction(action: string): string | undefined {
+	const prefix = /^[a-z]+[0-9]*/.exec(action);
+	return prefix ? CHUNKS[prefix[0]] : undefined;
+}
+
+function chunkRequire(id: string): any {
+	if (id in SHARED) return SHARED[id];
+	return require(id);
+}
+
+function requireChunkFile(name: string): any {
+	const filename = path.join(__dirname, 'chunks', `${name}.cjs`);
+	const module = { exports: {} as any };
+	const moduleFunc = vm.compileFunction(fs.readFileSync(filename, 'utf8'), ['exports', 'require', 'module', '__filename', '__dirname'], { filename });
+	moduleFunc(module.exports, chunkRequire, module, filename, path.dirname(filename));
+	return module.exports;
+}
+
+// Runs a chunk once and returns its handlers. Throws if the chunk fails to load; the next
+// action from it tries again.
+export function loadChunk(name: string): Handlers {
+	let handlers = loaded.get(name);
+	if (handlers) return handlers;
+	const exports = typeof globalThis.__nativeRequireChunk === 'function' ? globalThis.__nativeRequireChunk(name, chunkRequire) : requireChunkFile(name);
+	handlers = exports.HANDLERS as Handlers;
+	loaded.set(name, handlers);
+	return handlers;
+}
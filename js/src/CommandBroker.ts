@@ -0,0 +1,118 @@
+import { execFile } from 'child_process';
+import { constants } from 'os';
+
+// External commands for the managers, without a shell and without blocking this thread.
+// Inside the app they run through __nativeExec (posix_spawn on a native thread pool, see
+// src/command_broker.cpp); under plain node the same behaviour is provided by execFile.
+
+export interface CommandOptions {
+	// Kill the command (and its children) after this many ms; 0 waits forever
+	timeout?: number;
+	// Share the result of identical calls for this many ms. Read-only queries only.
+	cacheTtl?: number;
+	// The command changes state: drop cached results of the same program first
+	invalidate?: boolean;
+	// Receives stdout as it arrives; streamed calls are never cached
+	onData?: (chunk: string) => void;
+}
+
+export interface CommandResult {
+	stdout: string;
+	stderr: string;
+	code: number | null;
+	cached: boolean;
+}
+
+// Rejection for a command that ran but failed, shaped like execFile's error
+export class CommandError extends Error {
+	code: number | null;
+	signal: number;
+	stdout: string;
+	stderr: string;
+	timedOut: boolean;
+
+	constructor(file: string, args: string[], result: NativeExecResult) {
+		const command = [file, ...args].join(' ');
+		super(result.timedOut ? `Command timed out: ${command}` : `Command failed: ${command}${result.stderr ? '\n' + result.stderr : ''}`);
+		this.code = result.code;
+		this.signal = result.signal;
+		this.stdout = result.stdout;
+		this.stderr = result.stderr;
+		this.timedOut = result.timedOut;
+	}
+}
+
+interface NativeExecResult {
+	code: number | null;
+	signal: number;
+	stdout: string;
+	stderr: string;
+	timedOut: boolean;
+	cached: boolean;
+	durationMs: number;
+}
+
+type NativeExec = (file: string, args: string[], options: CommandOptions) => Promise<NativeExecResult>;
+
+const DEFAULT_TIMEOUT_MS = 30000;
+const MAX_BUFFER = 4 * 1024 * 1024;
+
+// Fallback cache, keyed like the native one; holds the promise so concurrent calls share it
+const fallbackCache = new Map<string, { expires: number; result: Promise<NativeExecResult> }>();
+
+function fallbackExec(file: string, args: string[], options: CommandOptions): Promise<NativeExecResult> {
+	const key = [file, ...args].join('\0');
+	if (options.invalidate) {
+		for (const cached of fallbackCache.keys()) {
+			if (cached === file || cached.startsWith(file + '\0')) fallbackCache.delete(cached);
+		}
+	}
+	const cacheable = !!options.cacheTtl && !options.onData;
+	const cached = cacheable ? fallbackCache.get(key) : undefined;
+	if (cached && cached.expires > Date.now()) return cached.result.then((result) => ({ ...result, cached: true }));
+
+	const started = Date.now();
+	const result = new Promise<NativeExecResult>((resolve, reject) => {
+		const child = execFile(file, args, { timeout: options.timeout ?? DEFAULT_TIMEOUT_MS, killSignal: 'SIGKILL', maxBuffer: MAX_BUFFER }, (error: any, stdout, stderr) => {
+			// Spawn failures have a string code (ENOENT, ...), exit failures a number or null
+			if (error && typeof error.code === 'string') {
+				reject(error);
+				return;
+			}
+			resolve({
+				code: error ? error.code ?? null : 0,
+				signal: error && error.signal ? (constants.signals as any)[error.signal] ?? 0 : 0,
+				stdout: stdout.toString(),
+				stderr: stderr.toString(),
+				timedOut: !!(error && error.killed && error.signal === 'SIGKILL'),
+				cached: false,
+				durationMs: Date.now() - started,
+			});
+		});
+		if (options.onData) child.stdout?.on('data', (chunk) => options.onData!(chunk.toString()));
+	});
+	if (cacheable) {
+		fallbackCache.set(key, { expires: Infinity, result });
+		result.then(
+			// Unless an invalidate dropped this run (or a later one replaced it) meanwhile
+			(value) => {
+				if (fallbackCache.get(key)?.result !== result) return;
+				if (value.timedOut) fallbackCache.delete(key);
+				else fallbackCache.set(key, { expires: Date.now() + options.cacheTtl!, result });
+			},
+			() => {
+				if (fallbackCache.get(key)?.result === result) fallbackCache.delete(key);
+			}
+		);
+	}
+	return result;
+}
+
+// Resolves when the command exits with 0, rejects with CommandError otherwise (or with the
+// spawn error when it could not be started), like promisify(execFile)
+export async function runCommand(file: string, args: string[] = [], options: CommandOptions = {}): Promise<CommandResult> {
+	const nativeExec: NativeExec | undefined = (globalThis as any).__nativeExec;
+	const result = typeof nativeExec === 'function' ? await nativeExec(file, args, options) : await fallbackExec(file, args, options);
+	if (result.code !== 0) throw new CommandError(file, args, result);
+	return { stdout: result.stdout, stderr: result.stderr, code: result.code, cached: result.cached };
+}
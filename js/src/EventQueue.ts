@@ -13,6 +13,16 @@ export const eventQueue =
         events: [] as IEvent[],
     };
 
+// Push an event to the native side; falls back to the popEvents queue when the
+// bundle runs without the embedding (e.g. standalone under plain node)
+export function emitEvent(type: string, value: any): void {
+    if (typeof (globalThis as any).__nativeEmit === 'function') {
+        (globalThis as any).__nativeEmit(type, value);
+        return;
+    }
+    eventQueue.events.push({ type, value });
+}
+
 export function popEvents(): IEvent[] {
     const events = eventQueue.events;
     eventQueue.events = [];
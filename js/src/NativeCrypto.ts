@@ -0,0 +1,86 @@
+import { createHash } from 'crypto';
+
+// Wallet primitives for crypto0.js. Inside the app keccak-256, secp256k1, BIP-32/39 and
+// EIP-55 run in C++ (__nativeCrypto, see src/native_crypto.cpp); under plain node, or
+// with NODE_NATIVE_CRYPTO=0, it is unset and callers fall back to ethers.
+//
+// Phrases are checked against the BIP-39 wordlist here. The wordlist is the one ethers
+// uses, loaded on its own, so the rest of ethers is not needed for it.
+
+export interface NativeWallet {
+	privateKey: string;
+	publicKey: string;
+	address: string;
+}
+
+export interface NativeCryptoBinding {
+	keccak256(data: string | Uint8Array): string;
+	keccak256Batch(data: (string | Uint8Array)[]): string[];
+	// EIP-55 form, or null when not a valid hex address
+	checksumAddress(address: string): string | null;
+	mnemonicToSeed(phrase: string, passphrase?: string): string;
+	walletFromMnemonic(phrase: string, path?: string, passphrase?: string): NativeWallet;
+	walletFromPrivateKey(privateKey: string): NativeWallet;
+}
+
+export function nativeCrypto(): NativeCryptoBinding | undefined {
+	return (globalThis as any).__nativeCrypto;
+}
+
+let wordlist: any = null;
+function englishWordlist() {
+	if (!wordlist) wordlist = require('ethers/wordlists').LangEn.wordlist();
+	return wordlist;
+}
+
+function sha256(data: Uint8Array): Buffer {
+	return createHash('sha256').update(data).digest();
+}
+
+// Same checks as ethers' Mnemonic.phraseToEntropy()
+export function phraseToEntropy(phrase: string): Buffer {
+	const words = englishWordlist();
+	const list: string[] = words.split(phrase);
+	if (list.length % 3 !== 0 || list.length < 12 || list.length > 24) throw new Error('invalid mnemonic length');
+
+	const packed = Buffer.alloc(Math.ceil((11 * list.length) / 8));
+	let offset = 0;
+	list.forEach((word, i) => {
+		const index = words.getWordIndex(word.normalize('NFKD'));
+		if (index < 0) throw new Error(`invalid mnemonic word at index ${i}`);
+		for (let bit = 10; bit >= 0; bit--, offset++) {
+			if (index & (1 << bit)) packed[offset >> 3] |= 1 << (7 - (offset % 8));
+		}
+	});
+
+	// 32 bits of entropy per 3 words, then one checksum bit per 3 words in the last byte
+	const entropyBytes = (4 * list.length) / 3;
+	const mask = (0xff << (8 - list.length / 3)) & 0xff;
+	const entropy = packed.subarray(0, entropyBytes);
+	if ((sha256(entropy)[0] & mask) !== (packed[entropyBytes] & mask)) throw new Error('invalid mnemonic checksum');
+	return entropy;
+}
+
+// Same result as ethers' Mnemonic.entropyToPhrase()
+export function entropyToPhrase(entropy: Uint8Array): string {
+	if (entropy.length % 4 !== 0 || entropy.length < 16 || entropy.length > 32) throw new Error('invalid entropy size');
+	const words = englishWordlist();
+	const bits = Buffer.concat([entropy, sha256(entropy).subarray(0, 1)]);
+	const count = (entropy.length * 8 + entropy.length / 4) / 11;
+	const list: string[] = [];
+	for (let i = 0; i < count; i++) {
+		let index = 0;
+		for (let bit = 0; bit < 11; bit++) {
+			const offset = i * 11 + bit;
+			index = (index << 1) | ((bits[offset >> 3] >> (7 - (offset % 8))) & 1);
+		}
+		list.push(words.getWord(index));
+	}
+	return words.join(list);
+}
+
+// Validates a phrase and puts it in canonical form (lower case, single spaces), like
+// Mnemonic.fromPhrase() does before computing the seed
+export function normalizePhrase(phrase: string): string {
+	return entropyToPhrase(phraseToEntropy(phrase));
+}
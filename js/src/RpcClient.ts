@@ -0,0 +1,220 @@
+import * as http from 'http';
+import * as https from 'https';
+
+// JSON-RPC client for the wallet's Ethereum endpoints, one per endpoint URL.
+//
+// Each client keeps its connections open (keep-alive agent), so only the first call pays
+// for the TCP and TLS handshakes. Calls made during the same loop iteration go out as one
+// JSON-RPC batch. State reads are pinned to the latest block number and cached until a
+// newer block shows up, so refreshing balances within the same block sends nothing.
+
+const REQUEST_TIMEOUT_MS = 15000;
+// Public endpoints reject or throttle larger batches
+const MAX_BATCH_SIZE = 50;
+const MAX_SOCKETS = 4;
+// Idle pooled connections are closed after this long; servers drop them eventually anyway
+const IDLE_SOCKET_TIMEOUT_MS = 30000;
+
+// How long the latest block number is trusted before asking again, NODE_RPC_BLOCK_TTL_MS.
+// Well below Ethereum's 12 s block time; results lag the chain by at most this much.
+function blockNumberTtl(): number {
+	const env = process.env.NODE_RPC_BLOCK_TTL_MS;
+	if (env !== undefined && env !== '') {
+		const ttl = parseInt(env, 10);
+		if (Number.isFinite(ttl) && ttl >= 0) return ttl;
+	}
+	return 2000;
+}
+
+const BLOCK_NUMBER_TTL_MS = blockNumberTtl();
+
+// An error object returned by the node for one call
+export class RpcError extends Error {
+	code: number;
+	data?: any;
+
+	constructor(error: { code: number; message: string; data?: any }) {
+		super(error.message);
+		this.code = error.code;
+		this.data = error.data;
+	}
+}
+
+export interface RpcStats {
+	// HTTP requests sent; a batch is one request
+	httpRequests: number;
+	// JSON-RPC calls sent
+	calls: number;
+	// Reads answered from the block cache
+	cacheHits: number;
+}
+
+interface PendingCall {
+	request: { jsonrpc: '2.0'; id: number; method: string; params: any[] };
+	resolve: (result: any) => void;
+	reject: (error: Error) => void;
+}
+
+function toQuantity(value: number): string {
+	return '0x' + value.toString(16);
+}
+
+export class RpcClient {
+	readonly url: URL;
+	readonly stats: RpcStats = { httpRequests: 0, calls: 0, cacheHits: 0 };
+	private readonly transport: typeof http | typeof https;
+	private readonly agent: http.Agent;
+	private nextId = 1;
+	private queue: PendingCall[] = [];
+	private flushScheduled = false;
+
+	private latestBlock: { number: number; fetchedAt: number } | null = null;
+	private blockRequest: Promise<number> | null = null;
+	// Results read at cacheBlock, by method and params
+	private cacheBlock = -1;
+	private readonly cache = new Map<string, Promise<any>>();
+
+	constructor(url: string) {
+		this.url = new URL(url);
+		if (this.url.protocol !== 'http:' && this.url.protocol !== 'https:') throw new Error(`Unsupported RPC URL: ${url}`);
+		this.transport = this.url.protocol === 'https:' ? https : http;
+		// Pooled sockets are unref'd while idle, so they do not keep the event loop alive
+		this.agent = new this.transport.Agent({ keepAlive: true, maxSockets: MAX_SOCKETS, timeout: IDLE_SOCKET_TIMEOUT_MS });
+	}
+
+	call<T = any>(method: string, params: any[] = []): Promise<T> {
+		return new Promise<T>((resolve, reject) => {
+			this.queue.push({ request: { jsonrpc: '2.0', id: this.nextId++, method, params }, resolve, reject });
+			if (this.flushScheduled) return;
+			this.flushScheduled = true;
+			// After the current loop iteration, so calls from every message handled in it share a batch
+			setImmediate(() => this.flush());
+		});
+	}
+
+	// Latest block number, asked for at most once per BLOCK_NUMBER_TTL_MS; concurrent callers share the request
+	blockNumber(): Promise<number> {
+		if (this.latestBlock && Date.now() - this.latestBlock.fetchedAt < BLOCK_NUMBER_TTL_MS) return Promise.resolve(this.latestBlock.number);
+		if (!this.blockRequest) {
+			this.blockRequest = this.call<string>('eth_blockNumber')
+				.then((hex) => {
+					const number = parseInt(hex, 16);
+					this.latestBlock = { number, fetchedAt: Date.now() };
+					return number;
+				})
+				.finally(() => {
+					this.blockRequest = null;
+				});
+		}
+		return this.blockRequest;
+	}
+
+	// A read at a given block; params already carry the block tag. Cached until a newer block is
+	// seen. An older block (a lagging node behind a load balancer) is read but not cached.
+	callAtBlock<T = any>(block: number, method: string, params: any[]): Promise<T> {
+		if (block < this.cacheBlock) return this.call<T>(method, params);
+		if (block > this.cacheBlock) {
+			this.cache.clear();
+			this.cacheBlock = block;
+		}
+		const key = method + JSON.stringify(params);
+		const cached = this.cache.get(key);
+		if (cached) {
+			this.stats.cacheHits++;
+			return cached;
+		}
+		const result = this.call<T>(method, params);
+		this.cache.set(key, result);
+		// Failures are not cached
+		result.catch(() => {
+			if (this.cache.get(key) === result) this.cache.delete(key);
+		});
+		return result;
+	}
+
+	// Balances in wei at the latest block, in the order given
+	async getBalances(addresses: string[]): Promise<{ block: number; balances: bigint[] }> {
+		const block = await this.blockNumber();
+		const tag = toQuantity(block);
+		const balances = await Promise.all(addresses.map((address) => this.callAtBlock<string>(block, 'eth_getBalance', [address.toLowerCase(), tag]).then((wei) => BigInt(wei))));
+		return { block, balances };
+	}
+
+	// The latest block with transaction hashes, as returned by eth_getBlockByNumber
+	async getLatestBlock(): Promise<any> {
+		const block = await this.blockNumber();
+		const result = await this.callAtBlock(block, 'eth_getBlockByNumber', [toQuantity(block), false]);
+		if (!result) throw new Error(`Block ${block} not found`);
+		return result;
+	}
+
+	private flush(): void {
+		this.flushScheduled = false;
+		const calls = this.queue.splice(0);
+		for (let i = 0; i < calls.length; i += MAX_BATCH_SIZE) this.send(calls.slice(i, i + MAX_BATCH_SIZE));
+	}
+
+	private async send(calls: PendingCall[]): Promise<void> {
+		this.stats.calls += calls.length;
+		try {
+			const response = await this.post(calls.length === 1 ? calls[0].request : calls.map((call) => call.request));
+			if (calls.length > 1 && !Array.isArray(response)) {
+				// Batch refused as a whole
+				throw response?.error ? new RpcError(response.error) : new Error(`Invalid JSON-RPC batch response from ${this.url.host}`);
+			}
+			const replies = new Map<number, any>();
+			for (const reply of Array.isArray(response) ? response : [response]) replies.set(reply?.id, reply);
+			for (const call of calls) {
+				const reply = replies.get(call.request.id);
+				if (!reply) call.reject(new Error(`No JSON-RPC response to ${call.request.method} from ${this.url.host}`));
+				else if (reply.error) call.reject(new RpcError(reply.error));
+				else call.resolve(reply.result);
+			}
+		} catch (error: any) {
+			for (const call of calls) call.reject(error);
+		}
+	}
+
+	private post(body: any): Promise<any> {
+		const payload = Buffer.from(JSON.stringify(body));
+		this.stats.httpRequests++;
+		return new Promise((resolve, reject) => {
+			const options = {
+				method: 'POST',
+				agent: this.agent,
+				timeout: REQUEST_TIMEOUT_MS,
+				headers: { 'content-type': 'application/json', 'content-length': payload.length },
+			};
+			const request = this.transport.request(this.url, options, (response) => {
+				const chunks: Buffer[] = [];
+				response.on('data', (chunk: Buffer) => chunks.push(chunk));
+				response.on('error', reject);
+				response.on('end', () => {
+					if (response.statusCode !== 200) {
+						reject(new Error(`HTTP ${response.statusCode} from ${this.url.host}`));
+						return;
+					}
+					try {
+						resolve(JSON.parse(Buffer.concat(chunks).toString('utf8')));
+					} catch {
+						reject(new Error(`Invalid JSON-RPC response from ${this.url.host}`));
+					}
+				});
+			});
+			request.on('timeout', () => request.destroy(new Error(`JSON-RPC request to ${this.url.host} timed out`)));
+			request.on('error', reject);
+			request.end(payload);
+		});
+	}
+}
+
+const clients = new Map<string, RpcClient>();
+
+export function rpcClient(url: string): RpcClient {
+	let client = clients.get(url);
+	if (!client) {
+		client = new RpcClient(url);
+		clients.set(url, client);
+	}
+	return client;
+}
@@ -0,0 +1,158 @@
+import { Worker } from 'worker_threads';
+import * as cryptoModule from 'crypto';
+import * as os from 'os';
+
+// Task bodies run both in the workers and inline, so they may only use the crypto
+// module passed in and must not capture anything from this file.
+const TASKS: { [task: string]: (crypto: typeof cryptoModule, args: any) => any } = {
+	generateKeyPair(crypto, { type, options }) {
+		return crypto.generateKeyPairSync(type, options);
+	},
+	pbkdf2(crypto, { password, salt, iterations, keyLength, digest }) {
+		return crypto.pbkdf2Sync(password, salt, iterations, keyLength, digest).toString('hex');
+	},
+};
+
+// CPU-heavy work must not run on the main isolate, where it would stall every other
+// request (battery, WiFi, ...). Tasks run in worker threads, each with its own isolate.
+// Workers are started from inline source because the bundle itself is not on disk.
+const WORKER_SOURCE = `
+const { parentPort } = require('worker_threads');
+const crypto = require('crypto');
+const TASKS = { ${Object.values(TASKS)
+	.map((fn) => fn.toString())
+	.join(',\n')} };
+
+parentPort.on('message', ({ id, task, args }) => {
+	try {
+		const run = TASKS[task];
+		if (!run) throw new Error('Unknown worker task: ' + task);
+		parentPort.postMessage({ id, result: run(crypto, args) });
+	} catch (error) {
+		parentPort.postMessage({ id, error: { message: error.message, stack: error.stack } });
+	}
+});
+`;
+
+interface Task {
+	id: number;
+	task: string;
+	args: any;
+	resolve: (value: any) => void;
+	reject: (error: Error) => void;
+}
+
+interface PoolWorker {
+	worker: Worker;
+	current: Task | null;
+}
+
+function defaultPoolSize(): number {
+	const env = process.env.NODE_WORKER_POOL_SIZE;
+	if (env !== undefined && env !== '') {
+		const size = parseInt(env, 10);
+		if (Number.isFinite(size) && size >= 0) return size;
+	}
+	// Leave one core for the main isolate and the Qt GUI thread
+	return Math.max(1, Math.min(2, os.cpus().length - 1));
+}
+
+class WorkerPool {
+	private readonly size: number;
+	private readonly workers: PoolWorker[] = [];
+	private readonly queue: Task[] = [];
+	private nextId = 1;
+	private disabled = false;
+
+	constructor(size: number) {
+		this.size = size;
+		this.disabled = size === 0;
+	}
+
+	run<T = any>(task: string, args: any): Promise<T> {
+		if (this.disabled) return this.runInline(task, args);
+		return new Promise<T>((resolve, reject) => {
+			this.queue.push({ id: this.nextId++, task, args, resolve, reject });
+			this.dispatch();
+		});
+	}
+
+	// Worker count is reported as started workers, which grow lazily up to the pool size
+	stats(): { size: number; busy: number; queued: number } {
+		return { size: this.workers.length, busy: this.workers.filter((w) => w.current).length, queued: this.queue.length };
+	}
+
+	private async runInline<T>(task: string, args: any): Promise<T> {
+		const run = TASKS[task];
+		if (!run) throw new Error(`Unknown worker task: ${task}`);
+		return run(cryptoModule, args);
+	}
+
+	private dispatch(): void {
+		while (this.queue.length > 0) {
+			let idle = this.workers.find((w) => !w.current);
+			if (!idle && this.workers.length < this.size) idle = this.spawn() ?? undefined;
+			if (!idle) {
+				if (this.disabled) this.drainInline();
+				return;
+			}
+			const task = this.queue.shift()!;
+			idle.current = task;
+			// Only busy workers keep the event loop alive
+			idle.worker.ref();
+			idle.worker.postMessage({ id: task.id, task: task.task, args: task.args });
+		}
+	}
+
+	private spawn(): PoolWorker | null {
+		let worker: Worker;
+		try {
+			worker = new Worker(WORKER_SOURCE, { eval: true });
+		} catch (error: any) {
+			console.error('WorkerPool: Cannot start worker thread, running tasks inline:', error.message);
+			this.disabled = true;
+			return null;
+		}
+		// Idle workers must not keep the event loop alive
+		worker.unref();
+
+		const entry: PoolWorker = { worker, current: null };
+		worker.on('message', ({ id, result, error }) => {
+			const task = entry.current;
+			if (!task || task.id !== id) return;
+			entry.current = null;
+			worker.unref();
+			if (error) {
+				const err = new Error(error.message);
+				err.stack = error.stack;
+				task.reject(err);
+			} else task.resolve(result);
+			this.dispatch();
+		});
+		const retire = (error: Error) => {
+			const index = this.workers.indexOf(entry);
+			if (index < 0) return;
+			this.workers.splice(index, 1);
+			const task = entry.current;
+			entry.current = null;
+			if (task) task.reject(error);
+			this.dispatch();
+		};
+		worker.on('error', (error) => retire(error));
+		worker.on('exit', (code) => retire(new Error(`Worker exited with code ${code}`)));
+
+		this.workers.push(entry);
+		return entry;
+	}
+
+	private drainInline(): void {
+		const tasks = this.queue.splice(0);
+		for (const task of tasks) this.runInline(task.task, task.args).then(task.resolve, task.reject);
+	}
+}
+
+export const workerPool = new WorkerPool(defaultPoolSize());
+
+export function runInWorker<T = any>(task: string, args: any): Promise<T> {
+	return workerPool.run<T>(task, args);
+}
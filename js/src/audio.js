@@ -1,21 +1,24 @@
-import { exec } from 'child_process';
-import { promisify } from 'util';
+import { runCommand } from './CommandBroker';
 
-const execAsync = promisify(exec);
+// The control list is only logged; it does not change while the app runs
+const CONTROLS_CACHE_TTL_MS = 60 * 1000;
 
 class AudioManager {
 	async getVolume() {
 		try {
 
 			// Try different methods to get volume
-			const volumeCommands = ['amixer get Master | grep -o "[0-9]*%" | head -1 | tr -d "%"'];
+			const volumeCommands = [['amixer', 'get', 'Master']];
 
 			let lastError = null;
-			for (const cmd of volumeCommands) {
+			for (const [file, ...args] of volumeCommands) {
+				const cmd = [file, ...args].join(' ');
 				try {
 					console.log('Trying volume command: ' + cmd);
-					const { stdout } = await execAsync(cmd);
-					const volume = parseInt(stdout.trim()) || 0;
+					const { stdout } = await runCommand(file, args);
+					// First channel's percentage, e.g. "Front Left: Playback 45 [69%] [on]"
+					const match = stdout.match(/(\d+)%/);
+					const volume = match ? parseInt(match[1]) : 0;
 
 					return {
 						status: 'success',
@@ -56,20 +59,34 @@ class AudioManager {
 
 			// First try to detect available audio devices
 			try {
-				const devices = await execAsync('amixer controls | grep -i master');
-				console.log('Available audio controls:', devices.stdout);
+				const { stdout } = await runCommand('amixer', ['controls'], { cacheTtl: CONTROLS_CACHE_TTL_MS });
+				const masterControls = stdout.split('\n').filter((line) => /master/i.test(line));
+				console.log('Available audio controls:', masterControls.join('\n'));
 			} catch (e) {
 				console.log('Could not list audio controls:', e.message);
 			}
 
 			// Try different methods to set volume
-			const volumeCommands = [`amixer sset Master ${volume}%`, `amixer -q sset Master ${volume}%`, `pactl set-sink-volume @DEFAULT_SINK@ ${volume}%`, `amixer -c 0 sset Master ${volume}%`, `amixer -D pulse sset Master ${volume}%`, `alsactl --file /tmp/asound.state store && amixer sset Master ${volume}% && alsactl --file /tmp/asound.state restore`];
+			// Each method is a list of commands run in order
+			const volumeCommands = [
+				[['amixer', 'sset', 'Master', `${volume}%`]],
+				[['amixer', '-q', 'sset', 'Master', `${volume}%`]],
+				[['pactl', 'set-sink-volume', '@DEFAULT_SINK@', `${volume}%`]],
+				[['amixer', '-c', '0', 'sset', 'Master', `${volume}%`]],
+				[['amixer', '-D', 'pulse', 'sset', 'Master', `${volume}%`]],
+				[
+					['alsactl', '--file', '/tmp/asound.state', 'store'],
+					['amixer', 'sset', 'Master', `${volume}%`],
+					['alsactl', '--file', '/tmp/asound.state', 'restore'],
+				],
+			];
 
 			let lastError = null;
-			for (const cmd of volumeCommands) {
+			for (const steps of volumeCommands) {
+				const cmd = steps.map((step) => step.join(' ')).join(' && ');
 				try {
 					console.log('Trying volume set command: ' + cmd);
-					await execAsync(cmd);
+					for (const [file, ...args] of steps) await runCommand(file, args);
 
 					// Verify the volume was set by trying to read it back
 					const verifyResult = await this.getVolume();
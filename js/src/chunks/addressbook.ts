@@ -0,0 +1,95 @@
+import type { Handlers } from '../ChunkLoader';
+import { AddressBookStore } from '../AddressBookStore';
+import { emitEvent } from '../EventQueue';
+
+let store: AddressBookStore | null = null;
+
+function addressBook(): AddressBookStore {
+	if (store) return store;
+	store = new AddressBookStore();
+	if (!store.load()) {
+		migrateLegacyBook(store);
+		// Even an empty book gets a log now, so later starts never need libersoft-crypto again
+		store.compact();
+	}
+	return store;
+}
+
+// Entries kept by libersoft-crypto before the address book had its own log
+function migrateLegacyBook(book: AddressBookStore): void {
+	try {
+		const crypto2 = require('libersoft-crypto');
+		const items = require('svelte/store').get(crypto2.addressBook);
+		if (Array.isArray(items) && items.length > 0) {
+			const result = book.importItems(items);
+			console.log(`Address book: migrated ${result.imported} of ${items.length} items`);
+		}
+	} catch (error: any) {
+		console.log('Address book: nothing to migrate:', error.message);
+	}
+}
+
+// Pages ask for the changes since the version they have; the list itself is not sent
+function notifyChanged(result: any) {
+	if (result.isValid !== false) emitEvent('crypto2.addressBook.subscribe', { version: addressBook().version });
+	return result;
+}
+
+function parseImport(text: string): { name: string; address: string }[] {
+	const items = JSON.parse(text);
+	if (!Array.isArray(items)) throw new Error('Expected a list of address book items');
+	return items;
+}
+
+function importText(text: string, replace: boolean) {
+	let items;
+	try {
+		items = parseImport(text);
+	} catch (error: any) {
+		return { isValid: false, error: error.message };
+	}
+	return notifyChanged(addressBook().importItems(items, replace));
+}
+
+export const HANDLERS: Handlers = {
+	crypto2addAddressBookItem: (params) => notifyChanged(addressBook().add(params.name, params.address)),
+	crypto2editAddressBookItem: (params) => notifyChanged(addressBook().edit(params.itemGuid, params.name, params.address)),
+	crypto2deleteAddressBookItem: (params) => notifyChanged(addressBook().remove(params.itemGuid)),
+	crypto2findAddressBookItemByAddress: (params) => addressBook().findByAddress(params.address),
+	crypto2findAddressBookItemByID: (params) => addressBook().findByGuid(params.guid),
+	crypto2hasAddressBookItems: () => addressBook().size > 0,
+	// Whole book, or one page of it with {offset, limit}
+	crypto2getAddressBookItems: (params) => {
+		const book = addressBook();
+		const page = book.page(params?.offset ?? 0, params?.limit ?? book.size);
+		return { status: 'success', data: page.items, total: page.total, version: page.version };
+	},
+	// Rows added, edited or removed after version {since}, see AddressBookStore.changesSince()
+	crypto2getAddressBookChanges: (params) => ({ status: 'success', ...addressBook().changesSince(params?.since) }),
+	crypto2validateAddressBookItem: (params) => addressBook().validate(params.name, params.address, params.excludeItemGuid),
+	crypto2importAddressBookItems: (params) => importText(params.text, false),
+	crypto2replaceAddressBook: (params) => importText(params.text, true),
+	crypto2reorderAddressBook: (params) => {
+		const guids = (params.reorderedItems || []).map((item: any) => (typeof item === 'string' ? item : item?.guid));
+		return notifyChanged(addressBook().reorder(guids));
+	},
+	crypto2validateAddressBookImport: (params) => {
+		let items;
+		try {
+			items = parseImport(params.text);
+		} catch (error: any) {
+			return { isValid: false, error: error.message };
+		}
+		const book = addressBook();
+		const seen = new Set<string>();
+		const errors: string[] = [];
+		items.forEach((item, i) => {
+			const validation = book.validate(item?.name, item?.address);
+			const key = validation.isValid ? item.address.trim().toLowerCase() : '';
+			if (!validation.isValid) errors.push(`Item ${i + 1}: ${validation.error}`);
+			else if (seen.has(key)) errors.push(`Item ${i + 1}: Duplicate address`);
+			seen.add(key);
+		});
+		return { isValid: errors.length === 0, count: items.length, errors };
+	},
+};
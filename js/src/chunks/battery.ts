@@ -0,0 +1,17 @@
+import type { Handlers } from '../ChunkLoader';
+
+// Battery info comes from systeminformation, which the wifi chunk bundles separately
+// @ts-ignore
+import BatteryManager from '../battery.js';
+// @ts-ignore
+import PowerManager from '../power.js';
+
+const batteryManager = new BatteryManager();
+const powerManager = new PowerManager();
+
+export const HANDLERS: Handlers = {
+	batteryGetInfo: () => batteryManager.getBatteryInfo(),
+	batteryCheckStatus: () => batteryManager.checkBatteryStatus(),
+	powerReboot: () => powerManager.reboot(),
+	powerShutdown: () => powerManager.shutdown(),
+};
@@ -0,0 +1,22 @@
+import type { Handlers } from '../ChunkLoader';
+
+// @ts-ignore
+import CryptoManager from '../crypto0.js';
+
+const cryptoManager = new CryptoManager();
+
+// crypto0.js handlers. cryptoGenerateKeyPair and cryptoWalletFromMnemonic are CPU-bound
+// and do their heavy part in the worker pool (WorkerPool.ts), off this isolate
+export const HANDLERS: Handlers = {
+	cryptoHash: (params) => cryptoManager.hash(params),
+	cryptoGenerateKeyPair: () => cryptoManager.generateKeyPair(),
+	cryptoGenerateRandomBytes: (params) => cryptoManager.generateRandomBytes(params),
+	cryptoHmac: (params) => cryptoManager.hmac(params),
+	cryptoCreateWallet: () => cryptoManager.createWallet(),
+	cryptoWalletFromMnemonic: (params) => cryptoManager.walletFromMnemonic(params),
+	cryptoWalletFromPrivateKey: (params) => cryptoManager.walletFromPrivateKey(params),
+	cryptoValidateAddress: (params) => cryptoManager.validateAddress(params),
+	cryptoKeccak256: (params) => cryptoManager.keccak256(params),
+	cryptoGetLatestBlock: (params) => cryptoManager.getLatestBlock(params),
+	cryptoGetBalance: (params) => cryptoManager.getBalance(params),
+};
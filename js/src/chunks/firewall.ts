@@ -0,0 +1,15 @@
+import type { Handlers } from '../ChunkLoader';
+
+// @ts-ignore
+import FirewallManager from '../firewall.js';
+
+const firewallManager = new FirewallManager();
+
+export const HANDLERS: Handlers = {
+	firewallGetStatus: () => firewallManager.getFirewallStatus(),
+	firewallSetEnabled: (params) => firewallManager.setFirewallEnabled(params.enabled),
+	firewallSetExceptionEnabled: (params) => firewallManager.setExceptionEnabled(params.port, params.protocol, params.enabled, params.description),
+	firewallAddException: (params) => firewallManager.addException(params.port, params.protocol, params.description),
+	firewallRemoveException: (params) => firewallManager.removeException(params.port, params.protocol),
+	firewallResetToDefaults: () => firewallManager.resetToDefaults(),
+};
@@ -0,0 +1,12 @@
+import type { Handlers } from '../ChunkLoader';
+
+// @ts-ignore
+import SpeedTestManager from '../speedtest.js';
+
+const speedTestManager = new SpeedTestManager();
+
+export const HANDLERS: Handlers = {
+	speedPing: (params) => speedTestManager.ping(params),
+	speedDownload: (params) => speedTestManager.download(params),
+	speedUpload: (params) => speedTestManager.upload(params),
+};
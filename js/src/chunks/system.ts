@@ -0,0 +1,33 @@
+import type { Handlers } from '../ChunkLoader';
+
+// Managers without heavy dependencies; wifi and battery/power, which pull in node-wifi and
+// systeminformation, are chunks of their own
+// @ts-ignore
+import TimeManager from '../time.js';
+// @ts-ignore
+import AudioManager from '../audio.js';
+// @ts-ignore
+import DisplayManager from '../display.js';
+// @ts-ignore
+import SystemManager from '../system.js';
+
+const timeManager = new TimeManager();
+const audioManager = new AudioManager();
+const displayManager = new DisplayManager();
+const systemManager = new SystemManager();
+
+export const HANDLERS: Handlers = {
+	timeListTimeZones: () => timeManager.listTimeZones(),
+	timeGetCurrentTimezone: () => timeManager.getCurrentTimezone(),
+	timeChangeTimeZone: (params) => timeManager.changeTimeZone(params),
+	timeSetAutoTimeSync: (params) => timeManager.setAutoTimeSync(params),
+	timeGetAutoTimeSyncStatus: () => timeManager.getAutoTimeSyncStatus(),
+	timeSetSystemDateTime: (params) => timeManager.setSystemDateTime(params),
+	audioGetVolume: () => audioManager.getVolume(),
+	audioSetVolume: (params) => audioManager.setVolume(params),
+	displayGetBrightness: () => displayManager.getBrightness(),
+	displaySetBrightness: (params) => displayManager.setBrightness(params),
+	systemGetCurrentVersion: () => systemManager.getCurrentSystemVersion(),
+	systemGetLatestVersion: () => systemManager.getLatestSystemVersion(),
+	systemGetLatestAppVersion: () => systemManager.getLatestApplicationVersion(),
+};
@@ -0,0 +1,18 @@
+import type { Handlers } from '../ChunkLoader';
+
+// node-wifi and systeminformation: only paid for once a WiFi page asks
+// @ts-ignore
+import WifiManager from '../wifi.js';
+
+const wifiManager = new WifiManager();
+
+export const HANDLERS: Handlers = {
+	wifiScanNetworks: (params) => wifiManager.scanNetworks(params),
+	wifiGetNetworks: () => wifiManager.getNetworks(),
+	wifiConnectToNetwork: (params) => wifiManager.connectToNetwork(params),
+	wifiDisconnect: () => wifiManager.disconnect(),
+	wifiGetConnectionStatus: () => wifiManager.getConnectionStatus(),
+	wifiGetCurrentStrength: () => wifiManager.getCurrentStrength(),
+	wifiGetInterfaceInfo: () => wifiManager.getInterfaceInfo(),
+	wifiReinitializeInterface: (params) => wifiManager.reinitializeInterface(params),
+};
@@ -1,6 +1,12 @@
 // proof of concept of loading nodejs crypto module and ethers.js library in embedded environment
 
 const crypto0 = require('crypto');
+const { runInWorker } = require('./WorkerPool');
+const { nativeCrypto, entropyToPhrase, normalizePhrase } = require('./NativeCrypto');
+const { rpcClient } = require('./RpcClient');
+
+const DEFAULT_BLOCK_RPC = 'https://ethereum-rpc.publicnode.com';
+const DEFAULT_BALANCE_RPC = 'https://eth.llamarpc.com';
 
 // Lazy-load ethers to avoid module loading issues in embedded environment
 let ethers = null;
@@ -29,11 +35,15 @@ class CryptoManager {
 		};
 	}
 
-	generateKeyPair() {
-		const { publicKey, privateKey } = crypto0.generateKeyPairSync('rsa', {
-			modulusLength: 2048,
-			publicKeyEncoding: { type: 'spki', format: 'pem' },
-			privateKeyEncoding: { type: 'pkcs8', format: 'pem' },
+	// RSA key generation takes hundreds of ms, so it runs in the worker pool
+	async generateKeyPair() {
+		const { publicKey, privateKey } = await runInWorker('generateKeyPair', {
+			type: 'rsa',
+			options: {
+				modulusLength: 2048,
+				publicKeyEncoding: { type: 'spki', format: 'pem' },
+				privateKeyEncoding: { type: 'pkcs8', format: 'pem' },
+			},
 		});
 
 		return {
@@ -71,8 +81,23 @@ class CryptoManager {
 		};
 	}
 
-	// Ethereum wallet functions using ethers.js
+	// Ethereum wallet functions. These use __nativeCrypto when the app provides it and
+	// ethers.js otherwise. Both accept the same input (private keys with or without 0x) and
+	// give the same keys and addresses; only the error messages differ.
 	createWallet() {
+		const native = nativeCrypto();
+		if (native) {
+			// Like Wallet.createRandom(): 16 bytes of entropy, 12 words, default path
+			const mnemonic = entropyToPhrase(crypto0.randomBytes(16));
+			const wallet = native.walletFromMnemonic(mnemonic);
+			return {
+				status: 'success',
+				address: wallet.address,
+				privateKey: wallet.privateKey,
+				mnemonic: mnemonic,
+			};
+		}
+
 		const ethers = getEthers();
 		const wallet = ethers.Wallet.createRandom();
 		return {
@@ -83,14 +108,36 @@ class CryptoManager {
 		};
 	}
 
-	walletFromMnemonic(params = {}) {
+	// Same result as ethers.Wallet.fromPhrase(), but the BIP-39 seed (2048 rounds of
+	// PBKDF2-SHA512) is computed in the worker pool; only the HD derivation runs here
+	async walletFromMnemonic(params = {}) {
 		const mnemonic = params?.mnemonic;
 		if (!mnemonic) {
 			throw new Error('Missing mnemonic phrase');
 		}
 
+		const native = nativeCrypto();
+		if (native) {
+			// A few ms of PBKDF2 in C++, cheaper than a round trip to the worker pool
+			const wallet = native.walletFromMnemonic(normalizePhrase(mnemonic));
+			return {
+				status: 'success',
+				address: wallet.address,
+				privateKey: wallet.privateKey,
+			};
+		}
+
 		const ethers = getEthers();
-		const wallet = ethers.Wallet.fromPhrase(mnemonic);
+		// Validates the checksum and normalizes the phrase the way Mnemonic.fromPhrase() does
+		const phrase = ethers.Mnemonic.entropyToPhrase(ethers.Mnemonic.phraseToEntropy(mnemonic));
+		const seed = await runInWorker('pbkdf2', {
+			password: phrase.normalize('NFKD'),
+			salt: 'mnemonic',
+			iterations: 2048,
+			keyLength: 64,
+			digest: 'sha512',
+		});
+		const wallet = ethers.HDNodeWallet.fromSeed('0x' + seed).derivePath(ethers.defaultPath);
 		return {
 			status: 'success',
 			address: wallet.address,
@@ -104,8 +151,8 @@ class CryptoManager {
 			throw new Error('Missing private key');
 		}
 
-		const ethers = getEthers();
-		const wallet = new ethers.Wallet(privateKey);
+		const native = nativeCrypto();
+		const wallet = native ? native.walletFromPrivateKey(privateKey) : new (getEthers().Wallet)(privateKey);
 		return {
 			status: 'success',
 			address: wallet.address,
@@ -116,6 +163,16 @@ class CryptoManager {
 	validateAddress(params = {}) {
 		const address = params?.address;
 		try {
+			const native = nativeCrypto();
+			// ICAP addresses (XE...) are rare enough to leave to ethers
+			if (native && !/^XE[0-9]{2}[0-9A-Za-z]{30,31}$/.test(address)) {
+				const checksumAddress = native.checksumAddress(address);
+				return {
+					status: 'success',
+					isValid: checksumAddress !== null,
+					checksumAddress: checksumAddress,
+				};
+			}
 			const ethers = getEthers();
 			const isValid = ethers.isAddress(address);
 			return {
@@ -132,14 +189,23 @@ class CryptoManager {
 		}
 	}
 
+	// {input} hashes one string, {inputs: [...]} a list of them in one call
 	keccak256(params = {}) {
+		const native = nativeCrypto();
+		if (Array.isArray(params?.inputs)) {
+			const hashes = native ? native.keccak256Batch(params.inputs) : params.inputs.map((input) => getEthers().keccak256(getEthers().toUtf8Bytes(input)));
+			return {
+				status: 'success',
+				hashes: hashes,
+			};
+		}
+
 		const data = params?.input;
 		if (!data) {
 			throw new Error('Missing data for keccak256 hash');
 		}
 
-		const ethers = getEthers();
-		const hash = ethers.keccak256(ethers.toUtf8Bytes(data));
+		const hash = native ? native.keccak256(data) : getEthers().keccak256(getEthers().toUtf8Bytes(data));
 		return {
 			status: 'success',
 			hash: hash,
@@ -148,36 +214,15 @@ class CryptoManager {
 
 	// Async function to get latest block from Ethereum mainnet
 	async getLatestBlock(params = {}) {
-		const rpcUrl = params?.rpcUrl;
-		console.log('CryptoHandler.getLatestBlock...:', rpcUrl);
-		console.log('Checking network capabilities...');
-
-		// Check what networking globals are available
-		console.log('typeof fetch:', typeof fetch);
-		console.log('typeof XMLHttpRequest:', typeof XMLHttpRequest);
-		console.log('process.versions.node:', process.versions.node);
-
 		try {
-			console.log('Testing fetch functionality...');
-			const testResponse = await fetch('https://httpbin.org/json');
-			const testData = await testResponse.json();
-			console.log('Fetch test successful, received data keys:', Object.keys(testData));
-
-			console.log('Creating ethers.JsonRpcProvider...');
-			const ethers = getEthers();
-			const provider = new ethers.JsonRpcProvider('https://ethereum-rpc.publicnode.com');
-			console.log('Provider created successfully');
-
-			console.log('Attempting to fetch latest block...');
-			const block = await provider.getBlock('latest');
-
+			const block = await rpcClient(params?.rpcUrl || DEFAULT_BLOCK_RPC).getLatestBlock();
 			return {
 				status: 'success',
-				blockNumber: block.number,
+				blockNumber: Number(block.number),
 				blockHash: block.hash,
-				timestamp: block.timestamp,
-				gasUsed: block.gasUsed.toString(),
-				gasLimit: block.gasLimit.toString(),
+				timestamp: Number(block.timestamp),
+				gasUsed: BigInt(block.gasUsed).toString(),
+				gasLimit: BigInt(block.gasLimit).toString(),
 				transactionCount: block.transactions.length,
 			};
 		} catch (error) {
@@ -185,38 +230,39 @@ class CryptoManager {
 			return {
 				status: 'error',
 				message: `Network error: ${error.message}`,
-				capabilities: {
-					fetch: typeof fetch,
-					XMLHttpRequest: typeof XMLHttpRequest,
-					nodeVersion: process.versions.node,
-				},
 			};
 		}
 	}
 
-	// Async function to get ETH balance for an address
+	// ETH balance of an address, or of several ({addresses: [...]}) sent as one batch. Read at the
+	// latest block, so a refresh within the same block is answered from the RpcClient cache.
 	async getBalance(params = {}) {
-		const address = params?.address;
-		const rpcUrl = params?.rpcUrl;
-
-		if (!address) {
+		const addresses = params?.addresses ?? (params?.address ? [params.address] : null);
+		if (!addresses || addresses.length === 0) {
 			throw new Error('Missing address for balance query');
 		}
+		for (const address of addresses) {
+			if (typeof address !== 'string' || !/^0x[0-9a-fA-F]{40}$/.test(address)) throw new Error(`Invalid address: ${address}`);
+		}
 
-		const ethers = getEthers();
-		console.log('ETHERS:', ethers);
-		console.log('ETHERS.VERSION:', ethers.version);
-		const provider = new ethers.JsonRpcProvider(rpcUrl || 'https://eth.llamarpc.com');
-		console.log('PROVIDER:', provider);
-
-		const balance = await provider.getBalance(address);
-		return {
-			status: 'success',
+		const { block, balances } = await rpcClient(params?.rpcUrl || DEFAULT_BALANCE_RPC).getBalances(addresses);
+		const results = addresses.map((address, i) => ({
 			address: address,
-			balanceWei: balance.toString(),
-			balanceEth: ethers.formatEther(balance),
-		};
+			balanceWei: balances[i].toString(),
+			balanceEth: formatEther(balances[i]),
+		}));
+		if (params?.addresses) {
+			return { status: 'success', blockNumber: block, balances: results };
+		}
+		return { status: 'success', blockNumber: block, ...results[0] };
 	}
 }
 
+// Same output as ethers.formatEther(): at least one decimal, no trailing zeros
+function formatEther(wei) {
+	const unit = 10n ** 18n;
+	const fraction = (wei % unit).toString().padStart(18, '0').replace(/0+$/, '');
+	return `${wei / unit}.${fraction || '0'}`;
+}
+
 module.exports = CryptoManager;
@@ -1,15 +1,15 @@
-import { exec } from 'child_process';
-import { promisify } from 'util';
+import { runCommand } from './CommandBroker';
 
-const execAsync = promisify(exec);
+// The panel's maximum is fixed
+const MAX_BRIGHTNESS_CACHE_TTL_MS = 10 * 60 * 1000;
 
 class DisplayManager {
 	async getBrightness() {
 		try {
 			console.log('Getting brightness using brightnessctl');
-			const { stdout } = await execAsync('brightnessctl get');
+			const { stdout } = await runCommand('brightnessctl', ['get']);
 			const currentBrightness = parseInt(stdout.trim()) || 0;
-			const { stdout: maxBrightnessOutput } = await execAsync('brightnessctl max');
+			const { stdout: maxBrightnessOutput } = await runCommand('brightnessctl', ['max'], { cacheTtl: MAX_BRIGHTNESS_CACHE_TTL_MS });
 			const maxBrightness = parseInt(maxBrightnessOutput.trim()) || 255;
 			const brightnessPercentage = Math.round((currentBrightness / maxBrightness) * 100);
 			return {
@@ -36,7 +36,7 @@ class DisplayManager {
 			const brightness = parseInt(params.brightness);
 			if (isNaN(brightness) || brightness < 0 || brightness > 100) throw new Error('Invalid brightness level. Must be between 0 and 100.');
 			console.log('Setting system brightness to ' + brightness + '%');
-			await execAsync('brightnessctl set ' + brightness + '%');
+			await runCommand('brightnessctl', ['set', brightness + '%']);
 			const verifyResult = await this.getBrightness();
 			return {
 				status: 'success',
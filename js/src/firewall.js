@@ -1,10 +1,13 @@
-const { execSync } = require('child_process');
+import { runCommand } from './CommandBroker';
+
+// ufw status is polled by the settings page; writes drop the cached copy
+const STATUS_CACHE_TTL_MS = 2000;
 
 class FirewallManager {
 	// Get current firewall status
 	async getFirewallStatus() {
 		try {
-			const status = execSync('ufw status', { encoding: 'utf8' });
+			const { stdout: status } = await runCommand('ufw', ['status'], { cacheTtl: STATUS_CACHE_TTL_MS });
 			const isEnabled = status.includes('Status: active');
 			// Parse existing rules
 			const rules = this.parseUfwRules(status);
@@ -63,12 +66,12 @@ class FirewallManager {
 		try {
 			if (enabled) {
 				// Enable UFW with default deny incoming, allow outgoing
-				execSync('ufw --force reset', { stdio: 'pipe' });
-				execSync('ufw default deny incoming', { stdio: 'pipe' });
-				execSync('ufw default allow outgoing', { stdio: 'pipe' });
-				execSync('ufw --force enable', { stdio: 'pipe' });
+				await runCommand('ufw', ['--force', 'reset'], { invalidate: true });
+				await runCommand('ufw', ['default', 'deny', 'incoming'], { invalidate: true });
+				await runCommand('ufw', ['default', 'allow', 'outgoing'], { invalidate: true });
+				await runCommand('ufw', ['--force', 'enable'], { invalidate: true });
 			} else {
-				execSync('ufw --force disable', { stdio: 'pipe' });
+				await runCommand('ufw', ['--force', 'disable'], { invalidate: true });
 			}
 			return {
 				status: 'success',
@@ -104,8 +107,8 @@ class FirewallManager {
 			}
 			// Add the rule with comment
 			const finalDescription = description || `Port ${portNum}`;
-			const command = `ufw allow ${portNum}/${protocol.toLowerCase()} comment '${finalDescription}'`;
-			execSync(command, { stdio: 'pipe' });
+			// No shell, so the description needs no quoting
+			await runCommand('ufw', ['allow', `${portNum}/${protocol.toLowerCase()}`, 'comment', finalDescription], { invalidate: true });
 			return {
 				status: 'success',
 				message: `Port ${portNum}/${protocol} added successfully`,
@@ -146,7 +149,7 @@ class FirewallManager {
 			const action = enabled ? 'allow' : 'deny';
 			const finalDescription = description || `Port ${portNum}`;
 			// Use UFW to allow or deny the port with comment
-			execSync(`ufw ${action} ${portNum}/${protocol.toLowerCase()} comment '${finalDescription}'`, { stdio: 'pipe' });
+			await runCommand('ufw', [action, `${portNum}/${protocol.toLowerCase()}`, 'comment', finalDescription], { invalidate: true });
 			return {
 				status: 'success',
 				message: `Port ${portNum}/${protocol} ${enabled ? 'enabled' : 'disabled'} successfully`,
@@ -178,8 +181,7 @@ class FirewallManager {
 				};
 			}
 			// Remove the rule
-			const command = `ufw delete allow ${portNum}/${protocol.toLowerCase()}`;
-			execSync(command, { stdio: 'pipe' });
+			await runCommand('ufw', ['delete', 'allow', `${portNum}/${protocol.toLowerCase()}`], { invalidate: true });
 			return {
 				status: 'success',
 				message: `Port ${portNum}/${protocol} removed successfully`,
@@ -198,14 +200,14 @@ class FirewallManager {
 	async resetToDefaults() {
 		try {
 			// Reset UFW
-			execSync('ufw --force reset', { stdio: 'pipe' });
-			execSync('ufw default deny incoming', { stdio: 'pipe' });
-			execSync('ufw default allow outgoing', { stdio: 'pipe' });
+			await runCommand('ufw', ['--force', 'reset'], { invalidate: true });
+			await runCommand('ufw', ['default', 'deny', 'incoming'], { invalidate: true });
+			await runCommand('ufw', ['default', 'allow', 'outgoing'], { invalidate: true });
 			// Add default enabled ports
 			for (const defaultPort of this.defaultPorts) {
 				if (defaultPort.enabled) await this.addException(defaultPort.port, defaultPort.protocol, defaultPort.description);
 			}
-			execSync('ufw --force enable', { stdio: 'pipe' });
+			await runCommand('ufw', ['--force', 'enable'], { invalidate: true });
 			return {
 				status: 'success',
 				message: 'Firewall reset to defaults successfully',
@@ -1,32 +1,11 @@
-import * as crypto2 from 'libersoft-crypto';
-import { crypto2getAddressBookItems } from './crypto2_helper';
 import { popEvents } from './EventQueue';
+import { chunkForAction, loadChunk, type Handlers } from './ChunkLoader';
 
-// @ts-ignore
-import WifiManager from './wifi.js';
-// @ts-ignore
-import BatteryManager from './battery.js';
-// @ts-ignore
-import PowerManager from './power.js';
-// @ts-ignore
-import TimeManager from './time.js';
-// @ts-ignore
-import AudioManager from './audio.js';
-// @ts-ignore
-import DisplayManager from './display.js';
 // @ts-ignore
 import TestManager from './test.js';
-// @ts-ignore
-import SystemManager from './system.js';
-// @ts-ignore
-import FirewallManager from './firewall.js';
-// @ts-ignore
-import CryptoManager from './crypto0.js';
-// @ts-ignore
-import SpeedTestManager from './speedtest.js';
 
 interface Message {
-	messageId: string;
+	messageId: number;
 	action: string;
 	data?: any;
 }
@@ -39,92 +18,28 @@ interface ErrorResult {
 
 declare global {
 	var handleMessage: (message: Message, callback?: any) => Promise<void>;
-	var __nativeCallback: (messageId: string, result: any) => void;
+	var __nativeCallback: (messageId: number, result: any) => void;
+	var __nativeEmit: (type: string, value: any) => void;
+	var __nativeExec: (file: string, args: string[], options?: any) => Promise<any>;
+	var __nativeCrypto: import('./NativeCrypto').NativeCryptoBinding | undefined;
 	var __nativeRequire: (module: string) => any;
+	var __nativeRequireChunk: ((name: string, require: (id: string) => any) => any) | undefined;
 	var NodeJS: any;
 	var applicationName: any;
 	var applicationVersion: any;
 	var wifiStrengthUpdateInterval: any;
 	var batteryStatusUpdateInterval: any;
-	var eventsPollInterval: any;
 }
-const wifiManager = new WifiManager();
-const batteryManager = new BatteryManager();
-const powerManager = new PowerManager();
-const timeManager = new TimeManager();
-const audioManager = new AudioManager();
-const displayManager = new DisplayManager();
 const testManager = new TestManager();
-const systemManager = new SystemManager();
-const firewallManager = new FirewallManager();
-const cryptoManager = new CryptoManager();
-const speedTestManager = new SpeedTestManager();
 
-const HANDLERS: { [key: string]: (params?: any) => any } = {
+// Core handlers. Everything else is in the chunks (see ChunkLoader.ts), whose handlers are
+// added here when the first action for them comes in.
+const HANDLERS: Handlers = {
 	popEvents: () => popEvents(),
 
 	testPing: () => testManager.ping(),
 	testDelayedPing: (params) => testManager.delayedPing(params),
-	batteryGetInfo: () => batteryManager.getBatteryInfo(),
-	batteryCheckStatus: () => batteryManager.checkBatteryStatus(),
-	powerReboot: () => powerManager.reboot(),
-	powerShutdown: () => powerManager.shutdown(),
-	timeListTimeZones: () => timeManager.listTimeZones(),
-	timeGetCurrentTimezone: () => timeManager.getCurrentTimezone(),
-	timeChangeTimeZone: (params) => timeManager.changeTimeZone(params),
-	timeSetAutoTimeSync: (params) => timeManager.setAutoTimeSync(params),
-	timeGetAutoTimeSyncStatus: () => timeManager.getAutoTimeSyncStatus(),
-	timeSetSystemDateTime: (params) => timeManager.setSystemDateTime(params),
-	audioGetVolume: () => audioManager.getVolume(),
-	audioSetVolume: (params) => audioManager.setVolume(params),
-	displayGetBrightness: () => displayManager.getBrightness(),
-	displaySetBrightness: (params) => displayManager.setBrightness(params),
-	wifiScanNetworks: (params) => wifiManager.scanNetworks(params),
-	wifiGetNetworks: () => wifiManager.getNetworks(),
-	wifiConnectToNetwork: (params) => wifiManager.connectToNetwork(params),
-	wifiDisconnect: () => wifiManager.disconnect(),
-	wifiGetConnectionStatus: () => wifiManager.getConnectionStatus(),
-	wifiGetCurrentStrength: () => wifiManager.getCurrentStrength(),
-	wifiGetInterfaceInfo: () => wifiManager.getInterfaceInfo(),
-	wifiReinitializeInterface: (params) => wifiManager.reinitializeInterface(params),
-	systemGetCurrentVersion: () => systemManager.getCurrentSystemVersion(),
-	systemGetLatestVersion: () => systemManager.getLatestSystemVersion(),
-	systemGetLatestAppVersion: () => systemManager.getLatestApplicationVersion(),
-	firewallGetStatus: () => firewallManager.getFirewallStatus(),
-	firewallSetEnabled: (params) => firewallManager.setFirewallEnabled(params.enabled),
-	firewallSetExceptionEnabled: (params) => firewallManager.setExceptionEnabled(params.port, params.protocol, params.enabled, params.description),
-	firewallAddException: (params) => firewallManager.addException(params.port, params.protocol, params.description),
-	firewallRemoveException: (params) => firewallManager.removeException(params.port, params.protocol),
-	firewallResetToDefaults: () => firewallManager.resetToDefaults(),
-
-	crypto2addAddressBookItem: (params) => crypto2.addAddressBookItem(params.name, params.address),
-	crypto2editAddressBookItem: (params) => crypto2.editAddressBookItem(params.itemGuid, params.name, params.address),
-	crypto2deleteAddressBookItem: (params) => crypto2.deleteAddressBookItem(params.itemGuid),
-	crypto2findAddressBookItemByAddress: (params) => crypto2.findAddressBookItemByAddress(params.address),
-	crypto2findAddressBookItemByID: (params) => crypto2.findAddressBookItemByID(params.guid),
-	crypto2hasAddressBookItems: () => crypto2.hasAddressBookItems(),
-	crypto2getAddressBookItems: () => crypto2getAddressBookItems(),
-	crypto2validateAddressBookItem: (params) => crypto2.validateAddressBookItem(params.name, params.address, params.excludeItemGuid),
-	crypto2importAddressBookItems: (params) => crypto2.importAddressBookItems(params.text),
-	crypto2replaceAddressBook: (params) => crypto2.replaceAddressBook(params.text),
-	crypto2reorderAddressBook: (params) => crypto2.reorderAddressBook(params.reorderedItems),
-	crypto2validateAddressBookImport: (params) => crypto2.validateAddressBookImport(params.text),
-
-	// crypto0.js handlers
-	cryptoHash: (params) => cryptoManager.hash(params),
-	cryptoGenerateKeyPair: () => cryptoManager.generateKeyPair(),
-	cryptoGenerateRandomBytes: (params) => cryptoManager.generateRandomBytes(params),
-	cryptoHmac: (params) => cryptoManager.hmac(params),
-	cryptoCreateWallet: () => cryptoManager.createWallet(),
-	cryptoWalletFromMnemonic: (params) => cryptoManager.walletFromMnemonic(params),
-	cryptoWalletFromPrivateKey: (params) => cryptoManager.walletFromPrivateKey(params),
-	cryptoValidateAddress: (params) => cryptoManager.validateAddress(params),
-	cryptoKeccak256: (params) => cryptoManager.keccak256(params),
-	cryptoGetLatestBlock: (params) => cryptoManager.getLatestBlock(params),
-	cryptoGetBalance: (params) => cryptoManager.getBalance(params),
-	speedPing: (params) => speedTestManager.ping(params),
-	speedDownload: (params) => speedTestManager.download(params),
-	speedUpload: (params) => speedTestManager.upload(params),
+	testReplay: (params) => testManager.replay(params),
 };
 
 (global as any).handleMessage = async function (message: Message, callback?: any): Promise<void> {
@@ -132,7 +47,14 @@ const HANDLERS: { [key: string]: (params?: any) => any } = {
 	const { messageId, action, data } = message;
 	try {
 		let result: any = {};
-		const handler = HANDLERS[action];
+		let handler = HANDLERS[action];
+		if (handler === undefined) {
+			const chunk = chunkForAction(action);
+			if (chunk) {
+				Object.assign(HANDLERS, loadChunk(chunk));
+				handler = HANDLERS[action];
+			}
+		}
 		//console.log('Handler for action', action, ':', typeof handler);
 		if (typeof handler === 'function') {
 			//console.log('Calling handler for', action, 'with data:', data);
@@ -1,6 +1,5 @@
 const fs = require('fs');
 const https = require('https');
-const { execSync } = require('child_process');
 
 class SystemManager {
 	/**
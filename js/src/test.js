@@ -22,6 +22,17 @@ class TestManager {
 			}, delay);
 		});
 	}
+
+	// Stand-in for a recorded request in bench/bridge_replay: answers after the recorded
+	// handler time with a result of the recorded size, without touching the system
+	async replay(params = {}) {
+		const delay = params?.delay || 0;
+		if (delay >= 1) await new Promise((resolve) => setTimeout(resolve, delay));
+		return {
+			status: params?.ok === false ? 'error' : 'success',
+			data: 'x'.repeat(params?.resultBytes || 0),
+		};
+	}
 }
 
 export default TestManager;
@@ -1,7 +1,8 @@
-import { exec } from 'child_process';
-import { promisify } from 'util';
+import { runCommand } from './CommandBroker';
 
-const execAsync = promisify(exec);
+// The zone list only changes with a tzdata upgrade
+const ZONE_LIST_CACHE_TTL_MS = 10 * 60 * 1000;
+const ZONEINFO_DIR = '/usr/share/zoneinfo/';
 
 class TimeManager {
 	async listTimeZones() {
@@ -34,7 +35,7 @@ class TimeManager {
 	async loadSystemTimeZones() {
 		try {
 			console.log('Loading timezones using timedatectl only');
-			const { stdout } = await execAsync('timedatectl list-timezones 2>/dev/null');
+			const { stdout } = await runCommand('timedatectl', ['list-timezones'], { cacheTtl: ZONE_LIST_CACHE_TTL_MS });
 			if (stdout && stdout.trim()) {
 				const allTimezones = stdout
 					.trim()
@@ -45,12 +46,13 @@ class TimeManager {
 
 					// Use more efficient filtering - get list of actual timezone files first
 					try {
-						const { stdout: filesOutput } = await execAsync('find /usr/share/zoneinfo -type f | grep -v "/right/" | grep -v "/posix/" | sed "s|/usr/share/zoneinfo/||" | sort');
+						const { stdout: filesOutput } = await runCommand('find', [ZONEINFO_DIR, '-type', 'f'], { cacheTtl: ZONE_LIST_CACHE_TTL_MS });
 						const existingFiles = new Set(
 							filesOutput
 								.trim()
 								.split('\n')
-								.filter((f) => f.length > 0)
+								.filter((f) => f.length > 0 && !f.includes('/right/') && !f.includes('/posix/'))
+								.map((f) => f.substring(ZONEINFO_DIR.length))
 						);
 
 						// Filter timezones to only include those with actual files
@@ -81,20 +83,21 @@ class TimeManager {
 
 			// Try multiple timezone change methods in order of preference
 			const timezoneCommands = [
-				'timedatectl set-timezone ' + params.timezone, // systemd timedatectl (preferred)
-				'sudo timedatectl set-timezone ' + params.timezone, // with sudo
-				'ln -sf /usr/share/zoneinfo/' + params.timezone + ' /etc/localtime', // direct symlink
-				'sudo ln -sf /usr/share/zoneinfo/' + params.timezone + ' /etc/localtime', // with sudo
+				['timedatectl', 'set-timezone', params.timezone], // systemd timedatectl (preferred)
+				['sudo', 'timedatectl', 'set-timezone', params.timezone], // with sudo
+				['ln', '-sf', ZONEINFO_DIR + params.timezone, '/etc/localtime'], // direct symlink
+				['sudo', 'ln', '-sf', ZONEINFO_DIR + params.timezone, '/etc/localtime'], // with sudo
 			];
 
 			let lastError = null;
-			for (const cmd of timezoneCommands) {
+			for (const [file, ...args] of timezoneCommands) {
+				const cmd = [file, ...args].join(' ');
 				try {
 					console.log('Trying timezone command: ' + cmd);
-					await execAsync(cmd);
+					await runCommand(file, args);
 
 					// Verify the change worked
-					const { stdout } = await execAsync('timedatectl show --property=Timezone --value');
+					const { stdout } = await runCommand('timedatectl', ['show', '--property=Timezone', '--value']);
 					const currentTimezone = stdout.trim();
 
 					if (currentTimezone === params.timezone) {
@@ -129,17 +132,16 @@ class TimeManager {
 	async setAutoTimeSync(params) {
 		try {
 			console.log('Setting auto time sync to:', params.enabled);
-			const ntpCommand = params.enabled ? 'timedatectl set-ntp true' : 'timedatectl set-ntp false';
-			const sudoNtpCommand = params.enabled ? 'sudo timedatectl set-ntp true' : 'sudo timedatectl set-ntp false';
+			const ntpArgs = ['set-ntp', params.enabled ? 'true' : 'false'];
 			try {
-				console.log('Trying command: ' + ntpCommand);
-				await execAsync(ntpCommand);
+				console.log('Trying command: timedatectl ' + ntpArgs.join(' '));
+				await runCommand('timedatectl', ntpArgs);
 			} catch (error) {
-				console.log('Command failed, trying with sudo: ' + sudoNtpCommand);
-				await execAsync(sudoNtpCommand);
+				console.log('Command failed, trying with sudo: sudo timedatectl ' + ntpArgs.join(' '));
+				await runCommand('sudo', ['timedatectl', ...ntpArgs]);
 			}
 			// Verify the change
-			const { stdout } = await execAsync('timedatectl status');
+			const { stdout } = await runCommand('timedatectl', ['status']);
 			const ntpEnabled = stdout.includes('NTP enabled: yes') || stdout.includes('Network time on: yes');
 			return {
 				status: 'success',
@@ -163,7 +165,7 @@ class TimeManager {
 			console.log('Getting current system timezone');
 
 			// Get current timezone from system
-			const { stdout } = await execAsync('timedatectl show --property=Timezone --value');
+			const { stdout } = await runCommand('timedatectl', ['show', '--property=Timezone', '--value']);
 			const currentTimezone = stdout.trim();
 
 			if (currentTimezone) {
@@ -194,7 +196,7 @@ class TimeManager {
 			console.log('Getting current auto time sync status');
 
 			// Get current time sync status
-			const { stdout } = await execAsync('timedatectl status');
+			const { stdout } = await runCommand('timedatectl', ['status']);
 			const ntpEnabled = stdout.includes('NTP enabled: yes') || stdout.includes('Network time on: yes') || stdout.includes('NTP service: active');
 
 			return {
@@ -245,16 +247,22 @@ class TimeManager {
 			const dateTimeString = `${formattedDate} ${formattedTime}`;
 
 			// Try multiple methods to set the date/time
-			const setTimeCommands = [`timedatectl set-time "${dateTimeString}"`, `sudo timedatectl set-time "${dateTimeString}"`, `date -s "${dateTimeString}"`, `sudo date -s "${dateTimeString}"`];
+			const setTimeCommands = [
+				['timedatectl', 'set-time', dateTimeString],
+				['sudo', 'timedatectl', 'set-time', dateTimeString],
+				['date', '-s', dateTimeString],
+				['sudo', 'date', '-s', dateTimeString],
+			];
 
 			let lastError = null;
-			for (const cmd of setTimeCommands) {
+			for (const [file, ...args] of setTimeCommands) {
+				const cmd = [file, ...args].join(' ');
 				try {
 					console.log('Trying set time command:', cmd);
-					await execAsync(cmd);
+					await runCommand(file, args);
 
 					// Verify the change worked by checking current time
-					const { stdout } = await execAsync('date "+%Y-%m-%d %H:%M:%S"');
+					const { stdout } = await runCommand('date', ['+%Y-%m-%d %H:%M:%S']);
 					const currentDateTime = stdout.trim();
 
 					console.log('Successfully set system date/time to:', currentDateTime);
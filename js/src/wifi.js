@@ -1,9 +1,6 @@
 import wifi from 'node-wifi';
 import si from 'systeminformation';
-import { exec } from 'child_process';
-import { promisify } from 'util';
-
-const execAsync = promisify(exec);
+import { runCommand } from './CommandBroker';
 
 class WifiManager {
 	constructor() {
@@ -23,12 +20,13 @@ class WifiManager {
 			// Try system approach first - more reliable
 
 			try {
-				// Use ip command to list interfaces
-				const { stdout } = await execAsync('ip link show | grep -E "^[0-9]+: (wlan|wlp|wifi|wl)" | cut -d: -f2 | cut -d@ -f1 | sed "s/ //g"');
+				// Use ip command to list interfaces, one per line: "3: wlan0: <BROADCAST,...> ..."
+				const { stdout } = await runCommand('ip', ['-o', 'link', 'show']);
 				const systemWifiInterfaces = stdout
-					.trim()
 					.split('\n')
-					.filter((iface) => iface.length > 0);
+					.map((line) => line.match(/^\d+:\s*([^:@\s]+)/))
+					.filter((match) => match && /^(wlan|wlp|wifi|wl)/.test(match[1]))
+					.map((match) => match[1]);
 
 				if (systemWifiInterfaces.length > 0) {
 					this.wifiInterface = systemWifiInterfaces[0];
@@ -0,0 +1,206 @@
+#include "include/audiomixer.h"
+
+#include <QDebug>
+#include <QSocketNotifier>
+#include <cmath>
+
+#ifdef ENABLE_NODEJS
+#include "include/native_handlers.h"
+#endif
+
+#ifdef HAVE_ALSA
+#include <alsa/asoundlib.h>
+#include <poll.h>
+#endif
+
+// Slider drags produce a set per frame; this folds them into one write
+static const int kApplyDelayMs = 20;
+
+#ifdef HAVE_ALSA
+// Same scale as amixer's percentages
+static int toPercent(long raw, long min, long max) {
+	return qBound(0, int(std::lround((raw - min) * 100.0 / (max - min))), 100);
+}
+
+static long fromPercent(int percent, long min, long max) {
+	return min + std::lround((max - min) * percent / 100.0);
+}
+#endif
+
+AudioMixer::AudioMixer(QObject *parent) : AudioMixer(QStringLiteral("default"), parent) {}
+
+AudioMixer::AudioMixer(const QString &card, QObject *parent) : QObject(parent), m_volume(kDefaultVolume), m_pending(-1), m_applyQueued(false), m_mixer(nullptr), m_element(nullptr), m_min(0), m_max(0) {
+	m_applyTimer.setSingleShot(true);
+	m_applyTimer.setInterval(kApplyDelayMs);
+	connect(&m_applyTimer, &QTimer::timeout, this, &AudioMixer::applyPending);
+
+	if (!card.isEmpty() && open(card)) {
+		syncFromMixer();
+	} else {
+		qInfo() << "AudioMixer: No mixer control, keeping volume in memory";
+	}
+}
+
+AudioMixer::~AudioMixer() {
+	close();
+}
+
+int AudioMixer::volume() const {
+	const int pending = m_pending.load();
+	return pending >= 0 ? pending : m_volume.load();
+}
+
+void AudioMixer::setVolume(int volume) {
+	m_pending.store(qBound(0, volume, 100));
+	if (m_applyQueued.exchange(true)) return;
+	// May be called from a native handler thread; the timer lives on ours
+	QMetaObject::invokeMethod(this, [this]() { m_applyTimer.start(); }, Qt::QueuedConnection);
+}
+
+void AudioMixer::applyPending() {
+	// Cleared first: a set racing with us schedules another (possibly empty) apply
+	m_applyQueued.store(false);
+	const int target = m_pending.exchange(-1);
+	if (target < 0) return;
+
+#ifdef HAVE_ALSA
+	if (m_element) {
+		const int error = snd_mixer_selem_set_playback_volume_all(m_element, fromPercent(target, m_min, m_max));
+		if (error < 0) qWarning() << "AudioMixer: Cannot set" << m_control << "volume:" << snd_strerror(error);
+		// What the control actually took, its steps may be coarser than 1%
+		syncFromMixer();
+		return;
+	}
+#endif
+	if (m_volume.exchange(target) != target) emit volumeChanged();
+}
+
+void AudioMixer::syncFromMixer() {
+#ifdef HAVE_ALSA
+	if (!m_element) return;
+	long raw = 0;
+	// amixer reports the first channel too; mono controls have it as well
+	if (snd_mixer_selem_get_playback_volume(m_element, SND_MIXER_SCHN_FRONT_LEFT, &raw) < 0) return;
+	const int percent = toPercent(raw, m_min, m_max);
+	const bool changed = m_volume.exchange(percent) != percent;
+	// A newer set is about to overwrite this, announcing it would make the slider jump back
+	if (changed && m_pending.load() < 0) emit volumeChanged();
+#endif
+}
+
+void AudioMixer::handleEvents() {
+#ifdef HAVE_ALSA
+	snd_mixer_handle_events(m_mixer);
+	syncFromMixer();
+#endif
+}
+
+bool AudioMixer::open(const QString &card) {
+#ifdef HAVE_ALSA
+	snd_mixer_t *mixer = nullptr;
+	if (snd_mixer_open(&mixer, 0) < 0) return false;
+	const QByteArray device = card.toLocal8Bit();
+	if (snd_mixer_attach(mixer, device.constData()) < 0 || snd_mixer_selem_register(mixer, nullptr, nullptr) < 0 || snd_mixer_load(mixer) < 0) {
+		snd_mixer_close(mixer);
+		return false;
+	}
+
+	// audio.js drives Master; cards without one usually name it one of the others
+	static const char *const kPreferred[] = {"Master", "PCM", "Speaker", "Headphone"};
+	snd_mixer_selem_id_t *id;
+	snd_mixer_selem_id_alloca(&id);
+	snd_mixer_elem_t *element = nullptr;
+	for (const char *name : kPreferred) {
+		snd_mixer_selem_id_set_index(id, 0);
+		snd_mixer_selem_id_set_name(id, name);
+		snd_mixer_elem_t *candidate = snd_mixer_find_selem(mixer, id);
+		if (candidate && snd_mixer_selem_has_playback_volume(candidate)) {
+			element = candidate;
+			break;
+		}
+	}
+	for (snd_mixer_elem_t *candidate = snd_mixer_first_elem(mixer); !element && candidate; candidate = snd_mixer_elem_next(candidate)) {
+		if (snd_mixer_selem_is_active(candidate) && snd_mixer_selem_has_playback_volume(candidate)) element = candidate;
+	}
+	long min = 0, max = 0;
+	if (!element || snd_mixer_selem_get_playback_volume_range(element, &min, &max) < 0 || max <= min) {
+		snd_mixer_close(mixer);
+		return false;
+	}
+
+	m_mixer = mixer;
+	m_element = element;
+	m_min = min;
+	m_max = max;
+	m_control = QString::fromLatin1(snd_mixer_selem_get_name(element));
+
+	// External changes (alsamixer, hardware keys) wake these descriptors
+	const int count = snd_mixer_poll_descriptors_count(mixer);
+	QList<pollfd> descriptors(qMax(count, 0));
+	if (count > 0 && snd_mixer_poll_descriptors(mixer, descriptors.data(), count) > 0) {
+		for (const pollfd &descriptor : std::as_const(descriptors)) {
+			auto *notifier = new QSocketNotifier(descriptor.fd, QSocketNotifier::Read, this);
+			connect(notifier, &QSocketNotifier::activated, this, &AudioMixer::handleEvents);
+			m_notifiers.append(notifier);
+		}
+	}
+	qInfo() << "AudioMixer: Using" << m_control << "on" << card;
+	return true;
+#else
+	Q_UNUSED(card);
+	return false;
+#endif
+}
+
+void AudioMixer::close() {
+	qDeleteAll(m_notifiers);
+	m_notifiers.clear();
+#ifdef HAVE_ALSA
+	if (m_mixer) snd_mixer_close(m_mixer);
+#endif
+	m_mixer = nullptr;
+	m_element = nullptr;
+}
+
+void AudioMixer::registerHandlers(NativeHandlerRegistry &registry) {
+#if defined(ENABLE_NODEJS) && defined(HAVE_ALSA)
+	// Same results as AudioManager.getVolume() / setVolume(). Without a mixer (no sound card,
+	// or open() failed) both decline, so audio.js answers with amixer/pactl as before.
+	registry.registerHandler("audioGetVolume", [this](const QJsonObject &) -> std::optional<QJsonObject> {
+		if (!available()) return std::nullopt;
+		return QJsonObject{
+			{"status", "success"},
+			{"message", "Volume retrieved successfully"},
+			{"data", QJsonObject{{"volume", volume()}}},
+		};
+	});
+	registry.registerHandler("audioSetVolume", [this](const QJsonObject &params) -> std::optional<QJsonObject> {
+		if (!available()) return std::nullopt;
+		// parseInt() accepts numbers and numeric strings
+		const QJsonValue value = params.value("volume");
+		int volume = -1;
+		if (value.isDouble()) {
+			const double number = value.toDouble();
+			if (number >= 0 && number < 101) volume = int(number);
+		} else if (value.isString()) {
+			bool ok = false;
+			const int parsed = value.toString().trimmed().toInt(&ok);
+			if (ok) volume = parsed;
+		}
+		if (volume < 0 || volume > 100) {
+			return QJsonObject{
+				{"status", "error"},
+				{"message", "Failed to set system volume: Invalid volume level. Must be between 0 and 100."},
+			};
+		}
+		setVolume(volume);
+		return QJsonObject{
+			{"status", "success"},
+			{"message", QString("Volume set to %1% using: ALSA %2").arg(volume).arg(m_control)},
+			{"data", QJsonObject{{"volume", volume}, {"actualVolume", volume}}},
+		};
+	});
+#else
+	Q_UNUSED(registry);
+#endif
+}
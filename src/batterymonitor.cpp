@@ -0,0 +1,91 @@
+#include "include/batterymonitor.h"
+
+#include <QDebug>
+#include <QSocketNotifier>
+
+#ifdef Q_OS_LINUX
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Long enough to fold the several uevents of one plug event together
+static const int kUeventSettleMs = 100;
+
+BatteryMonitor::BatteryMonitor(QObject *parent) : BatteryMonitor(QString::fromLatin1(kPowerSupplyRoot), parent) {}
+
+BatteryMonitor::BatteryMonitor(const QString &root, QObject *parent) : QObject(parent), m_root(root), m_ueventSocket(-1), m_ueventNotifier(nullptr) {
+	m_pollTimer.setInterval(kDefaultPollIntervalMs);
+	connect(&m_pollTimer, &QTimer::timeout, this, &BatteryMonitor::refresh);
+	m_ueventTimer.setSingleShot(true);
+	m_ueventTimer.setInterval(kUeventSettleMs);
+	connect(&m_ueventTimer, &QTimer::timeout, this, &BatteryMonitor::refresh);
+
+	// Only the real class directory gets uevents
+	if (m_root == QLatin1String(kPowerSupplyRoot)) openUeventSocket();
+	refresh();
+	m_pollTimer.start();
+}
+
+BatteryMonitor::~BatteryMonitor() {
+#ifdef Q_OS_LINUX
+	if (m_ueventSocket >= 0) ::close(m_ueventSocket);
+#endif
+}
+
+int BatteryMonitor::pollInterval() const {
+	return m_pollTimer.interval();
+}
+
+void BatteryMonitor::setPollInterval(int ms) {
+	if (ms <= 0 || ms == m_pollTimer.interval()) return;
+	m_pollTimer.start(ms);
+	emit pollIntervalChanged();
+}
+
+void BatteryMonitor::refresh() {
+	const PowerSupplyState state = readPowerSupply(m_root);
+	if (state == m_state) return;
+	const PowerSupplyState previous = m_state;
+	m_state = state;
+	if (state.hasBattery != previous.hasBattery) emit hasBatteryChanged();
+	if (state.level != previous.level) emit levelChanged();
+	if (state.charging != previous.charging) emit chargingChanged();
+	if (state.acConnected != previous.acConnected) emit acConnectedChanged();
+}
+
+void BatteryMonitor::openUeventSocket() {
+#ifdef Q_OS_LINUX
+	const int fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+	if (fd < 0) {
+		qWarning() << "BatteryMonitor: No uevent socket, polling every" << m_pollTimer.interval() << "ms";
+		return;
+	}
+	sockaddr_nl address = {};
+	address.nl_family = AF_NETLINK;
+	address.nl_groups = 1; // kernel uevents
+	if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+		qWarning() << "BatteryMonitor: Cannot bind uevent socket, polling every" << m_pollTimer.interval() << "ms";
+		::close(fd);
+		return;
+	}
+	m_ueventSocket = fd;
+	m_ueventNotifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+	connect(m_ueventNotifier, &QSocketNotifier::activated, this, &BatteryMonitor::readUevents);
+#endif
+}
+
+void BatteryMonitor::readUevents() {
+#ifdef Q_OS_LINUX
+	// "change@/devices/...\0ACTION=change\0SUBSYSTEM=power_supply\0POWER_SUPPLY_...=...\0"
+	static const QByteArray subsystem("SUBSYSTEM=power_supply");
+	char buffer[8192];
+	bool relevant = false;
+	for (;;) {
+		const ssize_t size = ::recv(m_ueventSocket, buffer, sizeof(buffer), 0);
+		if (size <= 0) break;
+		if (QByteArray::fromRawData(buffer, size).contains(subsystem)) relevant = true;
+	}
+	if (relevant && !m_ueventTimer.isActive()) m_ueventTimer.start();
+#endif
+}
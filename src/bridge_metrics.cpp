@@ -0,0 +1,189 @@
+#include "include/bridge_metrics.h"
+
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QVariantList>
+#include <QWriteLocker>
+#include <algorithm>
+#include <chrono>
+
+LatencyHistogram::LatencyHistogram() : m_count(0), m_sum(0), m_max(0) {
+	for (std::atomic<quint64> &bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketIndex(quint64 micros) {
+	if (micros < quint64(kSubBuckets)) return int(micros);
+	int exponent = 63 - __builtin_clzll(micros);
+	if (exponent > kMaxExponent) return kBucketCount - 1;
+	const int subBucket = int((micros >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+	return (exponent - kSubBucketBits + 1) * kSubBuckets + subBucket;
+}
+
+quint64 LatencyHistogram::bucketUpperBound(int index) {
+	if (index < kSubBuckets) return quint64(index);
+	const int exponent = index / kSubBuckets + kSubBucketBits - 1;
+	const quint64 subBucket = quint64(index % kSubBuckets);
+	return ((kSubBuckets + subBucket + 1) << (exponent - kSubBucketBits)) - 1;
+}
+
+void LatencyHistogram::record(qint64 micros) {
+	const quint64 value = micros > 0 ? quint64(micros) : 0;
+	m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+	m_sum.fetch_add(value, std::memory_order_relaxed);
+	quint64 max = m_max.load(std::memory_order_relaxed);
+	while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+QVariantMap LatencyHistogram::snapshot() const {
+	// Buckets are read one by one while other threads may still record; the result is
+	// approximate by at most the few samples that land during the read
+	quint64 counts[kBucketCount];
+	quint64 total = 0;
+	for (int i = 0; i < kBucketCount; i++) {
+		counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+
+	const quint64 max = m_max.load(std::memory_order_relaxed);
+	auto percentile = [&](double p) -> quint64 {
+		if (total == 0) return 0;
+		const quint64 rank = quint64(p * double(total - 1));
+		quint64 seen = 0;
+		for (int i = 0; i < kBucketCount; i++) {
+			seen += counts[i];
+			if (seen > rank) return qMin(bucketUpperBound(i), max);
+		}
+		return max;
+	};
+
+	const quint64 count = m_count.load(std::memory_order_relaxed);
+	return QVariantMap{
+		{"count", count},
+		{"meanUs", count ? double(m_sum.load(std::memory_order_relaxed)) / double(count) : 0.0},
+		{"p50Us", percentile(0.50)},
+		{"p90Us", percentile(0.90)},
+		{"p99Us", percentile(0.99)},
+		{"p999Us", percentile(0.999)},
+		{"maxUs", max},
+	};
+}
+
+BridgeMetrics &BridgeMetrics::instance() {
+	static BridgeMetrics metrics;
+	return metrics;
+}
+
+qint64 BridgeMetrics::nowUs() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+BridgeMetrics::BridgeMetrics() : m_startedUs(nowUs()) {}
+
+BridgeMetrics::~BridgeMetrics() {
+	qDeleteAll(m_actions);
+}
+
+ActionMetrics *BridgeMetrics::action(const QString &name) {
+	{
+		QReadLocker locker(&m_actionsLock);
+		if (ActionMetrics *metrics = m_actions.value(name)) return metrics;
+	}
+	QWriteLocker locker(&m_actionsLock);
+	ActionMetrics *&metrics = m_actions[name];
+	if (!metrics) metrics = new ActionMetrics();
+	return metrics;
+}
+
+void BridgeMetrics::setQueueDepth(int interactive, int background) {
+	m_interactiveDepth.store(interactive, std::memory_order_relaxed);
+	m_backgroundDepth.store(background, std::memory_order_relaxed);
+	const int depth = interactive + background;
+	int peak = m_peakDepth.load(std::memory_order_relaxed);
+	while (depth > peak && !m_peakDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {}
+}
+
+void BridgeMetrics::setHeapStatistics(const HeapStatistics &heap) {
+	m_heapUsed.store(heap.used, std::memory_order_relaxed);
+	m_heapTotal.store(heap.total, std::memory_order_relaxed);
+	m_heapLimit.store(heap.limit, std::memory_order_relaxed);
+	m_heapExternal.store(heap.external, std::memory_order_relaxed);
+	m_heapSampledUs.store(nowUs(), std::memory_order_relaxed);
+}
+
+void BridgeMetrics::recordStall(const Stall &stall) {
+	m_stalls.record(stall.durationUs);
+	if (!stall.action.isEmpty()) action(stall.action)->stalls.record(stall.durationUs);
+
+	QMutexLocker locker(&m_stallsMutex);
+	if (m_recentStalls.size() >= kRecentStalls) m_recentStalls.removeFirst();
+	m_recentStalls.append(QVariantMap{
+		{"atMs", (nowUs() - m_startedUs) / 1000},
+		{"action", stall.action},
+		{"inHandler", stall.inHandler},
+		{"durationMs", stall.durationUs / 1000.0},
+		{"stack", stall.stack},
+	});
+}
+
+QVariantMap BridgeMetrics::snapshot() const {
+	const qint64 now = nowUs();
+
+	QVariantMap actions;
+	QVariantList ranking;
+	{
+		QReadLocker locker(&m_actionsLock);
+		for (auto it = m_actions.constBegin(); it != m_actions.constEnd(); ++it) {
+			const ActionMetrics *metrics = it.value();
+			const QVariantMap stalls = metrics->stalls.snapshot();
+			if (stalls.value("count").toULongLong() > 0) {
+				ranking.append(QVariantMap{
+					{"action", it.key()},
+					{"count", stalls.value("count")},
+					{"totalMs", stalls.value("meanUs").toDouble() * stalls.value("count").toDouble() / 1000.0},
+					{"maxMs", stalls.value("maxUs").toDouble() / 1000.0},
+				});
+			}
+			actions.insert(it.key(), QVariantMap{
+				{"count", quint64(metrics->count.load(std::memory_order_relaxed))},
+				{"errors", quint64(metrics->errors.load(std::memory_order_relaxed))},
+				{"timeouts", quint64(metrics->timeouts.load(std::memory_order_relaxed))},
+				{"queue", metrics->queue.snapshot()},
+				{"js", metrics->js.snapshot()},
+				{"delivery", metrics->delivery.snapshot()},
+				{"native", metrics->native.snapshot()},
+				{"stalls", stalls},
+			});
+		}
+	}
+	// Worst offenders first, by total time the loop was blocked
+	std::sort(ranking.begin(), ranking.end(), [](const QVariant &a, const QVariant &b) { return a.toMap().value("totalMs").toDouble() > b.toMap().value("totalMs").toDouble(); });
+
+	QVariantMap stalls = m_stalls.snapshot();
+	stalls.insert("ranking", ranking);
+	{
+		QMutexLocker locker(&m_stallsMutex);
+		QVariantList recent;
+		for (const QVariantMap &stall : m_recentStalls) recent.append(stall);
+		stalls.insert("recent", recent);
+	}
+
+	const qint64 heapSampledUs = m_heapSampledUs.load(std::memory_order_relaxed);
+	return QVariantMap{
+		{"uptimeMs", (now - m_startedUs) / 1000},
+		{"queue", QVariantMap{
+			{"interactive", m_interactiveDepth.load(std::memory_order_relaxed)},
+			{"background", m_backgroundDepth.load(std::memory_order_relaxed)},
+			{"peak", m_peakDepth.load(std::memory_order_relaxed)},
+		}},
+		{"heap", QVariantMap{
+			{"used", quint64(m_heapUsed.load(std::memory_order_relaxed))},
+			{"total", quint64(m_heapTotal.load(std::memory_order_relaxed))},
+			{"limit", quint64(m_heapLimit.load(std::memory_order_relaxed))},
+			{"external", quint64(m_heapExternal.load(std::memory_order_relaxed))},
+			{"sampledAgoMs", heapSampledUs ? (now - heapSampledUs) / 1000 : -1},
+		}},
+		{"actions", actions},
+		{"stalls", stalls},
+	};
+}
@@ -0,0 +1,155 @@
+#include "include/bridge_recorder.h"
+
+#include "include/bridge_metrics.h"
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborStreamReader>
+#include <QCborValue>
+#include <QDebug>
+#include <QJsonArray>
+#include <QMutexLocker>
+
+static const char kMagic[] = "BRTRACE1";
+static constexpr qsizetype kMagicSize = sizeof(kMagic) - 1;
+
+std::unique_ptr<BridgeRecorder> BridgeRecorder::fromEnvironment() {
+	const QString path = qEnvironmentVariable("BRIDGE_TRACE_FILE");
+	if (path.isEmpty()) return nullptr;
+	std::unique_ptr<BridgeRecorder> recorder(new BridgeRecorder(path));
+	if (!recorder->isOpen()) return nullptr;
+	qInfo() << "BridgeRecorder: Recording bridge traffic to" << path;
+	return recorder;
+}
+
+BridgeRecorder::BridgeRecorder(const QString &path) : m_startedUs(BridgeMetrics::nowUs()), m_file(path) {
+	if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qWarning() << "BridgeRecorder: Cannot open" << path << ":" << m_file.errorString();
+		return;
+	}
+	m_buffer.reserve(kFlushBytes + 4096);
+	m_buffer.append(kMagic, kMagicSize);
+}
+
+BridgeRecorder::~BridgeRecorder() {
+	flush();
+}
+
+bool BridgeRecorder::isOpen() const {
+	return m_file.isOpen();
+}
+
+void BridgeRecorder::recordSend(quint64 id, const QString &action, const QJsonObject &params, bool background, int timeoutMs) {
+	const qint64 t = BridgeMetrics::nowUs() - m_startedUs;
+	append(QCborValue(QCborArray{int(Type::Send), t, qint64(id), action, QCborMap::fromJsonObject(redact(params)), background, timeoutMs}).toCbor());
+}
+
+void BridgeRecorder::recordComplete(quint64 id, qint64 jsUs, qint64 resultBytes, bool ok) {
+	const qint64 t = BridgeMetrics::nowUs() - m_startedUs;
+	append(QCborValue(QCborArray{int(Type::Complete), t, qint64(id), jsUs, resultBytes, ok}).toCbor());
+}
+
+void BridgeRecorder::recordCancel(quint64 id) {
+	const qint64 t = BridgeMetrics::nowUs() - m_startedUs;
+	append(QCborValue(QCborArray{int(Type::Cancel), t, qint64(id)}).toCbor());
+}
+
+void BridgeRecorder::recordTimeout(quint64 id) {
+	const qint64 t = BridgeMetrics::nowUs() - m_startedUs;
+	append(QCborValue(QCborArray{int(Type::Timeout), t, qint64(id)}).toCbor());
+}
+
+void BridgeRecorder::append(const QByteArray &record) {
+	// Disk writes happen at most once per kFlushBytes, under the lock, on whichever thread
+	// fills the buffer; fine for a diagnostic mode
+	QMutexLocker locker(&m_mutex);
+	if (!m_file.isOpen()) return;
+	m_buffer.append(record);
+	if (m_buffer.size() < kFlushBytes) return;
+	m_file.write(m_buffer);
+	m_buffer.clear();
+}
+
+void BridgeRecorder::flush() {
+	QMutexLocker locker(&m_mutex);
+	if (!m_file.isOpen()) return;
+	m_file.write(m_buffer);
+	m_buffer.clear();
+	m_file.flush();
+}
+
+bool BridgeRecorder::read(const QString &path, QList<Record> *records, QString *error) {
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly)) {
+		*error = file.errorString();
+		return false;
+	}
+	const QByteArray data = file.readAll();
+	if (!data.startsWith(QByteArray(kMagic, kMagicSize))) {
+		*error = QStringLiteral("not a bridge trace");
+		return false;
+	}
+
+	QCborStreamReader reader(data.mid(kMagicSize));
+	while (reader.isValid()) {
+		const QCborArray fields = QCborValue::fromCbor(reader).toArray();
+		// A recorder killed mid-flush leaves a truncated last record, keep what came before
+		if (fields.size() < 3) break;
+
+		Record record;
+		record.type = Type(fields.at(0).toInteger());
+		record.timeUs = fields.at(1).toInteger();
+		record.id = quint64(fields.at(2).toInteger());
+		if (record.type == Type::Send) {
+			if (fields.size() < 7) break;
+			record.action = fields.at(3).toString();
+			record.params = fields.at(4).toMap().toJsonObject();
+			record.background = fields.at(5).toBool();
+			record.timeoutMs = int(fields.at(6).toInteger());
+		} else if (record.type == Type::Complete) {
+			if (fields.size() < 6) break;
+			record.jsUs = fields.at(3).toInteger();
+			record.resultBytes = fields.at(4).toInteger();
+			record.ok = fields.at(5).toBool();
+		}
+		records->append(record);
+	}
+
+	if (reader.lastError() != QCborError::NoError && reader.lastError() != QCborError::EndOfFile) {
+		*error = reader.lastError().toString();
+		return false;
+	}
+	return true;
+}
+
+static bool isSecretKey(const QString &key) {
+	// Anywhere in the name
+	static const char *const kSecretKeys[] = {"mnemonic", "privatekey", "password", "passphrase", "seed", "secret", "apikey", "token"};
+	// Whole name only: cryptoHmac's key, and RPC URLs, which often carry a provider API key
+	static const char *const kSecretNames[] = {"key", "rpcurl"};
+	const QString lower = key.toLower();
+	for (const char *secret : kSecretKeys) {
+		if (lower.contains(QLatin1String(secret))) return true;
+	}
+	for (const char *secret : kSecretNames) {
+		if (lower == QLatin1String(secret)) return true;
+	}
+	return false;
+}
+
+static QJsonValue redactValue(const QJsonValue &value, bool secret) {
+	if (value.isObject()) return BridgeRecorder::redact(value.toObject());
+	if (value.isArray()) {
+		QJsonArray array;
+		for (const QJsonValue &item : value.toArray()) array.append(redactValue(item, secret));
+		return array;
+	}
+	if (secret && value.isString()) return QString(value.toString().size(), QLatin1Char('x'));
+	return value;
+}
+
+QJsonObject BridgeRecorder::redact(const QJsonObject &params) {
+	QJsonObject redacted;
+	for (auto it = params.constBegin(); it != params.constEnd(); ++it) redacted.insert(it.key(), redactValue(it.value(), isSecretKey(it.key())));
+	return redacted;
+}
@@ -0,0 +1,146 @@
+#include "include/callback_registry.h"
+
+#include <QMutexLocker>
+#include <chrono>
+
+CallbackRegistry::CallbackRegistry(quint32 capacity) : m_capacity(qMin<quint32>(capacity, quint32(1) << kIndexBits)), m_slots(new Slot[m_capacity]), m_heap(new quint32[m_capacity]), m_heapSize(0), m_freeHead(m_capacity ? 0 : kNoSlot), m_size(0) {
+	for (quint32 i = 0; i < m_capacity; i++) m_slots[i].nextFree = (i + 1 < m_capacity) ? i + 1 : kNoSlot;
+}
+
+qint64 CallbackRegistry::now() {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+quint64 CallbackRegistry::add(Callback &&callback, qint64 deadline, const Trace &trace) {
+	QMutexLocker locker(&m_mutex);
+	if (m_freeHead == kNoSlot) return 0;
+
+	const quint32 index = m_freeHead;
+	Slot &slot = m_slots[index];
+	m_freeHead = slot.nextFree;
+	slot.nextFree = kNoSlot;
+	slot.used = true;
+	slot.callback = std::move(callback);
+	slot.trace = trace;
+	slot.deadline = deadline;
+	if (deadline > 0) heapPush(index);
+	m_size++;
+
+	return (quint64(slot.generation) << kIndexBits) | index;
+}
+
+CallbackRegistry::Callback CallbackRegistry::take(quint64 id, Trace *trace) {
+	QMutexLocker locker(&m_mutex);
+	if (!lookup(id)) return Callback();
+	return release(indexOf(id), trace);
+}
+
+CallbackRegistry::Callback CallbackRegistry::takeExpired(qint64 now, quint64 *id, Trace *trace) {
+	QMutexLocker locker(&m_mutex);
+	if (m_heapSize == 0) return Callback();
+
+	const quint32 index = m_heap[0];
+	Slot &slot = m_slots[index];
+	if (slot.deadline > now) return Callback();
+
+	if (id) *id = (quint64(slot.generation) << kIndexBits) | index;
+	return release(index, trace);
+}
+
+bool CallbackRegistry::markStarted(quint64 id, qint64 startedUs, Trace *trace) {
+	QMutexLocker locker(&m_mutex);
+	Slot *slot = lookup(id);
+	if (!slot) return false;
+	slot->trace.startedUs = startedUs;
+	if (trace) *trace = slot->trace;
+	return true;
+}
+
+qint64 CallbackRegistry::nextDeadline() const {
+	QMutexLocker locker(&m_mutex);
+	return m_heapSize ? m_slots[m_heap[0]].deadline : -1;
+}
+
+bool CallbackRegistry::contains(quint64 id) const {
+	QMutexLocker locker(&m_mutex);
+	return lookup(id) != nullptr;
+}
+
+quint32 CallbackRegistry::size() const {
+	QMutexLocker locker(&m_mutex);
+	return m_size;
+}
+
+CallbackRegistry::Slot *CallbackRegistry::lookup(quint64 id) const {
+	const quint32 index = indexOf(id);
+	if (index >= m_capacity) return nullptr;
+	Slot *slot = &m_slots[index];
+	if (!slot->used || slot->generation != generationOf(id)) return nullptr;
+	return slot;
+}
+
+CallbackRegistry::Callback CallbackRegistry::release(quint32 index, Trace *trace) {
+	Slot &slot = m_slots[index];
+	if (slot.heapIndex != kNoSlot) heapRemove(slot.heapIndex);
+	if (trace) *trace = slot.trace;
+
+	Callback callback = std::move(slot.callback);
+	slot.callback = nullptr;
+	slot.used = false;
+	slot.deadline = 0;
+	slot.trace = Trace();
+	// Generation 0 is skipped so that no live ID can ever be 0
+	slot.generation = (slot.generation + 1) & ((quint32(1) << kGenerationBits) - 1);
+	if (slot.generation == 0) slot.generation = 1;
+	slot.nextFree = m_freeHead;
+	m_freeHead = index;
+	m_size--;
+
+	return callback;
+}
+
+void CallbackRegistry::heapPush(quint32 index) {
+	m_heap[m_heapSize] = index;
+	m_slots[index].heapIndex = m_heapSize;
+	heapSiftUp(m_heapSize++);
+}
+
+void CallbackRegistry::heapRemove(quint32 position) {
+	const quint32 last = --m_heapSize;
+	m_slots[m_heap[position]].heapIndex = kNoSlot;
+	if (position == last) return;
+
+	const quint32 moved = m_heap[last];
+	m_heap[position] = moved;
+	m_slots[moved].heapIndex = position;
+	// The moved entry may belong either above or below its new position
+	heapSiftUp(position);
+	heapSiftDown(m_slots[moved].heapIndex);
+}
+
+void CallbackRegistry::heapSiftUp(quint32 position) {
+	while (position > 0) {
+		const quint32 parent = (position - 1) / 2;
+		if (m_slots[m_heap[parent]].deadline <= m_slots[m_heap[position]].deadline) break;
+		heapSwap(parent, position);
+		position = parent;
+	}
+}
+
+void CallbackRegistry::heapSiftDown(quint32 position) {
+	for (;;) {
+		const quint32 left = 2 * position + 1;
+		if (left >= m_heapSize) break;
+		quint32 smallest = left;
+		if (left + 1 < m_heapSize && m_slots[m_heap[left + 1]].deadline < m_slots[m_heap[left]].deadline) smallest = left + 1;
+		if (m_slots[m_heap[position]].deadline <= m_slots[m_heap[smallest]].deadline) break;
+		heapSwap(position, smallest);
+		position = smallest;
+	}
+}
+
+void CallbackRegistry::heapSwap(quint32 a, quint32 b) {
+	std::swap(m_heap[a], m_heap[b]);
+	m_slots[m_heap[a]].heapIndex = a;
+	m_slots[m_heap[b]].heapIndex = b;
+}
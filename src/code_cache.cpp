@@ -0,0 +1,66 @@
+#include "include/code_cache.h"
+
+#ifdef ENABLE_NODEJS
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
+
+static const quint32 kCodeCacheMagic = 0x4d424343; // "MBCC"
+static const quint32 kCodeCacheFormat = 1;
+
+CodeCache::CodeCache(const QString &name) {
+	QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+	if (dir.isEmpty() || !QDir().mkpath(dir)) dir = QCoreApplication::applicationDirPath();
+	m_path = QDir(dir).filePath(name + ".codecache");
+}
+
+bool CodeCache::enabled() {
+	return qEnvironmentVariable("NODE_CODE_CACHE") != QLatin1String("0");
+}
+
+QByteArray CodeCache::sourceKey(const char *data, qsizetype length) {
+	QCryptographicHash hash(QCryptographicHash::Sha256);
+	const quint32 tag = v8::ScriptCompiler::CachedDataVersionTag();
+	hash.addData(QByteArrayView(reinterpret_cast<const char *>(&tag), sizeof(tag)));
+	hash.addData(QByteArrayView(data, length));
+	return hash.result();
+}
+
+v8::ScriptCompiler::CachedData *CodeCache::load(const QByteArray &key) const {
+	QFile file(m_path);
+	if (!file.open(QIODevice::ReadOnly)) return nullptr;
+
+	QDataStream in(&file);
+	quint32 magic = 0, format = 0;
+	QByteArray storedKey, payload;
+	in >> magic >> format >> storedKey >> payload;
+	if (in.status() != QDataStream::Ok || magic != kCodeCacheMagic || format != kCodeCacheFormat || storedKey != key || payload.isEmpty()) return nullptr;
+
+	// V8 releases BufferOwned data with delete[]
+	uint8_t *buffer = new uint8_t[payload.size()];
+	std::memcpy(buffer, payload.constData(), payload.size());
+	return new v8::ScriptCompiler::CachedData(buffer, int(payload.size()), v8::ScriptCompiler::CachedData::BufferOwned);
+}
+
+bool CodeCache::save(const QByteArray &key, const v8::ScriptCompiler::CachedData *data) const {
+	if (!data || data->length <= 0) return false;
+
+	QSaveFile file(m_path);
+	if (!file.open(QIODevice::WriteOnly)) {
+		qWarning() << "CodeCache: Cannot write" << m_path << file.errorString();
+		return false;
+	}
+
+	QDataStream out(&file);
+	out << kCodeCacheMagic << kCodeCacheFormat << key << QByteArray::fromRawData(reinterpret_cast<const char *>(data->data), data->length);
+	return out.status() == QDataStream::Ok && file.commit();
+}
+
+#endif // ENABLE_NODEJS
@@ -0,0 +1,273 @@
+#include "include/command_broker.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+// Enough for a scan and a couple of quick queries at once; most commands just wait
+static const int kCommandThreads = 3;
+// Expired cache entries are swept once the cache grows past this
+static const int kCacheSweepSize = 64;
+// Longest pause between checks on a command that closed its pipes but has not exited
+static const int kReapPauseMaxMs = 50;
+
+static qint64 nowMs() {
+	return QDateTime::currentMSecsSinceEpoch();
+}
+
+CommandBroker::CommandBroker() : m_nextTicket(1), m_stopping(false) {
+	m_pool.setMaxThreadCount(kCommandThreads);
+	m_pool.setObjectName("CommandBroker");
+}
+
+CommandBroker::~CommandBroker() {
+	shutdown();
+}
+
+QString CommandBroker::cacheKey(const Request &request) {
+	return (QStringList{request.program} + request.arguments).join(QChar(0));
+}
+
+void CommandBroker::run(const Request &request, OutputCallback output, FinishedCallback finished) {
+	const bool cacheable = request.cacheTtlMs > 0 && !output;
+	const QString key = cacheable ? cacheKey(request) : QString();
+	quint64 ticket = 0;
+	{
+		QMutexLocker locker(&m_mutex);
+		if (m_stopping) {
+			locker.unlock();
+			Result result;
+			result.error = QStringLiteral("Command broker is shut down");
+			finished(result);
+			return;
+		}
+
+		if (request.invalidate) {
+			const QString prefix = request.program + QChar(0);
+			auto stale = [&](const QString &other) { return other.startsWith(prefix) || other == request.program; };
+			for (auto it = m_cache.begin(); it != m_cache.end();) {
+				if (stale(it.key())) it = m_cache.erase(it);
+				else ++it;
+			}
+			// A query already running may have read the state before this command changes it
+			for (auto it = m_inflight.begin(); it != m_inflight.end();) {
+				if (stale(it.key())) {
+					m_retired.insert(it->ticket, std::move(it->waiters));
+					it = m_inflight.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+		if (cacheable) {
+			const auto cached = m_cache.constFind(key);
+			if (cached != m_cache.constEnd() && cached->expiresAtMs > nowMs()) {
+				Result result = cached->result;
+				result.cached = true;
+				locker.unlock();
+				finished(result);
+				return;
+			}
+			// The same query is already running: wait for it instead of forking again
+			const auto running = m_inflight.find(key);
+			if (running != m_inflight.end()) {
+				running->waiters.append(std::move(finished));
+				return;
+			}
+			ticket = m_nextTicket++;
+			m_inflight.insert(key, InFlight{{}, ticket});
+		}
+	}
+
+	m_pool.start([this, request, key, ticket, output = std::move(output), finished = std::move(finished)]() {
+		const Result result = execute(request, output);
+		if (!key.isEmpty()) finish(key, ticket, request.cacheTtlMs, result);
+		finished(result);
+	});
+}
+
+void CommandBroker::finish(const QString &key, quint64 ticket, int cacheTtlMs, const Result &result) {
+	QList<FinishedCallback> waiting;
+	{
+		QMutexLocker locker(&m_mutex);
+		const auto running = m_inflight.find(key);
+		const bool current = running != m_inflight.end() && running->ticket == ticket;
+		if (current) {
+			waiting = std::move(running->waiters);
+			m_inflight.erase(running);
+		} else {
+			// Invalidated while running: the result may predate the change, so don't keep it
+			waiting = m_retired.take(ticket);
+		}
+		// A failure to start or a timeout says nothing about the next attempt
+		if (current && result.error.isEmpty() && !result.timedOut) {
+			const qint64 now = nowMs();
+			if (m_cache.size() >= kCacheSweepSize) {
+				for (auto it = m_cache.begin(); it != m_cache.end();) {
+					if (it->expiresAtMs <= now) it = m_cache.erase(it);
+					else ++it;
+				}
+			}
+			m_cache.insert(key, CacheEntry{result, now + cacheTtlMs});
+		}
+	}
+	Result shared = result;
+	shared.cached = true;
+	for (const FinishedCallback &callback : std::as_const(waiting)) callback(shared);
+}
+
+void CommandBroker::shutdown() {
+	{
+		QMutexLocker locker(&m_mutex);
+		m_stopping = true;
+		for (pid_t pid : std::as_const(m_running)) ::kill(-pid, SIGKILL);
+	}
+	m_pool.waitForDone();
+}
+
+CommandBroker::Result CommandBroker::execute(const Request &request, const OutputCallback &output) {
+	Result result;
+	QElapsedTimer timer;
+	timer.start();
+
+	int outPipe[2];
+	int errPipe[2];
+	if (::pipe2(outPipe, O_CLOEXEC) != 0) {
+		result.error = QString("pipe: %1").arg(strerror(errno));
+		return result;
+	}
+	if (::pipe2(errPipe, O_CLOEXEC) != 0) {
+		result.error = QString("pipe: %1").arg(strerror(errno));
+		::close(outPipe[0]);
+		::close(outPipe[1]);
+		return result;
+	}
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+	// dup2 clears close-on-exec on the copies only
+	posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+	posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+
+	posix_spawnattr_t attributes;
+	posix_spawnattr_init(&attributes);
+	// Own process group, so a timeout also takes down whatever the command started
+	posix_spawnattr_setpgroup(&attributes, 0);
+	// Node ignores SIGPIPE and ignored signals survive exec; the command gets the defaults
+	sigset_t defaults;
+	sigemptyset(&defaults);
+	for (int signal : {SIGPIPE, SIGINT, SIGQUIT, SIGTERM, SIGHUP}) sigaddset(&defaults, signal);
+	posix_spawnattr_setsigdefault(&attributes, &defaults);
+	sigset_t mask;
+	sigemptyset(&mask);
+	posix_spawnattr_setsigmask(&attributes, &mask);
+	posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+	QByteArrayList arguments{request.program.toLocal8Bit()};
+	for (const QString &argument : request.arguments) arguments.append(argument.toLocal8Bit());
+	std::vector<char *> argv;
+	argv.reserve(arguments.size() + 1);
+	for (QByteArray &argument : arguments) argv.push_back(argument.data());
+	argv.push_back(nullptr);
+
+	pid_t pid = 0;
+	const int spawnError = ::posix_spawnp(&pid, argv[0], &actions, &attributes, argv.data(), environ);
+	posix_spawn_file_actions_destroy(&actions);
+	posix_spawnattr_destroy(&attributes);
+	::close(outPipe[1]);
+	::close(errPipe[1]);
+	if (spawnError != 0) {
+		::close(outPipe[0]);
+		::close(errPipe[0]);
+		result.error = QString("%1: %2").arg(request.program, strerror(spawnError));
+		return result;
+	}
+	{
+		QMutexLocker locker(&m_mutex);
+		m_running.insert(pid);
+		if (m_stopping) ::kill(-pid, SIGKILL);
+	}
+
+	pollfd fds[2] = {{outPipe[0], POLLIN, 0}, {errPipe[0], POLLIN, 0}};
+	QByteArray *targets[2] = {&result.standardOutput, &result.standardError};
+	int open = 2;
+	char buffer[16384];
+	while (open > 0) {
+		int waitMs = -1;
+		if (request.timeoutMs > 0) {
+			waitMs = int(request.timeoutMs - timer.elapsed());
+			if (waitMs <= 0) {
+				result.timedOut = true;
+				::kill(-pid, SIGKILL);
+				break;
+			}
+		}
+		const int ready = ::poll(fds, 2, waitMs);
+		if (ready < 0 && errno != EINTR) {
+			// Can't watch it any more, so don't leave it running unattended
+			result.error = QString("poll: %1").arg(strerror(errno));
+			::kill(-pid, SIGKILL);
+			break;
+		}
+		if (ready <= 0) continue;
+
+		for (int i = 0; i < 2; i++) {
+			if (fds[i].fd < 0 || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+			const ssize_t size = ::read(fds[i].fd, buffer, sizeof(buffer));
+			if (size > 0) {
+				QByteArray &target = *targets[i];
+				target.append(buffer, qMin(qsizetype(size), qMax<qsizetype>(0, kMaxOutputBytes - target.size())));
+				if (i == 0 && output) output(QByteArray(buffer, size));
+			} else if (size == 0 || (errno != EINTR && errno != EAGAIN)) {
+				::close(fds[i].fd);
+				fds[i].fd = -1;
+				open--;
+			}
+		}
+	}
+	for (const pollfd &fd : fds) {
+		if (fd.fd >= 0) ::close(fd.fd);
+	}
+
+	// Both pipes can close long before the process exits (it redirected or closed them and
+	// kept running), so the timeout still applies while waiting for it
+	int status = 0;
+	int pauseMs = 1;
+	for (;;) {
+		const pid_t reaped = request.timeoutMs > 0 ? ::waitpid(pid, &status, WNOHANG) : ::waitpid(pid, &status, 0);
+		if (reaped == pid || (reaped < 0 && errno != EINTR)) break;
+		if (reaped < 0) continue;
+		if (timer.elapsed() >= request.timeoutMs) {
+			result.timedOut = true;
+			::kill(-pid, SIGKILL);
+			while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+			}
+			break;
+		}
+		::usleep(useconds_t(qMin<qint64>(pauseMs, request.timeoutMs - timer.elapsed())) * 1000);
+		pauseMs = qMin(pauseMs * 2, kReapPauseMaxMs);
+	}
+	{
+		QMutexLocker locker(&m_mutex);
+		m_running.remove(pid);
+	}
+	if (WIFEXITED(status)) {
+		result.exitCode = WEXITSTATUS(status);
+	} else if (WIFSIGNALED(status)) {
+		result.signal = WTERMSIG(status);
+	}
+	result.durationUs = timer.nsecsElapsed() / 1000;
+	return result;
+}
@@ -0,0 +1,76 @@
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <atomic>
+
+class QSocketNotifier;
+class NativeHandlerRegistry;
+typedef struct _snd_mixer snd_mixer_t;
+typedef struct _snd_mixer_elem snd_mixer_elem_t;
+
+// Playback volume of the sound card, without spawning amixer.
+//
+// The mixer and its volume element (Master, or the first usable fallback) are opened once.
+// Sets are thread-safe and coalesced: a burst of them, e.g. from dragging the volume slider,
+// ends up as a single write of the latest value on the mixer's thread. Changes made by
+// something else (hardware keys, alsamixer) arrive as mixer events and are pushed to QML
+// through volumeChanged.
+//
+// Without a sound card (or without ALSA) the volume lives in memory only and available is
+// false. The volume property still works headless, sets coalesced the same way, but the
+// native handlers decline and audio.js answers with amixer/pactl.
+class AudioMixer : public QObject {
+ Q_OBJECT
+ Q_PROPERTY(int volume READ volume WRITE setVolume NOTIFY volumeChanged)
+ Q_PROPERTY(bool available READ available CONSTANT)
+ Q_PROPERTY(QString control READ control CONSTANT)
+
+public:
+ // audio.js answers with this when amixer fails
+ static constexpr int kDefaultVolume = 50;
+
+ explicit AudioMixer(QObject *parent = nullptr);
+ // card is an ALSA mixer device such as "default" or "hw:0"; empty uses the in-memory fallback
+ AudioMixer(const QString &card, QObject *parent);
+ ~AudioMixer();
+
+ // 0-100, including a set that has not been written yet. Thread-safe.
+ int volume() const;
+ // Thread-safe; the write happens on the mixer's thread
+ void setVolume(int volume);
+ bool available() const { return m_element != nullptr; }
+ QString control() const { return m_control; }
+
+ // Answers audioGetVolume and audioSetVolume natively while a mixer is open; without one
+ // (or without ALSA support) audio.js keeps its amixer/pactl fallbacks
+ void registerHandlers(NativeHandlerRegistry &registry);
+
+signals:
+ void volumeChanged();
+
+private:
+ bool open(const QString &card);
+ void close();
+ void applyPending();
+ void handleEvents();
+ // Re-reads the element and emits volumeChanged if it moved
+ void syncFromMixer();
+
+ QString m_control;
+ std::atomic<int> m_volume;
+ std::atomic<int> m_pending; // -1 when there is nothing to write
+ std::atomic<bool> m_applyQueued;
+ // Gives a drag a moment to settle into one write
+ QTimer m_applyTimer;
+ snd_mixer_t *m_mixer;
+ snd_mixer_elem_t *m_element;
+ long m_min;
+ long m_max;
+ QList<QSocketNotifier *> m_notifiers;
+};
+
+#endif		// AUDIOMIXER_H
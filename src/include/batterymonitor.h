@@ -0,0 +1,65 @@
+#ifndef BATTERYMONITOR_H
+#define BATTERYMONITOR_H
+
+#include "power_supply.h"
+
+#include <QObject>
+#include <QTimer>
+
+class QSocketNotifier;
+
+// Battery and AC state from /sys/class/power_supply, pushed to QML as it changes.
+//
+// The kernel announces power_supply changes as uevents on a netlink socket; each one
+// triggers a re-read of the sysfs tree (a handful of tiny files). A slow poll covers
+// drivers that update capacity without sending a uevent, and is the only source when
+// netlink is unavailable or root points at a fake tree.
+class BatteryMonitor : public QObject {
+ Q_OBJECT
+ Q_PROPERTY(bool hasBattery READ hasBattery NOTIFY hasBatteryChanged)
+ Q_PROPERTY(int level READ level NOTIFY levelChanged)
+ Q_PROPERTY(bool charging READ charging NOTIFY chargingChanged)
+ Q_PROPERTY(bool acConnected READ acConnected NOTIFY acConnectedChanged)
+ Q_PROPERTY(int pollInterval READ pollInterval WRITE setPollInterval NOTIFY pollIntervalChanged)
+
+public:
+ static constexpr int kDefaultPollIntervalMs = 60000;
+
+ explicit BatteryMonitor(QObject *parent = nullptr);
+ // root is the power_supply class directory, e.g. a temp dir with fake devices
+ BatteryMonitor(const QString &root, QObject *parent);
+ ~BatteryMonitor();
+
+ bool hasBattery() const { return m_state.hasBattery; }
+ int level() const { return m_state.level; }
+ bool charging() const { return m_state.charging; }
+ bool acConnected() const { return m_state.acConnected; }
+ bool isListening() const { return m_ueventSocket >= 0; }
+
+ int pollInterval() const;
+ void setPollInterval(int ms);
+
+ // Re-reads the tree now and emits whatever changed
+ Q_INVOKABLE void refresh();
+
+signals:
+ void hasBatteryChanged();
+ void levelChanged();
+ void chargingChanged();
+ void acConnectedChanged();
+ void pollIntervalChanged();
+
+private:
+ void openUeventSocket();
+ void readUevents();
+
+ const QString m_root;
+ PowerSupplyState m_state;
+ QTimer m_pollTimer;
+ // Coalesces the burst of uevents a plug or unplug produces into one refresh
+ QTimer m_ueventTimer;
+ int m_ueventSocket;
+ QSocketNotifier *m_ueventNotifier;
+};
+
+#endif		// BATTERYMONITOR_H
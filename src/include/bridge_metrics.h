@@ -0,0 +1,114 @@
+#ifndef BRIDGE_METRICS_H
+#define BRIDGE_METRICS_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVariantMap>
+#include <atomic>
+
+// Latency histogram with log-linear buckets (HDR-style): values below 8 us get exact
+// buckets, above that every power of two is split into 8 sub-buckets, so any recorded
+// value is reported within 12.5%. Buckets are relaxed atomics, so record() is lock-free
+// and may be called from any thread. Covers 1 us .. ~2 min, larger values are clamped.
+class LatencyHistogram {
+public:
+ LatencyHistogram();
+
+ void record(qint64 micros);
+
+ // {count, meanUs, p50Us, p90Us, p99Us, p999Us, maxUs}
+ QVariantMap snapshot() const;
+
+private:
+ static constexpr int kSubBucketBits = 3;
+ static constexpr int kSubBuckets = 1 << kSubBucketBits;
+ static constexpr int kMaxExponent = 27;
+ static constexpr int kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+ static int bucketIndex(quint64 micros);
+ static quint64 bucketUpperBound(int index);
+
+ std::atomic<quint64> m_buckets[kBucketCount];
+ std::atomic<quint64> m_count;
+ std::atomic<quint64> m_sum;
+ std::atomic<quint64> m_max;
+};
+
+// Per-action counters. Instances live as long as the process, so the pointer can be
+// carried along with a request instead of looking the action up again.
+struct ActionMetrics {
+ LatencyHistogram queue;    // enqueue -> dequeue on the Node thread
+ LatencyHistogram js;       // dequeue -> __nativeCallback
+ LatencyHistogram delivery; // __nativeCallback -> QML callback invoked
+ LatencyHistogram native;   // C++ fast-path handler run time (queue is then the pool wait)
+ LatencyHistogram stalls;   // event loop stalls blamed on this action (see LoopWatchdog)
+ std::atomic<quint64> count{0};
+ std::atomic<quint64> errors{0};
+ std::atomic<quint64> timeouts{0};
+};
+
+// Process-wide bridge instrumentation: per-action histograms plus queue and V8 heap
+// gauges, and the event loop stalls reported by LoopWatchdog. Cheap enough to stay
+// enabled: recording is a hash lookup under a read lock when a request is sent, then
+// relaxed atomic increments.
+class BridgeMetrics {
+public:
+ static BridgeMetrics &instance();
+
+ // Monotonic microseconds, the time base for all histograms
+ static qint64 nowUs();
+
+ ActionMetrics *action(const QString &name);
+
+ void setQueueDepth(int interactive, int background);
+
+ struct HeapStatistics {
+  quint64 used = 0;
+  quint64 total = 0;
+  quint64 limit = 0;
+  quint64 external = 0;
+ };
+ // Sampled on the Node thread, the only thread allowed to touch the isolate
+ void setHeapStatistics(const HeapStatistics &heap);
+
+ // Node thread blocked (not back in the libuv poll) for longer than the watchdog threshold
+ struct Stall {
+  QString action; // last action dispatched to JS
+  bool inHandler = false; // inside handleMessage() itself rather than a later callback
+  qint64 durationUs = 0;
+  QString stack; // JS stack sampled while it was stuck, if the interrupt got to run
+ };
+ void recordStall(const Stall &stall);
+
+ // {uptimeMs, queue: {interactive, background, peak}, heap: {...}, actions: {name: {...}},
+ //  stalls: {histogram..., ranking: [...], recent: [...]}}
+ QVariantMap snapshot() const;
+
+private:
+ BridgeMetrics();
+ ~BridgeMetrics();
+
+ const qint64 m_startedUs;
+ mutable QReadWriteLock m_actionsLock;
+ QHash<QString, ActionMetrics *> m_actions;
+
+ std::atomic<int> m_interactiveDepth{0};
+ std::atomic<int> m_backgroundDepth{0};
+ std::atomic<int> m_peakDepth{0};
+
+ std::atomic<quint64> m_heapUsed{0};
+ std::atomic<quint64> m_heapTotal{0};
+ std::atomic<quint64> m_heapLimit{0};
+ std::atomic<quint64> m_heapExternal{0};
+ std::atomic<qint64> m_heapSampledUs{0};
+
+ static constexpr int kRecentStalls = 16;
+ LatencyHistogram m_stalls;
+ mutable QMutex m_stallsMutex;
+ QList<QVariantMap> m_recentStalls;
+};
+
+#endif		// BRIDGE_METRICS_H
@@ -0,0 +1,72 @@
+#ifndef BRIDGE_RECORDER_H
+#define BRIDGE_RECORDER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <memory>
+
+// Records bridge traffic to a compact binary trace for bench/bridge_replay.
+//
+// Enabled by setting BRIDGE_TRACE_FILE. The file is an 8-byte magic followed by a CBOR
+// sequence, one array per record:
+//   [0 send,     tUs, id, action, params, background, timeoutMs]
+//   [1 complete, tUs, id, jsUs, resultBytes, ok]
+//   [2 cancel,   tUs, id]
+//   [3 timeout,  tUs, id]
+// tUs counts from when the recorder was opened. Params are redacted (see redact()), so a
+// trace can be shared without leaking wallet secrets. All methods are thread-safe; records
+// are buffered and written out in batches.
+class BridgeRecorder {
+public:
+ enum class Type { Send = 0, Complete = 1, Cancel = 2, Timeout = 3 };
+
+ struct Record {
+  Type type = Type::Send;
+  qint64 timeUs = 0;
+  quint64 id = 0;
+  // Send
+  QString action;
+  QJsonObject params;
+  bool background = false;
+  int timeoutMs = 0;
+  // Complete
+  qint64 jsUs = 0;
+  qint64 resultBytes = 0;
+  bool ok = false;
+ };
+
+ // nullptr unless BRIDGE_TRACE_FILE is set and the file could be created
+ static std::unique_ptr<BridgeRecorder> fromEnvironment();
+
+ explicit BridgeRecorder(const QString &path);
+ ~BridgeRecorder();
+ bool isOpen() const;
+
+ void recordSend(quint64 id, const QString &action, const QJsonObject &params, bool background, int timeoutMs);
+ void recordComplete(quint64 id, qint64 jsUs, qint64 resultBytes, bool ok);
+ void recordCancel(quint64 id);
+ void recordTimeout(quint64 id);
+ void flush();
+
+ static bool read(const QString &path, QList<Record> *records, QString *error);
+
+ // Replaces string values of secret-looking keys (mnemonic, privateKey, password, key, rpcUrl, ...)
+ // with filler of the same length, recursively, keeping the payload size intact
+ static QJsonObject redact(const QJsonObject &params);
+
+private:
+ static constexpr qsizetype kFlushBytes = 64 * 1024;
+
+ void append(const QByteArray &record);
+
+ const qint64 m_startedUs;
+ QMutex m_mutex;
+ QFile m_file;
+ QByteArray m_buffer;
+};
+
+#endif		// BRIDGE_RECORDER_H
@@ -0,0 +1,102 @@
+#ifndef CALLBACK_REGISTRY_H
+#define CALLBACK_REGISTRY_H
+
+#include <QJsonObject>
+#include <QMutex>
+#include <functional>
+#include <memory>
+
+// Request bookkeeping stored next to a callback for instrumentation. It is read and
+// written under the registry lock, so it stays consistent when a slot is recycled.
+struct CallbackTrace {
+ void *tag = nullptr; // opaque to the registry
+ qint64 enqueuedUs = 0;
+ qint64 startedUs = 0;
+};
+
+// Fixed-size slot table for pending bridge callbacks.
+//
+// Message IDs are generation-tagged slot indexes: the low kIndexBits select the slot,
+// the bits above hold the slot's generation. A slot's generation is bumped on every
+// release, so a late or duplicate reply for a recycled slot is rejected instead of
+// firing someone else's callback. IDs stay below 2^53 so they survive the trip through
+// a JS number unchanged; 0 is never a valid ID.
+//
+// All slots are allocated up front and free slots form an intrusive free-list, so
+// add() and take() never allocate and never hash a string.
+//
+// Entries may carry a deadline. Those sit in an indexed min-heap over the slots (also
+// preallocated), so take() removes an entry from the heap in O(log n) and takeExpired()
+// reclaims requests whose handler never replied.
+class CallbackRegistry {
+public:
+ using Callback = std::function<void(const QJsonObject &)>;
+
+ static constexpr int kIndexBits = 24;
+ static constexpr int kGenerationBits = 29;
+ static constexpr quint32 kDefaultCapacity = 4096;
+
+ explicit CallbackRegistry(quint32 capacity = kDefaultCapacity);
+
+ using Trace = CallbackTrace;
+
+ // Monotonic milliseconds, the time base for deadlines
+ static qint64 now();
+
+ // Stores the callback and returns its ID. Returns 0 (leaving callback untouched) when the table is full.
+ // A deadline > 0 (see now()) makes the entry eligible for takeExpired().
+ quint64 add(Callback &&callback, qint64 deadline = 0, const Trace &trace = Trace());
+
+ // Removes and returns the callback for id; returns an empty function for unknown or stale IDs.
+ Callback take(quint64 id, Trace *trace = nullptr);
+
+ // Removes the entry with the earliest deadline if it is at or before now. Returns an
+ // empty function when nothing has expired; call repeatedly to reclaim all of them.
+ Callback takeExpired(qint64 now, quint64 *id = nullptr, Trace *trace = nullptr);
+
+ // Records when the request started running; returns false (and leaves trace alone) if
+ // the request is gone, i.e. it timed out or was cancelled while queued.
+ bool markStarted(quint64 id, qint64 startedUs, Trace *trace = nullptr);
+
+ // Earliest pending deadline, or -1 when no entry has one
+ qint64 nextDeadline() const;
+
+ bool contains(quint64 id) const;
+ quint32 size() const;
+ quint32 capacity() const { return m_capacity; }
+
+private:
+ static constexpr quint32 kNoSlot = 0xffffffffu;
+
+ struct Slot {
+  Callback callback;
+  Trace trace;
+  qint64 deadline = 0;
+  quint32 generation = 1;
+  quint32 nextFree = kNoSlot;
+  quint32 heapIndex = kNoSlot;
+  bool used = false;
+ };
+
+ static quint32 indexOf(quint64 id) { return quint32(id & ((quint64(1) << kIndexBits) - 1)); }
+ static quint32 generationOf(quint64 id) { return quint32(id >> kIndexBits); }
+ Slot *lookup(quint64 id) const; // call with m_mutex held
+ Callback release(quint32 index, Trace *trace); // call with m_mutex held
+
+ // Deadline heap helpers, call with m_mutex held
+ void heapPush(quint32 index);
+ void heapRemove(quint32 position);
+ void heapSiftUp(quint32 position);
+ void heapSiftDown(quint32 position);
+ void heapSwap(quint32 a, quint32 b);
+
+ const quint32 m_capacity;
+ std::unique_ptr<Slot[]> m_slots;
+ std::unique_ptr<quint32[]> m_heap; // slot indexes ordered by deadline
+ quint32 m_heapSize;
+ quint32 m_freeHead;
+ quint32 m_size;
+ mutable QMutex m_mutex;
+};
+
+#endif		// CALLBACK_REGISTRY_H
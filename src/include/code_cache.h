@@ -0,0 +1,39 @@
+#ifndef CODE_CACHE_H
+#define CODE_CACHE_H
+
+#ifdef ENABLE_NODEJS
+
+#include <v8.h>
+
+#include <QByteArray>
+#include <QString>
+
+// Persistent V8 code cache for one script.
+//
+// The cache file lives in the application cache dir (falling back to the binary's
+// directory) and stores the V8 cached-data version tag plus a SHA-256 of the script
+// source next to the data. load() only returns data whose key matches, so a new
+// bundle or a different V8 build simply misses and the cache is rewritten.
+class CodeCache {
+public:
+ explicit CodeCache(const QString &name);
+
+ // NODE_CODE_CACHE=0 disables loading and saving, for comparing cold compile times
+ static bool enabled();
+
+ // Key for a given source: V8 version tag + SHA-256 of the bytes
+ static QByteArray sourceKey(const char *data, qsizetype length);
+
+ // Returns nullptr on miss. The returned object owns its buffer; hand it to ScriptCompiler::Source.
+ v8::ScriptCompiler::CachedData *load(const QByteArray &key) const;
+ bool save(const QByteArray &key, const v8::ScriptCompiler::CachedData *data) const;
+
+ QString path() const { return m_path; }
+
+private:
+ QString m_path;
+};
+
+#endif // ENABLE_NODEJS
+
+#endif		// CODE_CACHE_H
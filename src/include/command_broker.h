@@ -0,0 +1,91 @@
+#ifndef COMMAND_BROKER_H
+#define COMMAND_BROKER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <functional>
+#include <sys/types.h>
+
+// Runs the external programs the JS managers need (ufw, ip, timedatectl, ...) off the
+// Node thread, exposed to the bundle as __nativeExec. Programs are started with
+// posix_spawnp, without a shell, on a small pool; stdout can be streamed, and a command
+// is killed (with its process group) once its timeout passes.
+//
+// Read-only queries can ask for their result to be cached for a few seconds: identical
+// requests within the TTL, or while the first one is still running, share one process.
+// Commands that change state set invalidate, which drops the cached results of the same
+// program, so e.g. `ufw allow` is seen by the next `ufw status`. Queries of that program
+// still running are retired: their result goes to whoever already waits on them, is not
+// cached, and later requests start a new process.
+class CommandBroker {
+public:
+ static constexpr int kDefaultTimeoutMs = 30000;
+ // Further output is read and dropped, so a chatty command cannot exhaust memory
+ static constexpr qsizetype kMaxOutputBytes = 4 * 1024 * 1024;
+
+ struct Request {
+  QString program; // looked up in PATH
+  QStringList arguments;
+  int timeoutMs = kDefaultTimeoutMs; // <= 0 waits forever
+  int cacheTtlMs = 0;                // 0 runs every time; ignored when streaming
+  bool invalidate = false;           // drops cached results of this program first
+ };
+
+ struct Result {
+  int exitCode = -1; // -1 when killed by a signal
+  int signal = 0;
+  bool timedOut = false;
+  bool cached = false;
+  QByteArray standardOutput;
+  QByteArray standardError;
+  QString error; // set when the program could not be started or watched
+  qint64 durationUs = 0;
+ };
+
+ // Both run on a pool thread, or inline from run() for a cache hit
+ using OutputCallback = std::function<void(const QByteArray &chunk)>;
+ using FinishedCallback = std::function<void(const Result &result)>;
+
+ CommandBroker();
+ ~CommandBroker();
+
+ // output, when set, gets stdout as it arrives (it is also in the result)
+ void run(const Request &request, OutputCallback output, FinishedCallback finished);
+
+ // Kills running commands and waits for them; later run() calls fail immediately
+ void shutdown();
+
+private:
+ struct CacheEntry {
+  Result result;
+  qint64 expiresAtMs;
+ };
+
+ struct InFlight {
+  QList<FinishedCallback> waiters;
+  quint64 ticket = 0;
+ };
+
+ static QString cacheKey(const Request &request);
+ Result execute(const Request &request, const OutputCallback &output);
+ void finish(const QString &key, quint64 ticket, int cacheTtlMs, const Result &result);
+
+ QMutex m_mutex;
+ QHash<QString, CacheEntry> m_cache;
+ // Requests waiting on an identical cacheable one that is already running
+ QHash<QString, InFlight> m_inflight;
+ // Invalidated while running, by ticket: results go to these waiters only and are not cached
+ QHash<quint64, QList<FinishedCallback>> m_retired;
+ quint64 m_nextTicket;
+ QSet<pid_t> m_running;
+ bool m_stopping;
+ QThreadPool m_pool;
+};
+
+#endif		// COMMAND_BROKER_H
@@ -0,0 +1,78 @@
+#ifndef LOOP_WATCHDOG_H
+#define LOOP_WATCHDOG_H
+
+#ifdef ENABLE_NODEJS
+
+#include <uv.h>
+#include <v8.h>
+
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+
+// Event-loop stall detector for the Node thread.
+//
+// The watchdog thread sends the loop a heartbeat (a uv_async) a few times per threshold,
+// and the Node thread answers it as soon as it gets around to running async callbacks.
+// An answer that takes longer than the threshold means the thread was busy the whole
+// time: JS handlers, promise chains, a stray execSync, but also I/O callbacks and the
+// microtasks they queue inside poll, or platform tasks between two uv_run calls. An idle
+// loop answers at once, since the heartbeat wakes it up. This holds in both loop modes:
+// pumpNodeOnce() runs async callbacks on every pass.
+//
+// Once a heartbeat goes unanswered past the threshold the watchdog asks V8, via
+// RequestInterrupt, for a sample of the JS stack that is stuck. When the answer finally
+// comes the stall is reported to BridgeMetrics with its length, the action that was running
+// and the stack. The length is measured from the heartbeat, so it can be short of the real
+// stall by up to one check interval (a quarter of the threshold).
+class LoopWatchdog {
+public:
+ static constexpr int kDefaultThresholdMs = 200;
+
+ LoopWatchdog();
+ ~LoopWatchdog();
+
+ // NODE_STALL_THRESHOLD_MS, or the default; 0 turns the watchdog off
+ static int thresholdFromEnvironment();
+
+ // Node thread: hooks the loop and starts watching. No-op when the threshold is 0.
+ void start(uv_loop_t *loop, v8::Isolate *isolate, int thresholdMs);
+ // Node thread: stops watching and closes the handles; they finish closing on the next uv_run
+ void stop();
+
+ // Node thread: brackets the synchronous part of handleMessage() for an action. Work that
+ // runs later (timers, I/O, promise callbacks) is blamed on the last action started.
+ void enterAction(const QString &action);
+ void leaveAction();
+
+private:
+ static void onHeartbeat(uv_async_t *handle);
+ static void sampleStack(v8::Isolate *isolate, void *data);
+ void watch();
+ void answerHeartbeat();
+
+ v8::Isolate *m_isolate;
+ qint64 m_thresholdUs;
+ uv_async_t m_heartbeat;
+ bool m_started;
+
+ // When the unanswered heartbeat was sent, 0 when none is pending
+ std::atomic<qint64> m_heartbeatSentUs;
+
+ QMutex m_mutex;
+ QWaitCondition m_stopCondition;
+ bool m_stopping;          // guarded by m_mutex
+ QString m_action;         // guarded by m_mutex
+ bool m_inHandler;         // guarded by m_mutex
+ qint64 m_flaggedSinceUs;  // heartbeat the watchdog flagged; guarded by m_mutex
+ QString m_flaggedAction;  // guarded by m_mutex
+ bool m_flaggedInHandler;  // guarded by m_mutex
+ QString m_flaggedStack;   // guarded by m_mutex
+ QThread *m_thread;
+};
+
+#endif // ENABLE_NODEJS
+
+#endif		// LOOP_WATCHDOG_H
@@ -0,0 +1,59 @@
+#ifndef NATIVE_CRYPTO_H
+#define NATIVE_CRYPTO_H
+
+#ifdef ENABLE_NODEJS
+
+#include <v8.h>
+
+#include <QByteArray>
+#include <QString>
+
+// Ethereum wallet primitives in C++, exposed to the bundle as __nativeCrypto so
+// crypto0.js does not have to load ethers for them: keccak-256, EIP-55 checksums,
+// secp256k1 public keys, BIP-39 seeds (PBKDF2-HMAC-SHA512) and BIP-32 derivation.
+//
+// Results match ethers v6 (keccak256, getAddress, Mnemonic.computeSeed,
+// HDNodeWallet.derivePath). Checking a phrase against the BIP-39 wordlist stays in JS,
+// which has the wordlist; mnemonicToSeed() takes the phrase as given.
+//
+// Key handling does not branch on secret data: scalar multiplication uses complete
+// addition formulas and a fixed 4-bit window with masked table lookups.
+class NativeCrypto {
+public:
+ // NODE_NATIVE_CRYPTO=0 leaves __nativeCrypto unset, so crypto0.js goes through ethers
+ static bool enabled();
+
+ static constexpr const char *kDefaultPath = "m/44'/60'/0'/0/0";
+
+ static QByteArray keccak256(const QByteArray &data);
+ static QByteArray sha512(const QByteArray &data);
+ static QByteArray hmacSha512(const QByteArray &key, const QByteArray &data);
+ static QByteArray pbkdf2Sha512(const QByteArray &password, const QByteArray &salt, int iterations, int length);
+
+ // BIP-39 seed: PBKDF2-HMAC-SHA512, 2048 rounds, over the NFKD forms of the phrase and
+ // "mnemonic" + passphrase
+ static QByteArray mnemonicToSeed(const QString &phrase, const QString &passphrase = QString());
+
+ // BIP-32 private key at path (e.g. kDefaultPath) below the master key of seed.
+ // Empty, with error set, for a malformed path or an invalid key along the way.
+ static QByteArray deriveKey(const QByteArray &seed, const QString &path, QString *error = nullptr);
+
+ // 65 bytes (0x04 x y) or 33 bytes compressed; empty unless 0 < privateKey < n
+ static QByteArray publicKey(const QByteArray &privateKey, bool compressed = false);
+ // EIP-55 checksummed address of an uncompressed public key
+ static QString address(const QByteArray &publicKey);
+ // 32-byte key from 64 hex digits with or without 0x, like new ethers.Wallet(key) takes it;
+ // empty when malformed or not 0 < key < n
+ static QByteArray parsePrivateKey(const QString &text);
+ // ethers.getAddress() for hex addresses: adds the EIP-55 checksum, or returns an empty
+ // string when the input is not 40 hex digits or has mixed case with a wrong checksum
+ static QString checksumAddress(const QString &address);
+
+ // {keccak256, keccak256Batch, checksumAddress, mnemonicToSeed, walletFromMnemonic,
+ //  walletFromPrivateKey}. Call with the isolate locked, inside a HandleScope.
+ static v8::Local<v8::Object> createBinding(v8::Isolate *isolate, v8::Local<v8::Context> context);
+};
+
+#endif // ENABLE_NODEJS
+
+#endif		// NATIVE_CRYPTO_H
@@ -0,0 +1,45 @@
+#ifndef NATIVE_HANDLERS_H
+#define NATIVE_HANDLERS_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <functional>
+#include <optional>
+
+// C++ fast path for bridge actions that are thin wrappers around sysfs reads or small
+// files. A handler claims an action name and runs on a small worker pool, without JSON
+// text, V8 or a promise in between, and returns the same result object the JS handler
+// would. Returning nullopt declines the request (e.g. the device has no backlight),
+// which then goes to Node as usual.
+class NativeHandlerRegistry {
+public:
+ using Handler = std::function<std::optional<QJsonObject>(const QJsonObject &params)>;
+ using Callback = std::function<void(const std::optional<QJsonObject> &result)>;
+
+ NativeHandlerRegistry();
+ ~NativeHandlerRegistry();
+
+ void registerHandler(const QString &action, Handler handler);
+ void setEnabled(bool enabled);
+ bool contains(const QString &action) const;
+ QStringList actions() const;
+
+ // Runs the handler on the pool and calls callback there with its result. Returns false
+ // (callback not called) if no handler claims the action.
+ bool dispatch(const QString &action, const QJsonObject &params, Callback callback);
+
+ // Blocks until running handlers are done, used on shutdown
+ void waitForDone();
+
+private:
+ mutable QReadWriteLock m_lock;
+ QHash<QString, Handler> m_handlers;
+ bool m_enabled = true;
+ QThreadPool m_pool;
+};
+
+#endif		// NATIVE_HANDLERS_H
@@ -1,17 +1,29 @@
 #ifndef NODE_H
 #define NODE_H
 
+#include <QJSEngine>
 #include <QJSValue>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QList>
 #include <QMutex>
+#include <QJsonValue>
 #include <QObject>
-#include <QWaitCondition>
+#include <QPointer>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariantMap>
+#include <atomic>
 #include <functional>
 #include <memory>
 
 #ifdef ENABLE_NODEJS
+#include "bridge_metrics.h"
+#include "native_handlers.h"
 #include "node_thread.h"
+#include "response_cache.h"
+#include "response_snapshot.h"
 #endif
 
 #ifdef ENABLE_NODEJS
@@ -20,33 +32,122 @@ enum class InitState { NotInitialized, Initializing, Initialized, Failed };
 
 class NodeJS : public QObject {
  Q_OBJECT
+ // When enabled, QML callbacks completed within one frame are delivered together in a single queued invocation
+ Q_PROPERTY(bool batchCallbacks READ batchCallbacks WRITE setBatchCallbacks NOTIFY batchCallbacksChanged)
+ // Bridge metrics, computed on every read; see metricsSnapshot()
+ Q_PROPERTY(QVariantMap metrics READ metricsSnapshot)
 
 public:
  explicit NodeJS(QObject *parent = nullptr);
  ~NodeJS();
 
+ // Starts Node.js in the background and returns immediately; ready() follows once handleMessage is available
  Q_INVOKABLE bool initialize();
  Q_INVOKABLE void shutdown();
+ Q_INVOKABLE bool isReady() const;
+
+ // Engine used to build JS result objects for QML callbacks
+ void setEngine(QJSEngine *engine);
+
+ bool batchCallbacks() const;
+ void setBatchCallbacks(bool enabled);
+
+ // All msg() overloads return a handle for cancel(), or 0 when there is nothing to cancel
+ // (the request was rejected, or it was made before initialize() and is still parked).
+
+ // Actions with a persisted snapshot answer their first request of a run twice: right away
+ // with the response from the previous run, marked "stale": true, then with the fresh one.
 
  // Generic message function for QML with callback
- Q_INVOKABLE void msg(const QString &name, const QJsonObject &params, const QJSValue &callback);
+ Q_INVOKABLE quint64 msg(const QString &name, const QJsonObject &params, const QJSValue &callback);
+
+ // Same with per-request options: {timeout: ms (0 = none), priority: "interactive" | "background"}.
+ // Missing keys fall back to the action's defaults.
+ Q_INVOKABLE quint64 msg(const QString &name, const QJsonObject &params, const QJSValue &callback, const QVariantMap &options);
 
  // Generic message function for QML without callback (uses signal)
- Q_INVOKABLE void msg(const QString &name, const QJsonObject &params = QJsonObject());
+ Q_INVOKABLE quint64 msg(const QString &name, const QJsonObject &params = QJsonObject());
 
  // For C++ usage with callbacks (overload)
- void msg(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback);
+ quint64 msg(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback);
+ quint64 msg(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback, const NodeRequestOptions &options);
+
+ // The request's callback will not be called; returns false if it already completed
+ Q_INVOKABLE bool cancel(quint64 requestId);
+
+ // Timeout and priority used when a request does not specify them
+ static NodeRequestOptions defaultRequestOptions(const QString &name);
+
+ // Hit/miss/coalesced counters of the response cache for cacheable read actions
+ Q_INVOKABLE QVariantMap cacheStats() const;
+
+ // Per-action latency histograms (queue, js, delivery), queue depth, in-flight requests,
+ // V8 heap statistics, cache counters and snapshot counters
+ Q_INVOKABLE QVariantMap metricsSnapshot() const;
+ // Writes metricsSnapshot() as JSON
+ Q_INVOKABLE bool dumpMetrics(const QString &path) const;
+
+ // Keep only the latest pending value for events of this type
+ Q_INVOKABLE void setEventCoalescing(const QString &type, bool enabled = true);
+
+ // C++ handlers that answer actions without entering Node; the sysfs ones are registered
+ // by default (NODE_NATIVE_HANDLERS=0 disables them all)
+ NativeHandlerRegistry &nativeHandlers();
 
 signals:
  void messageResponse(const QJsonObject &result);
  void messageProcessed(const QJsonObject &result);
  void initializationFailed(const QString &error);
+ void ready();
+ void batchCallbacksChanged();
+ // Pushed from JS via __nativeEmit(type, value)
+ void eventReceived(const QString &type, const QJsonValue &value);
 
 private:
+ struct PendingCallback {
+  QJSValue callback;
+  QJsonObject result;
+  ActionMetrics *metrics;
+  qint64 completedUs;
+ };
+
+ // msg() calls made before initialize() created the thread
+ struct PendingMessage {
+  QString name;
+  QJsonObject params;
+  std::function<void(const QJsonObject &)> callback;
+  NodeRequestOptions options;
+ };
+
+ // Runs a claimed action natively, otherwise hands it to sendToNode()
+ quint64 send(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback, const NodeRequestOptions &options);
+ // Hands a request to the Node thread, or parks it until initialize()
+ quint64 sendToNode(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback, const NodeRequestOptions &options);
+ // Thread-safe: hands a Node result to a QML callback on the main thread
+ void deliverToQml(const QJSValue &callback, const QJsonObject &result, ActionMetrics *metrics = nullptr);
+ void invokeQmlCallback(QJSValue &callback, const QJsonObject &result, ActionMetrics *metrics, qint64 completedUs);
+ void flushPendingCallbacks();
+ void dispatchEvents();
+ void failPreInitMessages(const QString &error);
+ // Thread-safe: writes the snapshot a little later, off the main thread
+ void scheduleSnapshotSave();
+
  std::unique_ptr<NodeThread> m_nodeThread;
+ QSet<QString> m_coalescedEventTypes;
  InitState m_initState;
- QMutex m_initMutex;
- QWaitCondition m_initCondition;
+ mutable QMutex m_initMutex;
+ QList<PendingMessage> m_preInitMessages;
+ ResponseCache m_responseCache;
+ ResponseSnapshot m_snapshot;
+ QTimer *m_snapshotTimer;
+ QThreadPool m_snapshotWriter; // after m_snapshot, so a running save finishes before it goes
+ NativeHandlerRegistry m_nativeHandlers;
+
+ QPointer<QJSEngine> m_engine;
+ std::atomic<bool> m_batchCallbacks;
+ QTimer *m_batchTimer;
+ QMutex m_pendingMutex;
+ QList<PendingCallback> m_pendingCallbacks;
 };
 
 #else // ENABLE_NODEJS
@@ -54,6 +155,8 @@ private:
 // Stub implementation when Node.js is disabled
 class NodeJS : public QObject {
  Q_OBJECT
+ Q_PROPERTY(bool batchCallbacks READ batchCallbacks WRITE setBatchCallbacks NOTIFY batchCallbacksChanged)
+ Q_PROPERTY(QVariantMap metrics READ metricsSnapshot)
 
 public:
  explicit NodeJS(QObject *parent = nullptr) : QObject(parent) {}
@@ -61,16 +164,30 @@ public:
 
  Q_INVOKABLE bool initialize() { return true; }
  Q_INVOKABLE void shutdown() {}
+ Q_INVOKABLE bool isReady() const { return true; }
+
+ void setEngine(QJSEngine *engine) {}
+ bool batchCallbacks() const { return false; }
+ void setBatchCallbacks(bool enabled) {}
 
  // Stub message functions that do nothing
- Q_INVOKABLE void msg(const QString &name, const QJsonObject &params, const QJSValue &callback) {}
- Q_INVOKABLE void msg(const QString &name, const QJsonObject &params = QJsonObject()) {}
- void msg(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback) {}
+ Q_INVOKABLE quint64 msg(const QString &name, const QJsonObject &params, const QJSValue &callback) { return 0; }
+ Q_INVOKABLE quint64 msg(const QString &name, const QJsonObject &params, const QJSValue &callback, const QVariantMap &options) { return 0; }
+ Q_INVOKABLE quint64 msg(const QString &name, const QJsonObject &params = QJsonObject()) { return 0; }
+ quint64 msg(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback) { return 0; }
+ Q_INVOKABLE bool cancel(quint64 requestId) { return false; }
+ Q_INVOKABLE QVariantMap cacheStats() const { return QVariantMap(); }
+ Q_INVOKABLE QVariantMap metricsSnapshot() const { return QVariantMap(); }
+ Q_INVOKABLE bool dumpMetrics(const QString &path) const { return false; }
+ Q_INVOKABLE void setEventCoalescing(const QString &type, bool enabled = true) {}
 
 signals:
  void messageResponse(const QJsonObject &result);
  void messageProcessed(const QJsonObject &result);
  void initializationFailed(const QString &error);
+ void ready();
+ void batchCallbacksChanged();
+ void eventReceived(const QString &type, const QJsonValue &value);
 };
 
 #endif // ENABLE_NODEJS
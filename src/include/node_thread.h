@@ -8,41 +8,91 @@
 #include <uv.h>
 #include <v8.h>
 
+#include "bridge_recorder.h"
+#include "callback_registry.h"
+#include "command_broker.h"
+#include "loop_watchdog.h"
+
 #include <QJsonObject>
-#include <QMap>
+#include <QJsonValue>
+#include <QList>
 #include <QMutex>
 #include <QObject>
 #include <QQueue>
+#include <QSet>
 #include <QThread>
-#include <QUuid>
 #include <QWaitCondition>
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <unordered_map>
 
 struct NodeMessage {
- QString messageId;
+ quint64 messageId = 0; // CallbackRegistry ID, the callback itself lives in the registry
  QString action;
  QJsonObject params;
- std::function<void(const QJsonObject &)> callback;
+};
+
+struct NodeRequestOptions {
+ static constexpr int kDefaultTimeoutMs = 60000;
+
+ // Interactive requests are dequeued ahead of background ones (scans, network fetches, ...)
+ enum class Priority { Interactive, Background };
+ Priority priority = Priority::Interactive;
+ // The callback gets a timeout error and the slot is reclaimed after this long; <= 0 waits forever
+ int timeoutMs = kDefaultTimeoutMs;
+};
+
+struct NodeEvent {
+ QString type;
+ QJsonValue value;
 };
 
 class NodeThread : public QThread {
  Q_OBJECT
 
 public:
+ // EventDriven blocks in libuv until a message, timer, I/O or platform task arrives.
+ // Polling is the legacy 1 ms pump, kept for debugging (NODE_LOOP_MODE=poll).
+ enum class LoopMode { EventDriven, Polling };
+
  explicit NodeThread(QObject *parent = nullptr);
  ~NodeThread();
 
  bool initialize();
  void shutdown();
 
- // Direct message sending (thread-safe via Qt's signal-slot mechanism)
- void sendMessage(const QString &action, const QJsonObject &params, std::function<void(const QJsonObject &)> callback);
+ // Must be called before initialize()
+ void setLoopMode(LoopMode mode);
+ LoopMode loopMode() const;
+
+ // Thread-safe. Returns the message ID, usable with cancel(), or 0 if the request was rejected
+ // (the callback has then already been called with an error).
+ quint64 sendMessage(const QString &action, const QJsonObject &params, std::function<void(const QJsonObject &)> callback, const NodeRequestOptions &options = NodeRequestOptions());
+ // Drops the callback of a pending request; it will not be called. Returns false if the
+ // request already completed, timed out or was cancelled. A request still waiting in the
+ // queue is skipped, one already running in JS finishes but its reply is discarded.
+ bool cancel(quint64 messageId);
+
+ // While both lanes have work, one background message is let through after this many interactive ones
+ static constexpr int kInteractiveBurst = 8;
+
+ // Requests sent but not yet answered, timed out or cancelled
+ quint32 pendingRequests() const;
+
+ // Events pushed from JS via __nativeEmit(type, value). Coalesced types keep only the
+ // latest pending value; the queue is bounded and drops the oldest event when full.
+ static constexpr int kMaxPendingEvents = 256;
+ void setEventCoalescing(const QString &type, bool enabled);
+ QList<NodeEvent> takeEvents();
 
 signals:
  void messageProcessed(const QJsonObject &result);
  void initializationFailed(const QString &error);
+ // Emitted from the Node thread once the bundle is loaded and handleMessage is cached
+ void ready();
+ // Emitted from the Node thread when the event queue goes from empty to non-empty
+ void eventsAvailable();
 
 protected:
  void run() override;
@@ -54,8 +104,27 @@ private:
  bool initializeNodeEnvironment();
  bool loadJSEntryPoint();
  void processMessages();
+ void processMessagesEventDriven();
+ void processMessagesPolling();
+ bool drainMessageQueue(); // returns true if any message was handled
+ bool dequeueMessage(NodeMessage &message); // call with m_messageMutex held
+ void wakeLoop();           // call with m_messageMutex held
+ static void onWakeAsync(uv_async_t *handle);
+ void expireRequests();
+ void scheduleDeadlineTimer();
+ static void onDeadlineTimer(uv_timer_t *handle);
+ void sampleHeapStatistics(); // Node thread only, rate-limited
  void handleNodeMessage(const NodeMessage &message);
+ void failMessage(quint64 messageId, const QString &error);
  static void nativeCallback(const v8::FunctionCallbackInfo<v8::Value> &args);
+ static void nativeEmit(const v8::FunctionCallbackInfo<v8::Value> &args);
+ void pushEvent(const QString &type, const QJsonValue &value);
+ // __nativeRequireChunk(name, require) -> module.exports of dist/chunks/<name>.cjs from the QRC
+ static void nativeRequireChunk(const v8::FunctionCallbackInfo<v8::Value> &args);
+ // __nativeExec(file, args, {timeout, cacheTtl, invalidate, onData}) -> Promise, see CommandBroker
+ static void nativeExec(const v8::FunctionCallbackInfo<v8::Value> &args);
+ static void onExecAsync(uv_async_t *handle);
+ void closeCommandBroker();
 
  // Node.js environment
  std::unique_ptr<node::CommonEnvironmentSetup> m_setup;
@@ -68,12 +137,55 @@ private:
  // Thread synchronization
  QMutex m_messageMutex;
  QWaitCondition m_messageCondition;
- QQueue<NodeMessage> m_messageQueue;
+ QQueue<NodeMessage> m_interactiveQueue;
+ QQueue<NodeMessage> m_backgroundQueue;
+ int m_interactiveStreak;
+ static constexpr qint64 kHeapSampleIntervalMs = 1000;
+ qint64 m_heapSampledAt;
  std::atomic<bool> m_running;
+ LoopMode m_loopMode;
+
+ // Wakes the event-driven loop from other threads; guarded by m_messageMutex
+ uv_async_t m_wakeAsync;
+ bool m_wakeReady;
+ // Fires at the earliest request deadline (event-driven mode only)
+ uv_timer_t m_deadlineTimer;
 
  // Callback storage for concurrent messages
- QMap<QString, std::function<void(const QJsonObject &)>> m_callbacks;
- QMutex m_callbackMutex;
+ CallbackRegistry m_callbacks;
+
+ // Flags handlers that keep the Node thread from answering its heartbeat, see LoopWatchdog
+ LoopWatchdog m_watchdog;
+
+ // Traffic recorder for bench/bridge_replay, only when BRIDGE_TRACE_FILE is set
+ std::unique_ptr<BridgeRecorder> m_recorder;
+
+ // External commands run for JS. Results come back from the pool through m_execAsync
+ // and settle their promise on the Node thread.
+ struct ExecEvent {
+  quint64 execId;
+  bool finished; // false: stdout chunk for onData
+  QByteArray chunk;
+  CommandBroker::Result result;
+ };
+ struct PendingExec {
+  v8::Global<v8::Promise::Resolver> resolver;
+  v8::Global<v8::Function> onData;
+ };
+ void pushExecEvent(ExecEvent event);
+ CommandBroker m_commandBroker;
+ uv_async_t m_execAsync;
+ QMutex m_execMutex;
+ bool m_execReady; // guarded by m_execMutex
+ QList<ExecEvent> m_execEvents;
+ std::unordered_map<quint64, PendingExec> m_pendingExecs; // Node thread only
+ quint64 m_nextExecId;
+
+ // Pending events for the main thread
+ QMutex m_eventMutex;
+ QList<NodeEvent> m_events;
+ QSet<QString> m_coalescedEventTypes;
+ quint64 m_droppedEvents;
 
  static NodeThread *s_instance;
 };
@@ -0,0 +1,30 @@
+#ifndef POWER_SUPPLY_H
+#define POWER_SUPPLY_H
+
+#include <QByteArray>
+#include <QString>
+
+// Battery and AC state read straight from the kernel's power_supply class
+struct PowerSupplyState {
+ bool available = false;   // the class directory exists
+ bool hasBattery = false;
+ int level = 0;            // percent
+ bool charging = false;
+ bool acConnected = false;
+
+ bool operator==(const PowerSupplyState &other) const {
+  return available == other.available && hasBattery == other.hasBattery && level == other.level && charging == other.charging && acConnected == other.acConnected;
+ }
+ bool operator!=(const PowerSupplyState &other) const { return !(*this == other); }
+};
+
+// Contents of a sysfs attribute without the trailing newline; empty if unreadable
+QByteArray readSysfsAttribute(const QString &path);
+
+static const char kPowerSupplyRoot[] = "/sys/class/power_supply";
+
+// Uses the first system battery (peripherals with scope=Device are skipped) and any
+// online Mains/USB supply. root can point at a fake tree with the same layout.
+PowerSupplyState readPowerSupply(const QString &root = QString::fromLatin1(kPowerSupplyRoot));
+
+#endif		// POWER_SUPPLY_H
@@ -0,0 +1,88 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <functional>
+
+// Shares bridge responses for idempotent read-only actions.
+//
+// Requests are keyed by action + compact params JSON. While a request for a key is in
+// flight, identical requests join it and get the same result. Actions with a TTL also
+// keep their last successful result for that long, so repeat requests are answered
+// without a trip to the Node thread. Write actions can invalidate the reads they affect:
+// requests already in flight for those reads are retired, so later requests start fresh
+// instead of joining them, and their results go only to the callers that were waiting.
+// Error results are fanned out but never cached. All methods are thread-safe.
+class ResponseCache {
+public:
+ using Callback = std::function<void(const QJsonObject &)>;
+
+ enum class Lookup {
+  Hit,    // answered from cache, result is filled in
+  Joined, // an identical request is in flight, callback will be called with its result
+  Miss    // caller must send the request and pass the result to complete()
+ };
+
+ // ttlMs = 0 only coalesces in-flight requests
+ void setPolicy(const QString &action, int ttlMs);
+ // Sending writeAction drops cached and in-flight results of readActions
+ void setInvalidation(const QString &writeAction, const QStringList &readActions);
+
+ void setEnabled(bool enabled);
+ bool isCacheable(const QString &action) const;
+ bool isInvalidating(const QString &writeAction) const;
+
+ static QString key(const QString &action, const QJsonObject &params);
+
+ // On Miss the callback is stored as the first waiter for key, and ticket identifies the
+ // request to complete()
+ Lookup lookup(const QString &key, const QString &action, Callback &callback, QJsonObject *result, quint64 *ticket);
+ // Stores the result (if successful, not invalidated meanwhile and the action has a TTL) and
+ // calls every waiter of that request
+ void complete(const QString &key, quint64 ticket, const QString &action, const QJsonObject &result);
+ void invalidate(const QString &writeAction);
+
+ // {hits, misses, coalesced, invalidations, entries, actions: {name: {hits, misses, coalesced}}}
+ QVariantMap stats() const;
+
+private:
+ struct Entry {
+  QJsonObject result;
+  qint64 expires = 0;
+ };
+
+ struct InFlight {
+  QList<Callback> waiters;
+  quint64 ticket = 0;
+ };
+
+ struct Counters {
+  quint64 hits = 0;
+  quint64 misses = 0;
+  quint64 coalesced = 0;
+ };
+
+ static constexpr int kMaxEntries = 256;
+
+ void purgeExpired(qint64 now); // call with m_mutex held
+
+ mutable QMutex m_mutex;
+ bool m_enabled = true;
+ QHash<QString, int> m_ttl;
+ QHash<QString, QStringList> m_invalidates;
+ QHash<QString, Entry> m_entries;
+ QHash<QString, InFlight> m_inFlight;
+ // Invalidated while in flight, by ticket: results go to these waiters only and are not cached
+ QHash<quint64, QList<Callback>> m_retired;
+ quint64 m_nextTicket = 1;
+ QHash<QString, Counters> m_counters;
+ quint64 m_invalidations = 0;
+};
+
+#endif		// RESPONSE_CACHE_H
@@ -0,0 +1,66 @@
+#ifndef RESPONSE_SNAPSHOT_H
+#define RESPONSE_SNAPSHOT_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVariantMap>
+
+// Last successful response of selected read actions, kept across restarts so pages have
+// something to show before Node is up (stale-while-revalidate).
+//
+// The snapshot file is memory-mapped at startup and only its index is read then; a
+// response is decoded from the mapping (CBOR) when it is first asked for. Each stored
+// response is handed out once per run, marked "stale", while the real request goes to
+// Node as usual. Fresh results are kept in memory and written behind by save(), which
+// replaces the file atomically. Results that did not change only make the snapshot dirty
+// once a day, to renew their time, so polled actions do not keep rewriting it. All
+// methods are thread-safe.
+class ResponseSnapshot {
+public:
+ explicit ResponseSnapshot(const QString &path = defaultPath());
+
+ // responses.snapshot in the application cache dir, falling back to the binary's directory
+ static QString defaultPath();
+
+ void setPersistent(const QString &action);
+ void setEnabled(bool enabled);
+ bool isPersistent(const QString &action) const;
+
+ // Maps the snapshot file. A missing, foreign or damaged file leaves the snapshot empty.
+ bool load();
+ // The stored response for key with "stale": true and "savedAt" (ms since the epoch).
+ // Only once per key and run, and never after a fresh result for it was stored.
+ bool takeStale(const QString &key, QJsonObject *result);
+ // Records a successful result of a persistent action; true when save() has something to write
+ bool store(const QString &key, const QString &action, const QJsonObject &result);
+ bool save();
+
+ // {enabled, entries, served, saves, path}
+ QVariantMap stats() const;
+
+private:
+ struct Entry {
+  QByteArray cbor; // points into the mapping until replaced by a fresh result
+  qint64 savedAt = 0;
+  bool served = false;
+ };
+
+ static constexpr int kMaxEntries = 64;
+
+ mutable QMutex m_mutex;
+ QString m_path;
+ bool m_enabled = true;
+ QSet<QString> m_actions;
+ QFile m_file; // stays open while mapped
+ QHash<QString, Entry> m_entries;
+ bool m_dirty = false;
+ quint64 m_served = 0;
+ quint64 m_saves = 0;
+};
+
+#endif		// RESPONSE_SNAPSHOT_H
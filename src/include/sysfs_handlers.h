@@ -0,0 +1,12 @@
+#ifndef SYSFS_HANDLERS_H
+#define SYSFS_HANDLERS_H
+
+#include "native_handlers.h"
+
+// Native versions of the battery, brightness and time zone read actions (js/src/battery.js,
+// display.js, time.js), answered from sysfs and /usr/share/zoneinfo instead of
+// systeminformation, brightnessctl and timedatectl. Each declines when its source is
+// missing, leaving the request to the JS handler.
+void registerSysfsHandlers(NativeHandlerRegistry &registry);
+
+#endif		// SYSFS_HANDLERS_H
@@ -0,0 +1,42 @@
+#ifndef V8_JSON_H
+#define V8_JSON_H
+
+#ifdef ENABLE_NODEJS
+
+#include <v8.h>
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <vector>
+
+// Direct conversion between Qt JSON values and V8 values, walking both trees without
+// an intermediate JSON text. fromV8() follows JSON.stringify() semantics: toJSON() is
+// honoured, functions/symbols/undefined are dropped from objects and become null in
+// arrays, and non-finite numbers become null. BigInts are emitted as decimal strings
+// instead of throwing. Where JSON.stringify() would throw (a cycle, a throwing toJSON())
+// the value becomes null, or is dropped, with a warning, and no exception is left pending.
+// Callers must hold the isolate lock and have a HandleScope.
+class V8Json {
+public:
+ static v8::Local<v8::Value> toV8(v8::Isolate *isolate, v8::Local<v8::Context> context, const QJsonValue &value);
+ static v8::Local<v8::Object> toV8(v8::Isolate *isolate, v8::Local<v8::Context> context, const QJsonObject &object);
+ static v8::Local<v8::Array> toV8(v8::Isolate *isolate, v8::Local<v8::Context> context, const QJsonArray &array);
+ static v8::Local<v8::String> toV8(v8::Isolate *isolate, const QString &string);
+
+ // Returns QJsonValue::Undefined for values JSON.stringify() would skip
+ static QJsonValue fromV8(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value);
+ static QString toQString(v8::Isolate *isolate, v8::Local<v8::String> string);
+
+private:
+ // Deeper structures are cut off, cycles or not
+ static constexpr int kMaxDepth = 128;
+
+ // ancestors: the objects and arrays being converted on the way down to value
+ static QJsonValue fromV8(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value, int depth, std::vector<v8::Local<v8::Object>> &ancestors);
+ static QJsonValue fromV8Children(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Object> object, int depth, std::vector<v8::Local<v8::Object>> &ancestors);
+};
+
+#endif // ENABLE_NODEJS
+
+#endif		// V8_JSON_H
@@ -0,0 +1,121 @@
+#ifndef WIFIMONITOR_H
+#define WIFIMONITOR_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <optional>
+
+class QSocketNotifier;
+
+// WiFi link and signal state without forking ip/iw/nmcli, pushed to QML.
+//
+// Link changes (association, carrier, interface up/down) arrive as rtnetlink RTM_NEWLINK
+// messages and trigger an immediate re-read. Signal strength has no event, so it is
+// polled: nl80211 over generic netlink (interface dump for name and SSID, station dump
+// for the AP's signal), or /proc/net/wireless when nl80211 is not available.
+//
+// The reads run on a worker thread and the result is applied on the GUI thread, so a
+// driver that is slow to answer nl80211 never stalls the UI. A refresh asked for while
+// one is running is run once more after it.
+//
+// strength is the 0-4 bar count used by wifi.js, with hysteresis: it only moves once the
+// quality is a few points inside the next bucket, so a signal hovering on a boundary
+// does not make SignalStrength.qml flicker.
+class WifiMonitor : public QObject {
+ Q_OBJECT
+ Q_PROPERTY(bool connected READ connected NOTIFY connectedChanged)
+ Q_PROPERTY(QString interfaceName READ interfaceName NOTIFY interfaceNameChanged)
+ Q_PROPERTY(QString ssid READ ssid NOTIFY ssidChanged)
+ Q_PROPERTY(int quality READ quality NOTIFY qualityChanged)
+ Q_PROPERTY(int strength READ strength NOTIFY strengthChanged)
+ Q_PROPERTY(int pollInterval READ pollInterval WRITE setPollInterval NOTIFY pollIntervalChanged)
+
+public:
+ static constexpr int kDefaultPollIntervalMs = 5000;
+ // Quality points past a bucket boundary before strength follows
+ static constexpr int kHysteresis = 5;
+
+ struct Link {
+  QString interfaceName;
+  QString ssid;
+  bool connected = false;
+  std::optional<int> signalDbm;
+  int quality = 0; // 0-100
+ };
+
+ // /proc/net/wireless row
+ struct ProcEntry {
+  QString interfaceName;
+  int link = 0;
+  int levelDbm = 0;
+ };
+
+ // nl80211 interface dump entry
+ struct Interface {
+  int index = 0;
+  QString name;
+  QString ssid;
+  bool station = false;
+ };
+
+ explicit WifiMonitor(QObject *parent = nullptr);
+ ~WifiMonitor();
+
+ bool connected() const { return m_link.connected; }
+ QString interfaceName() const { return m_link.interfaceName; }
+ QString ssid() const { return m_link.ssid; }
+ int quality() const { return m_link.quality; }
+ int strength() const { return m_strength; }
+
+ int pollInterval() const;
+ void setPollInterval(int ms);
+
+ Q_INVOKABLE void refresh();
+
+ // Parsers, kept free of I/O so they can be fed recorded data
+ static QList<ProcEntry> parseProcNetWireless(const QByteArray &text);
+ static QList<Interface> parseInterfaceDump(const QByteArray &messages);
+ static std::optional<int> parseStationSignal(const QByteArray &messages);
+ // dBm to 0-100 the way NetworkManager (and so nmcli/node-wifi) does it
+ static int qualityFromDbm(int dbm);
+ static int strengthFromQuality(int quality);
+ static int strengthWithHysteresis(int quality, int previous);
+
+signals:
+ void connectedChanged();
+ void interfaceNameChanged();
+ void ssidChanged();
+ void qualityChanged();
+ void strengthChanged();
+ void pollIntervalChanged();
+
+private:
+ std::optional<Link> readNl80211();
+ Link readProcFallback();
+ bool resolveNl80211();
+ // Sends one generic netlink request and returns the reply messages, nullopt on error
+ std::optional<QByteArray> genericRequest(quint16 family, quint8 command, quint16 flags, const QByteArray &attributes);
+ void openLinkSocket();
+ void readLinkEvents();
+ void apply(const Link &link);
+
+ Link m_link;
+ int m_strength;
+ QTimer m_pollTimer;
+ QTimer m_linkTimer; // coalesces bursts of RTM_NEWLINK
+ int m_genericSocket;
+ int m_nl80211Family;
+ quint32 m_sequence;
+ int m_linkSocket;
+ QSocketNotifier *m_linkNotifier;
+ // One reader at a time; the nl80211 socket and sequence are only used from it
+ QThreadPool m_reader;
+ bool m_reading;
+ bool m_refreshAgain;
+};
+
+#endif		// WIFIMONITOR_H
@@ -0,0 +1,153 @@
+#ifdef ENABLE_NODEJS
+
+#include "include/loop_watchdog.h"
+#include "include/bridge_metrics.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QStringList>
+
+// Frames kept from a stack sample
+static const int kStackFrames = 12;
+// The watchdog looks (and sends a heartbeat) this many times per threshold, so a stall is
+// flagged within +25%
+static const int kChecksPerThreshold = 4;
+
+LoopWatchdog::LoopWatchdog() : m_isolate(nullptr), m_thresholdUs(0), m_started(false), m_heartbeatSentUs(0), m_stopping(false), m_inHandler(false), m_flaggedSinceUs(0), m_flaggedInHandler(false), m_thread(nullptr) {}
+
+LoopWatchdog::~LoopWatchdog() {
+	stop();
+}
+
+int LoopWatchdog::thresholdFromEnvironment() {
+	bool ok = false;
+	const int threshold = qEnvironmentVariableIntValue("NODE_STALL_THRESHOLD_MS", &ok);
+	return ok && threshold >= 0 ? threshold : kDefaultThresholdMs;
+}
+
+void LoopWatchdog::start(uv_loop_t *loop, v8::Isolate *isolate, int thresholdMs) {
+	if (m_started || thresholdMs <= 0) return;
+	m_isolate = isolate;
+	m_thresholdUs = qint64(thresholdMs) * 1000;
+
+	uv_async_init(loop, &m_heartbeat, onHeartbeat);
+	m_heartbeat.data = this;
+	uv_unref(reinterpret_cast<uv_handle_t *>(&m_heartbeat));
+	m_heartbeatSentUs.store(0);
+
+	m_stopping = false;
+	m_thread = QThread::create([this]() { watch(); });
+	m_thread->setObjectName("LoopWatchdog");
+	m_thread->start(QThread::LowPriority);
+	m_started = true;
+}
+
+void LoopWatchdog::stop() {
+	if (!m_started) return;
+	{
+		QMutexLocker locker(&m_mutex);
+		m_stopping = true;
+		m_stopCondition.wakeAll();
+	}
+	m_thread->wait();
+	delete m_thread;
+	m_thread = nullptr;
+
+	// The watchdog thread is gone, so nothing sends on the handle any more
+	uv_close(reinterpret_cast<uv_handle_t *>(&m_heartbeat), nullptr);
+	m_started = false;
+}
+
+void LoopWatchdog::enterAction(const QString &action) {
+	if (!m_started) return;
+	QMutexLocker locker(&m_mutex);
+	m_action = action;
+	m_inHandler = true;
+}
+
+void LoopWatchdog::leaveAction() {
+	if (!m_started) return;
+	QMutexLocker locker(&m_mutex);
+	m_inHandler = false;
+}
+
+void LoopWatchdog::onHeartbeat(uv_async_t *handle) {
+	static_cast<LoopWatchdog *>(handle->data)->answerHeartbeat();
+}
+
+void LoopWatchdog::answerHeartbeat() {
+	const qint64 since = m_heartbeatSentUs.exchange(0);
+	if (since == 0) return;
+	const qint64 busyUs = BridgeMetrics::nowUs() - since;
+	if (busyUs < m_thresholdUs) return;
+
+	BridgeMetrics::Stall stall;
+	stall.durationUs = busyUs;
+	{
+		QMutexLocker locker(&m_mutex);
+		if (m_flaggedSinceUs == since) {
+			stall.action = m_flaggedAction;
+			stall.inHandler = m_flaggedInHandler;
+			stall.stack = m_flaggedStack;
+		} else {
+			// Ended between two watchdog checks, so there is no stack sample
+			stall.action = m_action;
+			stall.inHandler = m_inHandler;
+		}
+		m_flaggedSinceUs = 0;
+		m_flaggedStack.clear();
+	}
+	BridgeMetrics::instance().recordStall(stall);
+	qWarning().noquote() << QString("LoopWatchdog: Event loop was blocked for %1 ms (%2%3)").arg(busyUs / 1000).arg(stall.action.isEmpty() ? QStringLiteral("no action") : stall.action, stall.inHandler ? QString() : QStringLiteral(", after its handler returned"));
+	if (!stall.stack.isEmpty()) qWarning().noquote() << "LoopWatchdog: Stack while blocked:\n" + stall.stack;
+}
+
+void LoopWatchdog::watch() {
+	const unsigned long intervalMs = qMax<qint64>(1, m_thresholdUs / 1000 / kChecksPerThreshold);
+	QMutexLocker locker(&m_mutex);
+	while (!m_stopping) {
+		m_stopCondition.wait(&m_mutex, intervalMs);
+		if (m_stopping) break;
+
+		const qint64 now = BridgeMetrics::nowUs();
+		const qint64 since = m_heartbeatSentUs.load();
+		if (since == 0) {
+			// uv_async_send is the one libuv call that is safe from another thread
+			m_heartbeatSentUs.store(now);
+			uv_async_send(&m_heartbeat);
+			continue;
+		}
+		if (since == m_flaggedSinceUs || now - since < m_thresholdUs) continue;
+
+		m_flaggedSinceUs = since;
+		m_flaggedAction = m_action;
+		m_flaggedInHandler = m_inHandler;
+		m_flaggedStack.clear();
+		// Thread-safe; runs on the Node thread at its next interrupt check inside JS
+		m_isolate->RequestInterrupt(sampleStack, this);
+	}
+}
+
+void LoopWatchdog::sampleStack(v8::Isolate *isolate, void *data) {
+	auto *self = static_cast<LoopWatchdog *>(data);
+	{
+		// The interrupt can also land in a later, unrelated stretch of JS; only the flagged one counts
+		QMutexLocker locker(&self->m_mutex);
+		if (self->m_flaggedSinceUs == 0 || self->m_flaggedSinceUs != self->m_heartbeatSentUs.load()) return;
+	}
+
+	v8::HandleScope handle_scope(isolate);
+	v8::Local<v8::StackTrace> trace = v8::StackTrace::CurrentStackTrace(isolate, kStackFrames, v8::StackTrace::kDetailed);
+	QStringList frames;
+	for (int i = 0; i < trace->GetFrameCount(); i++) {
+		v8::Local<v8::StackFrame> frame = trace->GetFrame(isolate, i);
+		v8::String::Utf8Value function(isolate, frame->GetFunctionName());
+		v8::String::Utf8Value script(isolate, frame->GetScriptName());
+		frames.append(QString("  at %1 (%2:%3:%4)").arg(function.length() > 0 ? QString::fromUtf8(*function) : QStringLiteral("<anonymous>"), script.length() > 0 ? QString::fromUtf8(*script) : QStringLiteral("<unknown>")).arg(frame->GetLineNumber()).arg(frame->GetColumn()));
+	}
+
+	QMutexLocker locker(&self->m_mutex);
+	if (self->m_flaggedSinceUs == self->m_heartbeatSentUs.load()) self->m_flaggedStack = frames.join('\n');
+}
+
+#endif // ENABLE_NODEJS
@@ -6,19 +6,68 @@
 #include <QIcon>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
 #include <QtQml>
 
 // Added for environment/platform setup
+#include "include/audiomixer.h"
+#include "include/batterymonitor.h"
 #include "include/hotreload.h"
 #include "include/node.h"
+#include "include/wifimonitor.h"
 #include "include/windowsettings.h"
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QProcess>
 
+#ifdef ENABLE_NODEJS
+#include <QSocketNotifier>
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// SIGUSR2 dumps bridge metrics (SIGUSR1 is Node's, it starts the inspector). The handler
+// only writes a byte to a socket pair; the dump itself runs on the main thread when the
+// notifier sees it.
+static int metricsSignalFd[2] = {-1, -1};
+
+static void onMetricsSignal(int) {
+	char byte = 1;
+	ssize_t written = ::write(metricsSignalFd[0], &byte, sizeof(byte));
+	(void)written;
+}
+
+static void installMetricsDumpSignal(NodeJS *nodeJS) {
+	if (::socketpair(AF_UNIX, SOCK_STREAM, 0, metricsSignalFd) != 0) {
+		qWarning() << "Cannot create socket pair for SIGUSR2, metrics dump disabled";
+		return;
+	}
+	QString path = qEnvironmentVariable("BRIDGE_METRICS_FILE");
+	if (path.isEmpty()) path = QDir::temp().filePath("wallet-bridge-metrics.json");
+
+	auto *notifier = new QSocketNotifier(metricsSignalFd[1], QSocketNotifier::Read, nodeJS);
+	QObject::connect(notifier, &QSocketNotifier::activated, nodeJS, [nodeJS, path]() {
+		char byte;
+		ssize_t received = ::read(metricsSignalFd[1], &byte, sizeof(byte));
+		(void)received;
+		nodeJS->dumpMetrics(path);
+	});
+
+	struct sigaction action = {};
+	action.sa_handler = onMetricsSignal;
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = SA_RESTART;
+	sigaction(SIGUSR2, &action, nullptr);
+}
+#endif
+
 int main(int argc, char *argv[]) {
+	QElapsedTimer startupTimer;
+	startupTimer.start();
+
 #ifdef ENABLE_NODEJS
 	// Setup arguments for Node.js FIRST - before Qt
 	argv = uv_setup_args(argc, argv);
@@ -72,7 +121,31 @@ int main(int argc, char *argv[]) {
 	// Create global instances for context properties
 	NodeJS *nodeJS = new NodeJS();
 
+#ifdef ENABLE_NODEJS
+	// Start Node.js as early as possible so it boots in parallel with the QML engine.
+	// msg() never blocks; requests made before Node is ready are queued and run once it is.
+	QObject::connect(nodeJS, &NodeJS::ready, &app, [&startupTimer]() { qInfo() << "Node.js ready after" << startupTimer.elapsed() << "ms"; });
+	if (!nodeJS->initialize()) {
+		qWarning() << "Failed to initialize Node.js embedding";
+	}
+	installMetricsDumpSignal(nodeJS);
+#else
+	// qDebug() << "Node.js integration disabled at compile time";
+#endif
+
 	QQmlApplicationEngine engine;
+	nodeJS->setEngine(&engine);
+
+	// Report time to first frame once the root window is created
+	QObject::connect(&engine, &QQmlApplicationEngine::objectCreated, &app, [&startupTimer](QObject *obj, const QUrl &) {
+		auto *window = qobject_cast<QQuickWindow *>(obj);
+		if (!window) return;
+		auto connection = std::make_shared<QMetaObject::Connection>();
+		*connection = QObject::connect(window, &QQuickWindow::frameSwapped, window, [&startupTimer, connection]() {
+			QObject::disconnect(*connection);
+			qInfo() << "First frame after" << startupTimer.elapsed() << "ms";
+		});
+	});
 
 #ifdef ENABLE_FELGO_LIVE
 	// Initialize Felgo for hot reload support
@@ -83,17 +156,6 @@ int main(int argc, char *argv[]) {
 	qInfo() << "Felgo Live integration: DISABLED - standard QML loading";
 #endif
 
-#ifdef ENABLE_NODEJS
-	// Initialize Node.js
-	if (!nodeJS->initialize()) {
-		qWarning() << "Failed to initialize Node.js embedding";
-	} else {
-		// qDebug() << "Node.js initialization completed successfully";
-	}
-#else
-	// qDebug() << "Node.js integration disabled at compile time";
-#endif
-
 	// qDebug() << "QtQuick.LocalStorage: " << QUrl::fromLocalFile(engine.offlineStoragePath());
 
 	// Read timer interval environment variables with defaults
@@ -105,24 +167,37 @@ int main(int argc, char *argv[]) {
 	int batteryInterval = batteryIntervalEnv.isEmpty() ? 10000 : batteryIntervalEnv.toInt();
 	if (batteryInterval <= 0) batteryInterval = 10000; // Ensure positive value
 
-	QByteArray eventsIntervalEnv = qgetenv("EVENTS_POLL_INTERVAL");
-	int eventsInterval = eventsIntervalEnv.isEmpty() ? 3500 : eventsIntervalEnv.toInt();
-	if (eventsInterval <= 0) eventsInterval = 3500; // Ensure positive value
+	// Battery changes arrive as uevents; without them the monitor polls at the configured interval
+	BatteryMonitor *batteryMonitor = new BatteryMonitor(&app);
+	if (!batteryMonitor->isListening()) batteryMonitor->setPollInterval(batteryInterval);
+
+	// Link changes arrive over rtnetlink; signal strength is polled at the configured interval
+	WifiMonitor *wifiMonitor = new WifiMonitor(&app);
+	wifiMonitor->setPollInterval(wifiInterval);
+
+	// Volume goes straight to the mixer instead of through amixer in Node
+	AudioMixer *audioMixer = new AudioMixer(&app);
+#ifdef ENABLE_NODEJS
+	audioMixer->registerHandlers(nodeJS->nativeHandlers());
+	// The handlers call into audioMixer, which goes away with app
+	QObject::connect(&app, &QCoreApplication::aboutToQuit, nodeJS, [nodeJS]() { nodeJS->nativeHandlers().waitForDone(); });
+#endif
 
 	// qDebug() << "WiFi strength update interval:" << wifiInterval << "ms";
 	// qDebug() << "Battery status update interval:" << batteryInterval << "ms";
-	// qDebug() << "Events poll interval:" << eventsInterval << "ms";
 
 	// Register QML types
 	qmlRegisterType<WindowSettings>("WalletModule", 1, 0, "WindowSettings");
 
 	// Register context properties
 	engine.rootContext()->setContextProperty("NodeJS", nodeJS);
+	engine.rootContext()->setContextProperty("BatteryMonitor", batteryMonitor);
+	engine.rootContext()->setContextProperty("WifiMonitor", wifiMonitor);
+	engine.rootContext()->setContextProperty("AudioMixer", audioMixer);
 	engine.rootContext()->setContextProperty("applicationName", app.applicationName());
 	engine.rootContext()->setContextProperty("applicationVersion", app.applicationVersion());
 	engine.rootContext()->setContextProperty("wifiStrengthUpdateInterval", wifiInterval);
 	engine.rootContext()->setContextProperty("batteryStatusUpdateInterval", batteryInterval);
-	engine.rootContext()->setContextProperty("eventsPollInterval", eventsInterval);
 
 	// Set HOT flag based on hot reload compilation
 #if defined(ENABLE_HOT_RELOAD) || defined(ENABLE_FELGO_LIVE)
@@ -0,0 +1,843 @@
+#ifdef ENABLE_NODEJS
+
+#include "include/native_crypto.h"
+#include "include/v8_json.h"
+
+#include <QStringList>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <vector>
+
+// The 128-bit products below need a 64-bit target (x86-64, aarch64)
+typedef unsigned __int128 u128;
+
+bool NativeCrypto::enabled() {
+	return qEnvironmentVariable("NODE_NATIVE_CRYPTO") != QLatin1String("0");
+}
+
+static inline quint64 rotl64(quint64 x, int n) {
+	return (x << n) | (x >> (64 - n));
+}
+
+static inline quint64 rotr64(quint64 x, int n) {
+	return (x >> n) | (x << (64 - n));
+}
+
+// ---- keccak-256 ----
+
+static const quint64 kKeccakRoundConstants[24] = {
+	0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+	0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+	0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+	0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+static const int kKeccakRho[24] = {1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44};
+static const int kKeccakPi[24] = {10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1};
+// keccak-256: 1088-bit rate, 512-bit capacity
+static const int kKeccakRate = 136;
+
+static void keccakF1600(quint64 state[25]) {
+	static const int kNext[5] = {1, 2, 3, 4, 0};
+	static const int kPrevious[5] = {4, 0, 1, 2, 3};
+	quint64 c[5];
+	for (int round = 0; round < 24; round++) {
+		for (int x = 0; x < 5; x++) c[x] = state[x] ^ state[x + 5] ^ state[x + 10] ^ state[x + 15] ^ state[x + 20];
+		for (int x = 0; x < 5; x++) {
+			const quint64 d = c[kPrevious[x]] ^ rotl64(c[kNext[x]], 1);
+			state[x] ^= d;
+			state[x + 5] ^= d;
+			state[x + 10] ^= d;
+			state[x + 15] ^= d;
+			state[x + 20] ^= d;
+		}
+		quint64 lane = state[1];
+		for (int i = 0; i < 24; i++) {
+			const int j = kKeccakPi[i];
+			const quint64 next = state[j];
+			state[j] = rotl64(lane, kKeccakRho[i]);
+			lane = next;
+		}
+		for (int y = 0; y < 25; y += 5) {
+			const quint64 a0 = state[y], a1 = state[y + 1], a2 = state[y + 2], a3 = state[y + 3], a4 = state[y + 4];
+			state[y] = a0 ^ (~a1 & a2);
+			state[y + 1] = a1 ^ (~a2 & a3);
+			state[y + 2] = a2 ^ (~a3 & a4);
+			state[y + 3] = a3 ^ (~a4 & a0);
+			state[y + 4] = a4 ^ (~a0 & a1);
+		}
+		state[0] ^= kKeccakRoundConstants[round];
+	}
+}
+
+static inline quint64 loadLe64(const uchar *p) {
+	quint64 value = 0;
+	for (int i = 7; i >= 0; i--) value = (value << 8) | p[i];
+	return value;
+}
+
+static inline quint64 loadBe64(const uchar *p) {
+	quint64 value = 0;
+	for (int i = 0; i < 8; i++) value = (value << 8) | p[i];
+	return value;
+}
+
+static inline void storeBe64(uchar *p, quint64 value) {
+	for (int i = 7; i >= 0; i--) {
+		p[i] = uchar(value);
+		value >>= 8;
+	}
+}
+
+// Original Keccak padding (0x01), as used by Ethereum, not the SHA-3 one (0x06)
+static void keccak256(const uchar *data, size_t size, uchar out[32]) {
+	quint64 state[25] = {};
+	while (size >= size_t(kKeccakRate)) {
+		for (int i = 0; i < kKeccakRate / 8; i++) state[i] ^= loadLe64(data + i * 8);
+		keccakF1600(state);
+		data += kKeccakRate;
+		size -= kKeccakRate;
+	}
+	uchar block[kKeccakRate] = {};
+	std::memcpy(block, data, size);
+	block[size] ^= 0x01;
+	block[kKeccakRate - 1] ^= 0x80;
+	for (int i = 0; i < kKeccakRate / 8; i++) state[i] ^= loadLe64(block + i * 8);
+	keccakF1600(state);
+	for (int i = 0; i < 4; i++) {
+		for (int b = 0; b < 8; b++) out[i * 8 + b] = uchar(state[i] >> (8 * b));
+	}
+}
+
+// ---- SHA-512, HMAC, PBKDF2 ----
+
+static const quint64 kSha512RoundConstants[80] = {
+	0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL, 0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+	0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+	0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+	0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL, 0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+	0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+	0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL, 0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+	0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+	0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL,
+};
+
+class Sha512 {
+public:
+	static const int kBlockSize = 128;
+	static const int kDigestSize = 64;
+
+	Sha512() : m_state{0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL, 0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL}, m_length(0), m_used(0) {}
+
+	void update(const uchar *data, size_t size) {
+		m_length += size;
+		if (m_used > 0) {
+			const size_t take = qMin(size, size_t(kBlockSize) - m_used);
+			std::memcpy(m_buffer + m_used, data, take);
+			m_used += take;
+			data += take;
+			size -= take;
+			if (m_used < size_t(kBlockSize)) return;
+			compress(m_buffer);
+			m_used = 0;
+		}
+		while (size >= size_t(kBlockSize)) {
+			compress(data);
+			data += kBlockSize;
+			size -= kBlockSize;
+		}
+		std::memcpy(m_buffer, data, size);
+		m_used = size;
+	}
+
+	void finish(uchar out[kDigestSize]) {
+		const quint64 bits = m_length * 8;
+		m_buffer[m_used++] = 0x80;
+		if (m_used > size_t(kBlockSize) - 16) {
+			std::memset(m_buffer + m_used, 0, kBlockSize - m_used);
+			compress(m_buffer);
+			m_used = 0;
+		}
+		// 128-bit length; messages here never reach 2^64 bits
+		std::memset(m_buffer + m_used, 0, kBlockSize - 8 - m_used);
+		storeBe64(m_buffer + kBlockSize - 8, bits);
+		compress(m_buffer);
+		for (int i = 0; i < 8; i++) storeBe64(out + i * 8, m_state[i]);
+	}
+
+private:
+	void compress(const uchar *block) {
+		quint64 w[80];
+		for (int i = 0; i < 16; i++) w[i] = loadBe64(block + i * 8);
+		for (int i = 16; i < 80; i++) {
+			const quint64 s0 = rotr64(w[i - 15], 1) ^ rotr64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+			const quint64 s1 = rotr64(w[i - 2], 19) ^ rotr64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+		quint64 a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+		quint64 e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+		for (int i = 0; i < 80; i++) {
+			const quint64 t1 = h + (rotr64(e, 14) ^ rotr64(e, 18) ^ rotr64(e, 41)) + ((e & f) ^ (~e & g)) + kSha512RoundConstants[i] + w[i];
+			const quint64 t2 = (rotr64(a, 28) ^ rotr64(a, 34) ^ rotr64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+		m_state[0] += a;
+		m_state[1] += b;
+		m_state[2] += c;
+		m_state[3] += d;
+		m_state[4] += e;
+		m_state[5] += f;
+		m_state[6] += g;
+		m_state[7] += h;
+	}
+
+	quint64 m_state[8];
+	quint64 m_length;
+	size_t m_used;
+	uchar m_buffer[kBlockSize];
+};
+
+// HMAC-SHA512 with the key schedule done once; PBKDF2 reuses it for every round
+class HmacSha512 {
+public:
+	HmacSha512(const uchar *key, size_t keySize) {
+		uchar block[Sha512::kBlockSize] = {};
+		if (keySize > size_t(Sha512::kBlockSize)) {
+			Sha512 hash;
+			hash.update(key, keySize);
+			hash.finish(block);
+		} else {
+			std::memcpy(block, key, keySize);
+		}
+		uchar pad[Sha512::kBlockSize];
+		for (int i = 0; i < Sha512::kBlockSize; i++) pad[i] = block[i] ^ 0x36;
+		m_inner.update(pad, sizeof(pad));
+		for (int i = 0; i < Sha512::kBlockSize; i++) pad[i] = block[i] ^ 0x5c;
+		m_outer.update(pad, sizeof(pad));
+	}
+
+	void compute(const uchar *data, size_t size, uchar out[Sha512::kDigestSize], const uchar *more = nullptr, size_t moreSize = 0) const {
+		Sha512 inner = m_inner;
+		inner.update(data, size);
+		if (more) inner.update(more, moreSize);
+		uchar digest[Sha512::kDigestSize];
+		inner.finish(digest);
+		Sha512 outer = m_outer;
+		outer.update(digest, sizeof(digest));
+		outer.finish(out);
+	}
+
+private:
+	Sha512 m_inner;
+	Sha512 m_outer;
+};
+
+static const uchar *bytes(const QByteArray &data) {
+	return reinterpret_cast<const uchar *>(data.constData());
+}
+
+static uchar *bytes(QByteArray &data) {
+	return reinterpret_cast<uchar *>(data.data());
+}
+
+QByteArray NativeCrypto::keccak256(const QByteArray &data) {
+	QByteArray out(32, Qt::Uninitialized);
+	::keccak256(bytes(data), size_t(data.size()), bytes(out));
+	return out;
+}
+
+QByteArray NativeCrypto::sha512(const QByteArray &data) {
+	QByteArray out(Sha512::kDigestSize, Qt::Uninitialized);
+	Sha512 hash;
+	hash.update(bytes(data), size_t(data.size()));
+	hash.finish(bytes(out));
+	return out;
+}
+
+QByteArray NativeCrypto::hmacSha512(const QByteArray &key, const QByteArray &data) {
+	QByteArray out(Sha512::kDigestSize, Qt::Uninitialized);
+	HmacSha512(bytes(key), size_t(key.size())).compute(bytes(data), size_t(data.size()), bytes(out));
+	return out;
+}
+
+QByteArray NativeCrypto::pbkdf2Sha512(const QByteArray &password, const QByteArray &salt, int iterations, int length) {
+	const HmacSha512 hmac(bytes(password), size_t(password.size()));
+	QByteArray out;
+	out.reserve(length);
+	for (quint32 blockIndex = 1; out.size() < length; blockIndex++) {
+		const uchar counter[4] = {uchar(blockIndex >> 24), uchar(blockIndex >> 16), uchar(blockIndex >> 8), uchar(blockIndex)};
+		uchar u[Sha512::kDigestSize];
+		uchar t[Sha512::kDigestSize];
+		hmac.compute(bytes(salt), size_t(salt.size()), u, counter, sizeof(counter));
+		std::memcpy(t, u, sizeof(t));
+		for (int i = 1; i < iterations; i++) {
+			hmac.compute(u, sizeof(u), u);
+			for (int b = 0; b < Sha512::kDigestSize; b++) t[b] ^= u[b];
+		}
+		out.append(reinterpret_cast<const char *>(t), qMin<qsizetype>(Sha512::kDigestSize, length - out.size()));
+	}
+	return out;
+}
+
+QByteArray NativeCrypto::mnemonicToSeed(const QString &phrase, const QString &passphrase) {
+	const QByteArray password = phrase.normalized(QString::NormalizationForm_KD).toUtf8();
+	const QByteArray salt = (QStringLiteral("mnemonic") + passphrase).normalized(QString::NormalizationForm_KD).toUtf8();
+	return pbkdf2Sha512(password, salt, 2048, 64);
+}
+
+// ---- secp256k1 ----
+//
+// 256-bit numbers are four little-endian 64-bit limbs. Field elements are kept fully
+// reduced (< p) after every operation.
+
+struct U256 {
+	quint64 v[4];
+};
+
+// p = 2^256 - 2^32 - 977
+static const U256 kFieldPrime = {{0xFFFFFFFEFFFFFC2FULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL}};
+// 2^256 mod p
+static const quint64 kFieldFold = 0x1000003D1ULL;
+// Group order
+static const U256 kCurveOrder = {{0xBFD25E8CD0364141ULL, 0xBAAEDCE6AF48A03BULL, 0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL}};
+static const U256 kGeneratorX = {{0x59F2815B16F81798ULL, 0x029BFCDB2DCE28D9ULL, 0x55A06295CE870B07ULL, 0x79BE667EF9DCBBACULL}};
+static const U256 kGeneratorY = {{0x9C47D08FFB10D4B8ULL, 0xFD17B448A6855419ULL, 0x5DA4FBFC0E1108A8ULL, 0x483ADA7726A3C465ULL}};
+// 3 * b for y^2 = x^3 + 7
+static const U256 kCurveB3 = {{21, 0, 0, 0}};
+static const U256 kOne = {{1, 0, 0, 0}};
+static const U256 kZero = {{0, 0, 0, 0}};
+
+static U256 fromBigEndian(const uchar *p) {
+	return U256{{loadBe64(p + 24), loadBe64(p + 16), loadBe64(p + 8), loadBe64(p)}};
+}
+
+static void toBigEndian(const U256 &a, uchar *p) {
+	for (int i = 0; i < 4; i++) storeBe64(p + 24 - i * 8, a.v[i]);
+}
+
+// r = a - b, returns the borrow
+static quint64 subtract(U256 &r, const U256 &a, const U256 &b) {
+	quint64 borrow = 0;
+	for (int i = 0; i < 4; i++) {
+		const u128 d = u128(a.v[i]) - b.v[i] - borrow;
+		r.v[i] = quint64(d);
+		borrow = quint64(d >> 64) & 1;
+	}
+	return borrow;
+}
+
+// a if mask is 0, b if mask is all ones
+static void select(U256 &r, const U256 &a, const U256 &b, quint64 mask) {
+	for (int i = 0; i < 4; i++) r.v[i] = (a.v[i] & ~mask) | (b.v[i] & mask);
+}
+
+static bool isZero(const U256 &a) {
+	return (a.v[0] | a.v[1] | a.v[2] | a.v[3]) == 0;
+}
+
+// a < p * 2 -> a mod p
+static void fieldReduceOnce(U256 &a) {
+	U256 reduced;
+	const quint64 borrow = subtract(reduced, a, kFieldPrime);
+	select(a, reduced, a, 0 - borrow);
+}
+
+static void fieldAdd(U256 &r, const U256 &a, const U256 &b) {
+	u128 carry = 0;
+	for (int i = 0; i < 4; i++) {
+		carry += u128(a.v[i]) + b.v[i];
+		r.v[i] = quint64(carry);
+		carry >>= 64;
+	}
+	// A carry out is 2^256, congruent to kFieldFold
+	carry *= kFieldFold;
+	for (int i = 0; i < 4; i++) {
+		carry += r.v[i];
+		r.v[i] = quint64(carry);
+		carry >>= 64;
+	}
+	fieldReduceOnce(r);
+}
+
+static void fieldSub(U256 &r, const U256 &a, const U256 &b) {
+	const quint64 mask = 0 - subtract(r, a, b);
+	u128 carry = 0;
+	for (int i = 0; i < 4; i++) {
+		carry += u128(r.v[i]) + (kFieldPrime.v[i] & mask);
+		r.v[i] = quint64(carry);
+		carry >>= 64;
+	}
+}
+
+static void fieldMul(U256 &r, const U256 &a, const U256 &b) {
+	quint64 wide[8] = {};
+	for (int i = 0; i < 4; i++) {
+		u128 carry = 0;
+		for (int j = 0; j < 4; j++) {
+			carry += u128(a.v[i]) * b.v[j] + wide[i + j];
+			wide[i + j] = quint64(carry);
+			carry >>= 64;
+		}
+		wide[i + 4] = quint64(carry);
+	}
+	// Fold the high half down twice: hi * 2^256 = hi * kFieldFold (mod p)
+	quint64 folded[4];
+	u128 carry = 0;
+	for (int i = 0; i < 4; i++) {
+		carry += u128(wide[i]) + u128(wide[i + 4]) * kFieldFold;
+		folded[i] = quint64(carry);
+		carry >>= 64;
+	}
+	carry *= kFieldFold;
+	for (int i = 0; i < 4; i++) {
+		carry += folded[i];
+		r.v[i] = quint64(carry);
+		carry >>= 64;
+	}
+	carry *= kFieldFold;
+	for (int i = 0; i < 4; i++) {
+		carry += r.v[i];
+		r.v[i] = quint64(carry);
+		carry >>= 64;
+	}
+	fieldReduceOnce(r);
+}
+
+// a^(p-2); the exponent is public, so branching on its bits is fine
+static U256 fieldInvert(const U256 &a) {
+	U256 exponent;
+	subtract(exponent, kFieldPrime, U256{{2, 0, 0, 0}});
+	U256 result = kOne;
+	for (int bit = 255; bit >= 0; bit--) {
+		fieldMul(result, result, result);
+		if ((exponent.v[bit / 64] >> (bit % 64)) & 1) fieldMul(result, result, a);
+	}
+	return result;
+}
+
+// Projective coordinates (X : Y : Z), x = X/Z, y = Y/Z; the identity is (0 : 1 : 0)
+struct Point {
+	U256 x, y, z;
+};
+
+static const Point kIdentity = {kZero, kOne, kZero};
+static const Point kGenerator = {kGeneratorX, kGeneratorY, kOne};
+
+// Complete addition for a = 0 curves (Renes, Costello, Batina 2015, algorithm 7): no
+// special cases for doubling or the identity, so it runs the same for every input
+static Point pointAdd(const Point &p, const Point &q) {
+	U256 t0, t1, t2, t3, t4, x3, y3, z3;
+	fieldMul(t0, p.x, q.x);
+	fieldMul(t1, p.y, q.y);
+	fieldMul(t2, p.z, q.z);
+	fieldAdd(t3, p.x, p.y);
+	fieldAdd(t4, q.x, q.y);
+	fieldMul(t3, t3, t4);
+	fieldAdd(t4, t0, t1);
+	fieldSub(t3, t3, t4);
+	fieldAdd(t4, p.y, p.z);
+	fieldAdd(x3, q.y, q.z);
+	fieldMul(t4, t4, x3);
+	fieldAdd(x3, t1, t2);
+	fieldSub(t4, t4, x3);
+	fieldAdd(x3, p.x, p.z);
+	fieldAdd(y3, q.x, q.z);
+	fieldMul(x3, x3, y3);
+	fieldAdd(y3, t0, t2);
+	fieldSub(y3, x3, y3);
+	fieldAdd(x3, t0, t0);
+	fieldAdd(t0, x3, t0);
+	fieldMul(t2, kCurveB3, t2);
+	fieldAdd(z3, t1, t2);
+	fieldSub(t1, t1, t2);
+	fieldMul(y3, kCurveB3, y3);
+	fieldMul(x3, t4, y3);
+	fieldMul(t2, t3, t1);
+	fieldSub(x3, t2, x3);
+	fieldMul(y3, y3, t0);
+	fieldMul(t1, t1, z3);
+	fieldAdd(y3, t1, y3);
+	fieldMul(t0, t0, t3);
+	fieldMul(z3, z3, t4);
+	fieldAdd(z3, z3, t0);
+	return Point{x3, y3, z3};
+}
+
+// 0..15 times the generator, for the 4-bit window
+static const std::array<Point, 16> &generatorTable() {
+	static const std::array<Point, 16> table = []() {
+		std::array<Point, 16> multiples;
+		multiples[0] = kIdentity;
+		for (int i = 1; i < 16; i++) multiples[i] = pointAdd(multiples[i - 1], kGenerator);
+		return multiples;
+	}();
+	return table;
+}
+
+// k * G. Every window reads the whole table, so memory access does not depend on k either.
+static Point multiplyGenerator(const U256 &k) {
+	const std::array<Point, 16> &table = generatorTable();
+	Point result = kIdentity;
+	for (int window = 63; window >= 0; window--) {
+		for (int i = 0; i < 4; i++) result = pointAdd(result, result);
+		const quint64 digit = (k.v[window / 16] >> ((window % 16) * 4)) & 0xF;
+		Point addend = kIdentity;
+		for (quint64 i = 0; i < 16; i++) {
+			const quint64 mask = 0 - quint64(i == digit);
+			select(addend.x, addend.x, table[i].x, mask);
+			select(addend.y, addend.y, table[i].y, mask);
+			select(addend.z, addend.z, table[i].z, mask);
+		}
+		result = pointAdd(result, addend);
+	}
+	return result;
+}
+
+static bool isValidPrivateKey(const U256 &k) {
+	U256 unused;
+	return !isZero(k) && subtract(unused, k, kCurveOrder) == 1;
+}
+
+// (a + b) mod n, both already below n
+static U256 scalarAdd(const U256 &a, const U256 &b) {
+	U256 sum;
+	u128 carry = 0;
+	for (int i = 0; i < 4; i++) {
+		carry += u128(a.v[i]) + b.v[i];
+		sum.v[i] = quint64(carry);
+		carry >>= 64;
+	}
+	U256 reduced;
+	const quint64 borrow = subtract(reduced, sum, kCurveOrder);
+	// Take the reduced value when the sum overflowed 2^256 or is at least n
+	const quint64 useReduced = quint64(carry) | (borrow ^ 1);
+	U256 result;
+	select(result, sum, reduced, 0 - useReduced);
+	return result;
+}
+
+// Serialized public key; privateKey must be valid
+static QByteArray publicKeyBytes(const U256 &privateKey, bool compressed) {
+	const Point point = multiplyGenerator(privateKey);
+	const U256 zInverse = fieldInvert(point.z);
+	U256 x, y;
+	fieldMul(x, point.x, zInverse);
+	fieldMul(y, point.y, zInverse);
+
+	QByteArray out(compressed ? 33 : 65, Qt::Uninitialized);
+	uchar *p = bytes(out);
+	if (compressed) {
+		p[0] = uchar(0x02 | (y.v[0] & 1));
+		toBigEndian(x, p + 1);
+	} else {
+		p[0] = 0x04;
+		toBigEndian(x, p + 1);
+		toBigEndian(y, p + 33);
+	}
+	return out;
+}
+
+QByteArray NativeCrypto::publicKey(const QByteArray &privateKey, bool compressed) {
+	if (privateKey.size() != 32) return QByteArray();
+	const U256 k = fromBigEndian(bytes(privateKey));
+	if (!isValidPrivateKey(k)) return QByteArray();
+	return publicKeyBytes(k, compressed);
+}
+
+// ---- addresses ----
+
+static QString checksummed(const QByteArray &lowerHex) {
+	uchar hash[32];
+	::keccak256(bytes(lowerHex), size_t(lowerHex.size()), hash);
+	QString out = QStringLiteral("0x");
+	out.reserve(42);
+	for (int i = 0; i < 40; i++) {
+		const char c = lowerHex.at(i);
+		const int nibble = (i % 2 == 0) ? hash[i / 2] >> 4 : hash[i / 2] & 0x0F;
+		out.append(QLatin1Char(c >= 'a' && nibble >= 8 ? char(c - 'a' + 'A') : c));
+	}
+	return out;
+}
+
+QString NativeCrypto::address(const QByteArray &publicKey) {
+	if (publicKey.size() != 65 || publicKey.at(0) != 0x04) return QString();
+	uchar hash[32];
+	::keccak256(bytes(publicKey) + 1, 64, hash);
+	return checksummed(QByteArray(reinterpret_cast<const char *>(hash) + 12, 20).toHex());
+}
+
+QByteArray NativeCrypto::parsePrivateKey(const QString &text) {
+	// ethers' Wallet adds a missing 0x itself, so bare keys have always been accepted
+	const QString hex = text.startsWith(QLatin1String("0x")) ? text.mid(2) : text;
+	if (hex.size() != 64) return QByteArray();
+	for (const QChar c : hex) {
+		if (c.unicode() > 0x7f || !isxdigit(c.toLatin1())) return QByteArray();
+	}
+	const QByteArray privateKey = QByteArray::fromHex(hex.toLatin1());
+	return publicKey(privateKey).isEmpty() ? QByteArray() : privateKey;
+}
+
+QString NativeCrypto::checksumAddress(const QString &address) {
+	const QString digits = address.startsWith(QLatin1String("0x")) ? address.mid(2) : address;
+	if (digits.size() != 40) return QString();
+	bool hasUpper = false;
+	bool hasLower = false;
+	for (const QChar c : digits) {
+		const char16_t u = c.unicode();
+		if (u >= 'A' && u <= 'F') hasUpper = true;
+		else if (u >= 'a' && u <= 'f') hasLower = true;
+		else if (u < '0' || u > '9') return QString();
+	}
+	const QString result = checksummed(digits.toLower().toLatin1());
+	// Mixed case claims to be checksummed, so it has to be right
+	if (hasUpper && hasLower && result.mid(2) != digits) return QString();
+	return result;
+}
+
+// ---- BIP-32 ----
+
+static const quint32 kHardened = 0x80000000U;
+
+static bool parsePath(const QString &path, QList<quint32> *indexes) {
+	const QStringList parts = path.split(QLatin1Char('/'));
+	if (parts.isEmpty() || parts.first() != QLatin1String("m")) return false;
+	for (qsizetype i = 1; i < parts.size(); i++) {
+		QString part = parts.at(i);
+		quint32 flag = 0;
+		if (part.endsWith(QLatin1Char('\'')) || part.endsWith(QLatin1Char('h'))) {
+			flag = kHardened;
+			part.chop(1);
+		}
+		bool ok = false;
+		const uint index = part.toUInt(&ok);
+		if (!ok || part.isEmpty() || !part.at(0).isDigit() || index >= kHardened) return false;
+		indexes->append(index | flag);
+	}
+	return true;
+}
+
+QByteArray NativeCrypto::deriveKey(const QByteArray &seed, const QString &path, QString *error) {
+	QList<quint32> indexes;
+	if (!parsePath(path, &indexes)) {
+		if (error) *error = QString("Invalid derivation path: %1").arg(path);
+		return QByteArray();
+	}
+	if (seed.size() < 16 || seed.size() > 64) {
+		if (error) *error = QStringLiteral("Invalid seed length");
+		return QByteArray();
+	}
+
+	uchar node[Sha512::kDigestSize];
+	static const char kMasterKey[] = "Bitcoin seed";
+	HmacSha512(reinterpret_cast<const uchar *>(kMasterKey), sizeof(kMasterKey) - 1).compute(bytes(seed), size_t(seed.size()), node);
+	U256 key = fromBigEndian(node);
+	bool valid = isValidPrivateKey(key);
+
+	for (qsizetype i = 0; valid && i < indexes.size(); i++) {
+		const quint32 index = indexes.at(i);
+		// 0x00 || key for hardened children, the compressed public key otherwise; then the index
+		uchar data[37];
+		if (index & kHardened) {
+			data[0] = 0;
+			toBigEndian(key, data + 1);
+		} else {
+			std::memcpy(data, publicKeyBytes(key, true).constData(), 33);
+		}
+		data[33] = uchar(index >> 24);
+		data[34] = uchar(index >> 16);
+		data[35] = uchar(index >> 8);
+		data[36] = uchar(index);
+		HmacSha512(node + 32, 32).compute(data, sizeof(data), node);
+		std::memset(data, 0, sizeof(data));
+
+		const U256 tweak = fromBigEndian(node);
+		valid = isValidPrivateKey(tweak);
+		key = scalarAdd(key, tweak);
+		valid = valid && !isZero(key);
+	}
+	std::memset(node, 0, sizeof(node));
+	if (!valid) {
+		// Odds are below 2^-127 per step; BIP-32 says to move on to the next index
+		if (error) *error = QString("Derivation along %1 gives an invalid key").arg(path);
+		return QByteArray();
+	}
+
+	QByteArray out(32, Qt::Uninitialized);
+	toBigEndian(key, bytes(out));
+	return out;
+}
+
+// ---- JS binding ----
+
+static void throwError(v8::Isolate *isolate, const QString &message) {
+	isolate->ThrowException(v8::Exception::Error(V8Json::toV8(isolate, message)));
+}
+
+static QString hexString(const QByteArray &data) {
+	return QStringLiteral("0x") + QString::fromLatin1(data.toHex());
+}
+
+// Strings are taken as UTF-8 text (like ethers.toUtf8Bytes), typed arrays and buffers as bytes
+static bool inputBytes(v8::Isolate *isolate, v8::Local<v8::Value> value, QByteArray *out) {
+	if (value->IsString()) {
+		const v8::Local<v8::String> string = value.As<v8::String>();
+		const int length = string->Utf8Length(isolate);
+		out->resize(length);
+		string->WriteUtf8(isolate, out->data(), length, nullptr, v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+		return true;
+	}
+	if (value->IsArrayBufferView()) {
+		const v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+		out->resize(qsizetype(view->ByteLength()));
+		view->CopyContents(out->data(), view->ByteLength());
+		return true;
+	}
+	if (value->IsArrayBuffer()) {
+		const std::shared_ptr<v8::BackingStore> store = value.As<v8::ArrayBuffer>()->GetBackingStore();
+		*out = QByteArray(static_cast<const char *>(store->Data()), qsizetype(store->ByteLength()));
+		return true;
+	}
+	return false;
+}
+
+static QString stringArgument(v8::Isolate *isolate, const v8::FunctionCallbackInfo<v8::Value> &args, int index) {
+	if (args.Length() <= index || !args[index]->IsString()) return QString();
+	return V8Json::toQString(isolate, args[index].As<v8::String>());
+}
+
+static void setString(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Object> object, const char *key, const QString &value) {
+	object->CreateDataProperty(context, v8::String::NewFromUtf8(isolate, key).ToLocalChecked(), V8Json::toV8(isolate, value)).Check();
+}
+
+// {privateKey, publicKey, address}, like the matching fields of an ethers Wallet
+static v8::Local<v8::Object> walletObject(v8::Isolate *isolate, v8::Local<v8::Context> context, const QByteArray &privateKey) {
+	const QByteArray publicKey = NativeCrypto::publicKey(privateKey);
+	v8::Local<v8::Object> wallet = v8::Object::New(isolate);
+	setString(isolate, context, wallet, "privateKey", hexString(privateKey));
+	setString(isolate, context, wallet, "publicKey", hexString(publicKey));
+	setString(isolate, context, wallet, "address", NativeCrypto::address(publicKey));
+	return wallet;
+}
+
+// keccak256(data) -> '0x...'
+static void jsKeccak256(const v8::FunctionCallbackInfo<v8::Value> &args) {
+	v8::Isolate *isolate = args.GetIsolate();
+	QByteArray data;
+	if (args.Length() < 1 || !inputBytes(isolate, args[0], &data)) {
+		throwError(isolate, QStringLiteral("keccak256: expected a string or bytes"));
+		return;
+	}
+	args.GetReturnValue().Set(V8Json::toV8(isolate, hexString(NativeCrypto::keccak256(data))));
+}
+
+// keccak256Batch([data, ...]) -> ['0x...', ...], one call into C++ for the whole list
+static void jsKeccak256Batch(const v8::FunctionCallbackInfo<v8::Value> &args) {
+	v8::Isolate *isolate = args.GetIsolate();
+	if (args.Length() < 1 || !args[0]->IsArray()) {
+		throwError(isolate, QStringLiteral("keccak256Batch: expected an array"));
+		return;
+	}
+	v8::Local<v8::Context> context = isolate->GetCurrentContext();
+	v8::Local<v8::Array> inputs = args[0].As<v8::Array>();
+	const uint32_t count = inputs->Length();
+	std::vector<v8::Local<v8::Value>> hashes;
+	hashes.reserve(count);
+	QByteArray data;
+	uchar hash[32];
+	char hex[66] = {'0', 'x'};
+	static const char kHexDigits[] = "0123456789abcdef";
+	for (uint32_t i = 0; i < count; i++) {
+		v8::Local<v8::Value> input;
+		if (!inputs->Get(context, i).ToLocal(&input)) return;
+		if (!inputBytes(isolate, input, &data)) {
+			throwError(isolate, QString("keccak256Batch: item %1 is not a string or bytes").arg(i));
+			return;
+		}
+		::keccak256(bytes(data), size_t(data.size()), hash);
+		for (int b = 0; b < 32; b++) {
+			hex[2 + b * 2] = kHexDigits[hash[b] >> 4];
+			hex[3 + b * 2] = kHexDigits[hash[b] & 0x0F];
+		}
+		hashes.push_back(v8::String::NewFromOneByte(isolate, reinterpret_cast<const uint8_t *>(hex), v8::NewStringType::kNormal, sizeof(hex)).ToLocalChecked());
+	}
+	args.GetReturnValue().Set(v8::Array::New(isolate, hashes.data(), hashes.size()));
+}
+
+// checksumAddress(address) -> EIP-55 address, or null when it is not a valid hex address
+static void jsChecksumAddress(const v8::FunctionCallbackInfo<v8::Value> &args) {
+	v8::Isolate *isolate = args.GetIsolate();
+	const QString address = NativeCrypto::checksumAddress(stringArgument(isolate, args, 0));
+	if (address.isEmpty()) args.GetReturnValue().SetNull();
+	else args.GetReturnValue().Set(V8Json::toV8(isolate, address));
+}
+
+// mnemonicToSeed(phrase, passphrase = '') -> '0x...' (64 bytes)
+static void jsMnemonicToSeed(const v8::FunctionCallbackInfo<v8::Value> &args) {
+	v8::Isolate *isolate = args.GetIsolate();
+	if (args.Length() < 1 || !args[0]->IsString()) {
+		throwError(isolate, QStringLiteral("mnemonicToSeed: expected a phrase"));
+		return;
+	}
+	const QByteArray seed = NativeCrypto::mnemonicToSeed(stringArgument(isolate, args, 0), stringArgument(isolate, args, 1));
+	args.GetReturnValue().Set(V8Json::toV8(isolate, hexString(seed)));
+}
+
+// walletFromMnemonic(phrase, path = "m/44'/60'/0'/0/0", passphrase = '') -> {privateKey, publicKey, address}
+static void jsWalletFromMnemonic(const v8::FunctionCallbackInfo<v8::Value> &args) {
+	v8::Isolate *isolate = args.GetIsolate();
+	if (args.Length() < 1 || !args[0]->IsString()) {
+		throwError(isolate, QStringLiteral("walletFromMnemonic: expected a phrase"));
+		return;
+	}
+	QString path = stringArgument(isolate, args, 1);
+	if (path.isEmpty()) path = QLatin1String(NativeCrypto::kDefaultPath);
+	const QByteArray seed = NativeCrypto::mnemonicToSeed(stringArgument(isolate, args, 0), stringArgument(isolate, args, 2));
+	QString error;
+	const QByteArray privateKey = NativeCrypto::deriveKey(seed, path, &error);
+	if (privateKey.isEmpty()) {
+		throwError(isolate, error);
+		return;
+	}
+	args.GetReturnValue().Set(walletObject(isolate, isolate->GetCurrentContext(), privateKey));
+}
+
+// walletFromPrivateKey(64 hex digits, '0x' optional) -> {privateKey, publicKey, address}
+static void jsWalletFromPrivateKey(const v8::FunctionCallbackInfo<v8::Value> &args) {
+	v8::Isolate *isolate = args.GetIsolate();
+	const QByteArray privateKey = NativeCrypto::parsePrivateKey(stringArgument(isolate, args, 0));
+	if (privateKey.isEmpty()) {
+		throwError(isolate, QStringLiteral("invalid private key"));
+		return;
+	}
+	args.GetReturnValue().Set(walletObject(isolate, isolate->GetCurrentContext(), privateKey));
+}
+
+v8::Local<v8::Object> NativeCrypto::createBinding(v8::Isolate *isolate, v8::Local<v8::Context> context) {
+	static const struct {
+		const char *name;
+		v8::FunctionCallback callback;
+	} kFunctions[] = {
+		{"keccak256", jsKeccak256},
+		{"keccak256Batch", jsKeccak256Batch},
+		{"checksumAddress", jsChecksumAddress},
+		{"mnemonicToSeed", jsMnemonicToSeed},
+		{"walletFromMnemonic", jsWalletFromMnemonic},
+		{"walletFromPrivateKey", jsWalletFromPrivateKey},
+	};
+	v8::Local<v8::Object> binding = v8::Object::New(isolate);
+	for (const auto &function : kFunctions) {
+		binding->CreateDataProperty(context, v8::String::NewFromUtf8(isolate, function.name).ToLocalChecked(), v8::Function::New(context, function.callback).ToLocalChecked()).Check();
+	}
+	return binding;
+}
+
+#endif // ENABLE_NODEJS
@@ -0,0 +1,71 @@
+#include "include/native_handlers.h"
+
+#include "include/bridge_metrics.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+
+// sysfs reads are quick but may block on a slow driver; two threads keep one stuck
+// read from holding up the others without competing with the Node thread for cores
+static const int kNativeHandlerThreads = 2;
+
+NativeHandlerRegistry::NativeHandlerRegistry() {
+	m_pool.setMaxThreadCount(kNativeHandlerThreads);
+	m_pool.setObjectName("NativeHandlers");
+}
+
+NativeHandlerRegistry::~NativeHandlerRegistry() {
+	waitForDone();
+}
+
+void NativeHandlerRegistry::registerHandler(const QString &action, Handler handler) {
+	QWriteLocker locker(&m_lock);
+	m_handlers.insert(action, std::move(handler));
+}
+
+void NativeHandlerRegistry::setEnabled(bool enabled) {
+	QWriteLocker locker(&m_lock);
+	m_enabled = enabled;
+}
+
+bool NativeHandlerRegistry::contains(const QString &action) const {
+	QReadLocker locker(&m_lock);
+	return m_enabled && m_handlers.contains(action);
+}
+
+QStringList NativeHandlerRegistry::actions() const {
+	QReadLocker locker(&m_lock);
+	QStringList names = m_handlers.keys();
+	names.sort();
+	return names;
+}
+
+bool NativeHandlerRegistry::dispatch(const QString &action, const QJsonObject &params, Callback callback) {
+	Handler handler;
+	{
+		QReadLocker locker(&m_lock);
+		if (!m_enabled) return false;
+		handler = m_handlers.value(action);
+	}
+	if (!handler) return false;
+
+	ActionMetrics *metrics = BridgeMetrics::instance().action(action);
+	const qint64 enqueuedUs = BridgeMetrics::nowUs();
+	m_pool.start([handler = std::move(handler), params, callback = std::move(callback), metrics, enqueuedUs]() {
+		const qint64 startedUs = BridgeMetrics::nowUs();
+		const std::optional<QJsonObject> result = handler(params);
+		// Declined requests are counted by Node when they get there
+		if (result) {
+			metrics->count.fetch_add(1, std::memory_order_relaxed);
+			metrics->queue.record(startedUs - enqueuedUs);
+			metrics->native.record(BridgeMetrics::nowUs() - startedUs);
+			if (result->value("status").toString() == QLatin1String("error")) metrics->errors.fetch_add(1, std::memory_order_relaxed);
+		}
+		callback(result);
+	});
+	return true;
+}
+
+void NativeHandlerRegistry::waitForDone() {
+	m_pool.waitForDone();
+}
@@ -2,11 +2,56 @@
 
 #ifdef ENABLE_NODEJS
 
+#include "include/sysfs_handlers.h"
+
 #include <QCoreApplication>
 #include <QDebug>
 #include <QMutexLocker>
+#include <QSaveFile>
+
+// One frame at 60 Hz; results completed within this window share a single delivery
+static const int kCallbackBatchIntervalMs = 16;
+// Snapshot changes within this window are written together
+static const int kSnapshotSaveDelayMs = 5000;
+
+NodeJS::NodeJS(QObject *parent) : QObject(parent), m_initState(InitState::NotInitialized), m_snapshotTimer(new QTimer(this)), m_batchCallbacks(false), m_batchTimer(new QTimer(this)) {
+	m_batchTimer->setSingleShot(true);
+	m_batchTimer->setInterval(kCallbackBatchIntervalMs);
+	connect(m_batchTimer, &QTimer::timeout, this, &NodeJS::flushPendingCallbacks);
 
-NodeJS::NodeJS(QObject *parent) : QObject(parent), m_initState(InitState::NotInitialized) {}
+	// Read-only status actions polled by several components; TTLs stay well below the UI poll intervals
+	m_responseCache.setPolicy("batteryCheckStatus", 2000);
+	m_responseCache.setPolicy("wifiGetCurrentStrength", 2000);
+	m_responseCache.setPolicy("wifiGetConnectionStatus", 2000);
+	m_responseCache.setPolicy("audioGetVolume", 1000);
+	m_responseCache.setPolicy("displayGetBrightness", 1000);
+	m_responseCache.setInvalidation("audioSetVolume", {"audioGetVolume"});
+	m_responseCache.setInvalidation("displaySetBrightness", {"displayGetBrightness"});
+	m_responseCache.setInvalidation("wifiConnectToNetwork", {"wifiGetConnectionStatus", "wifiGetCurrentStrength"});
+	m_responseCache.setInvalidation("wifiDisconnect", {"wifiGetConnectionStatus", "wifiGetCurrentStrength"});
+	m_responseCache.setInvalidation("wifiReinitializeInterface", {"wifiGetConnectionStatus", "wifiGetCurrentStrength"});
+	// NODE_RESPONSE_CACHE=0 sends every request to Node, for comparing load
+	if (qEnvironmentVariable("NODE_RESPONSE_CACHE") == QLatin1String("0")) m_responseCache.setEnabled(false);
+
+	// Pages that would otherwise wait for Node after every boot; their last responses are
+	// shown, marked stale, until the fresh ones arrive. Actions answered natively do not need it.
+	m_snapshot.setPersistent("wifiScanNetworks");
+	m_snapshot.setPersistent("wifiGetConnectionStatus");
+	m_snapshot.setPersistent("wifiGetCurrentStrength");
+	m_snapshot.setPersistent("timeListTimeZones");
+	m_snapshot.setPersistent("cryptoGetBalance");
+	// NODE_RESPONSE_SNAPSHOT=0 waits for Node on every boot, for comparing startup
+	if (qEnvironmentVariable("NODE_RESPONSE_SNAPSHOT") == QLatin1String("0")) m_snapshot.setEnabled(false);
+	m_snapshot.load();
+	m_snapshotWriter.setMaxThreadCount(1);
+	m_snapshotTimer->setSingleShot(true);
+	m_snapshotTimer->setInterval(kSnapshotSaveDelayMs);
+	connect(m_snapshotTimer, &QTimer::timeout, this, [this]() { m_snapshotWriter.start([this]() { m_snapshot.save(); }); });
+
+	registerSysfsHandlers(m_nativeHandlers);
+	// NODE_NATIVE_HANDLERS=0 sends claimed actions to their JS handlers, for comparison
+	if (qEnvironmentVariable("NODE_NATIVE_HANDLERS") == QLatin1String("0")) m_nativeHandlers.setEnabled(false);
+}
 
 NodeJS::~NodeJS() {
 	shutdown();
@@ -28,55 +73,67 @@ bool NodeJS::initialize() {
 
 	// qDebug() << "NodeJS: Initializing with NodeThread";
 
-	m_nodeThread = std::make_unique<NodeThread>(this);
+	auto nodeThread = std::make_unique<NodeThread>(this);
+	for (const QString &type : std::as_const(m_coalescedEventTypes)) nodeThread->setEventCoalescing(type, true);
+	connect(nodeThread.get(), &NodeThread::eventsAvailable, this, &NodeJS::dispatchEvents, Qt::QueuedConnection);
 
-	connect(m_nodeThread.get(), &NodeThread::initializationFailed, this, [this](const QString &error) {
-		qCritical() << "Critical Node.js failure:" << error;
+	connect(nodeThread.get(), &NodeThread::ready, this, [this]() {
+		{
+			QMutexLocker locker(&m_initMutex);
+			if (m_initState != InitState::Initializing) return;
+			m_initState = InitState::Initialized;
+		}
+		emit ready();
+	});
 
-		// Update state and wake up waiting threads
+	connect(nodeThread.get(), &NodeThread::initializationFailed, this, [this](const QString &error) {
+		qCritical() << "Critical Node.js failure:" << error;
 		{
 			QMutexLocker locker(&m_initMutex);
 			m_initState = InitState::Failed;
-			m_initCondition.wakeAll();
 		}
-
 		QCoreApplication::exit(1);
 	});
 
-	if (!m_nodeThread->initialize()) {
+	if (!nodeThread->initialize()) {
 		qWarning() << "NodeJS: Failed to initialize NodeThread";
-
-		// Update state and wake up waiting threads
 		{
 			QMutexLocker locker(&m_initMutex);
 			m_initState = InitState::Failed;
-			m_initCondition.wakeAll();
 		}
-
+		failPreInitMessages("Node.js initialization failed");
 		return false;
 	}
 
-	// Initialization successful
+	// The thread is running; requests are queued there without blocking and run as soon as handleMessage is cached
+	QList<PendingMessage> preInit;
 	{
 		QMutexLocker locker(&m_initMutex);
-		m_initState = InitState::Initialized;
-		m_initCondition.wakeAll();
+		m_nodeThread = std::move(nodeThread);
+		preInit.swap(m_preInitMessages);
 	}
-
-	// qDebug() << "NodeJS: Initialization completed successfully";
+	for (PendingMessage &pending : preInit) m_nodeThread->sendMessage(pending.name, pending.params, std::move(pending.callback), pending.options);
 	return true;
 }
 
+bool NodeJS::isReady() const {
+	QMutexLocker locker(&m_initMutex);
+	return m_initState == InitState::Initialized;
+}
+
 void NodeJS::shutdown() {
 	{
 		QMutexLocker locker(&m_initMutex);
-		if (m_initState != InitState::Initialized) {
+		if (m_initState == InitState::NotInitialized) {
 			return;
 		}
 	}
 
 	//	qDebug() << "NodeJS: Shutting down";
 
+	// A native handler that declines hands its request on to the thread torn down below
+	m_nativeHandlers.waitForDone();
+
 	if (m_nodeThread) {
 		m_nodeThread->shutdown();
 		m_nodeThread.reset();
@@ -86,67 +143,253 @@ void NodeJS::shutdown() {
 		QMutexLocker locker(&m_initMutex);
 		m_initState = InitState::NotInitialized;
 	}
+	failPreInitMessages("Node.js was shut down");
+
+	// Write what the timer has not written yet
+	m_snapshotTimer->stop();
+	m_snapshotWriter.waitForDone();
+	m_snapshot.save();
 
 	// qDebug() << "NodeJS: Shutdown completed";
 }
 
-void NodeJS::msg(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback) {
+void NodeJS::failPreInitMessages(const QString &error) {
+	QList<PendingMessage> preInit;
+	{
+		QMutexLocker locker(&m_initMutex);
+		preInit.swap(m_preInitMessages);
+	}
+	for (PendingMessage &pending : preInit) pending.callback(QJsonObject{{"status", "error"}, {"message", error}});
+}
+
+NodeRequestOptions NodeJS::defaultRequestOptions(const QString &name) {
+	// Slow or bulk actions that must never hold up requests driven by the UI
+	static const QSet<QString> backgroundActions = {
+		"wifiScanNetworks", "timeListTimeZones", "systemGetLatestVersion", "systemGetLatestAppVersion", "cryptoGetLatestBlock", "cryptoGetBalance", "speedPing", "speedDownload", "speedUpload",
+	};
+
+	NodeRequestOptions options;
+	if (backgroundActions.contains(name)) options.priority = NodeRequestOptions::Priority::Background;
+	return options;
+}
+
+quint64 NodeJS::msg(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback) {
+	return msg(name, params, std::move(callback), defaultRequestOptions(name));
+}
+
+quint64 NodeJS::msg(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback, const NodeRequestOptions &options) {
 	// qDebug() << "NodeJS::msg() called with action:" << name;
 
-	// Wait for initialization to complete or fail
+	// The previous run's response goes out at once; the fresh one replaces it in the snapshot on its way to the caller
+	if (m_snapshot.isPersistent(name) && !m_nativeHandlers.contains(name)) {
+		const QString key = ResponseCache::key(name, params);
+		QJsonObject stale;
+		if (m_snapshot.takeStale(key, &stale)) callback(stale);
+		callback = [this, key, name, callback = std::move(callback)](const QJsonObject &result) {
+			if (m_snapshot.store(key, name, result)) scheduleSnapshotSave();
+			callback(result);
+		};
+	}
+
+	// Shared reads can't be cancelled individually, so they never hand out a handle
+	if (m_responseCache.isCacheable(name)) {
+		const QString key = ResponseCache::key(name, params);
+		QJsonObject cached;
+		quint64 ticket = 0;
+		switch (m_responseCache.lookup(key, name, callback, &cached, &ticket)) {
+		case ResponseCache::Lookup::Hit:
+			callback(cached);
+			return 0;
+		case ResponseCache::Lookup::Joined:
+			return 0;
+		case ResponseCache::Lookup::Miss:
+			send(name, params, [this, key, ticket, name](const QJsonObject &result) { m_responseCache.complete(key, ticket, name, result); }, options);
+			return 0;
+		}
+	}
+
+	// Drop reads this write makes stale, both now and once it has taken effect
+	if (m_responseCache.isInvalidating(name)) {
+		m_responseCache.invalidate(name);
+		return send(name, params, [this, name, callback = std::move(callback)](const QJsonObject &result) {
+			m_responseCache.invalidate(name);
+			callback(result);
+		}, options);
+	}
+
+	return send(name, params, std::move(callback), options);
+}
+
+QVariantMap NodeJS::cacheStats() const {
+	return m_responseCache.stats();
+}
+
+QVariantMap NodeJS::metricsSnapshot() const {
+	QVariantMap snapshot = BridgeMetrics::instance().snapshot();
 	{
 		QMutexLocker locker(&m_initMutex);
-		while (m_initState == InitState::NotInitialized || m_initState == InitState::Initializing) {
-			// qDebug() << "NodeJS::msg() waiting for initialization to complete...";
-			m_initCondition.wait(&m_initMutex);
-		}
+		snapshot.insert("inFlight", m_nodeThread ? m_nodeThread->pendingRequests() : 0u);
+		snapshot.insert("preInit", m_preInitMessages.size());
+	}
+	snapshot.insert("cache", m_responseCache.stats());
+	snapshot.insert("snapshot", m_snapshot.stats());
+	return snapshot;
+}
 
+bool NodeJS::dumpMetrics(const QString &path) const {
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly)) {
+		qWarning() << "NodeJS: Cannot write metrics to" << path << file.errorString();
+		return false;
+	}
+	file.write(QJsonDocument(QJsonObject::fromVariantMap(metricsSnapshot())).toJson(QJsonDocument::Indented));
+	if (!file.commit()) return false;
+	qInfo() << "NodeJS: Bridge metrics written to" << path;
+	return true;
+}
+
+quint64 NodeJS::send(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback, const NodeRequestOptions &options) {
+	// Native requests finish on their own in a few ms, so like cached reads they are not cancellable
+	if (m_nativeHandlers.contains(name)) {
+		const bool dispatched = m_nativeHandlers.dispatch(name, params, [this, name, params, callback, options](const std::optional<QJsonObject> &result) {
+			if (result) callback(*result);
+			else sendToNode(name, params, callback, options);
+		});
+		if (dispatched) return 0;
+	}
+	return sendToNode(name, params, std::move(callback), options);
+}
+
+quint64 NodeJS::sendToNode(const QString &name, const QJsonObject &params, std::function<void(const QJsonObject &)> callback, const NodeRequestOptions &options) {
+	// Never blocks: before the thread exists requests are parked here, afterwards the thread queues them until Node is ready
+	{
+		QMutexLocker locker(&m_initMutex);
 		if (m_initState == InitState::Failed) {
+			locker.unlock();
 			qWarning() << "NodeJS: Initialization failed, cannot process message";
 			callback(QJsonObject{{"status", "error"}, {"message", "Node.js initialization failed"}});
-			return;
+			return 0;
 		}
-	}
 
-	if (!m_nodeThread) {
-		qWarning() << "NodeJS: NodeThread is null after initialization";
-		callback(QJsonObject{{"status", "error"}, {"message", "Node.js thread unavailable"}});
-		return;
+		if (!m_nodeThread) {
+			m_preInitMessages.append(PendingMessage{name, params, std::move(callback), options});
+			return 0;
+		}
 	}
 
-	m_nodeThread->sendMessage(name, params, callback);
+	return m_nodeThread->sendMessage(name, params, std::move(callback), options);
 }
 
-void NodeJS::msg(const QString &name, const QJsonObject &params, const QJSValue &callback) {
+quint64 NodeJS::msg(const QString &name, const QJsonObject &params, const QJSValue &callback) {
+	return msg(name, params, callback, QVariantMap());
+}
+
+quint64 NodeJS::msg(const QString &name, const QJsonObject &params, const QJSValue &callback, const QVariantMap &options) {
+	NodeRequestOptions requestOptions = defaultRequestOptions(name);
+	if (options.contains("timeout")) requestOptions.timeoutMs = options.value("timeout").toInt();
+	const QString priority = options.value("priority").toString();
+	if (priority == "background") requestOptions.priority = NodeRequestOptions::Priority::Background;
+	else if (priority == "interactive") requestOptions.priority = NodeRequestOptions::Priority::Interactive;
+
 	if (callback.isCallable()) {
 		// qDebug() << "NodeJS::msg creating callback wrapper for action:" << name;
+		ActionMetrics *metrics = BridgeMetrics::instance().action(name);
+		return msg(name, params, [this, callback, metrics](const QJsonObject &result) { deliverToQml(callback, result, metrics); }, requestOptions);
+	}
+	return msg(name, params, [this](const QJsonObject &result) { emit messageResponse(result); }, requestOptions);
+}
 
-		msg(name, params, [this, callback, name](const QJsonObject &result) mutable {
-			// qDebug() << "NodeJS::msg callback triggered for action:" << name;
-			QJsonDocument doc(result);
-			QString jsonString = doc.toJson(QJsonDocument::Compact);
-
-			// qDebug() << "NodeJS::msg marshalling JS callback to main thread with JSON:" << jsonString;
-
-			// Marshal the callback execution to the main thread
-			QMetaObject::invokeMethod(
-				this,
-				[callback, jsonString, name]() mutable {
-					// qDebug() << "NodeJS::msg executing JS callback on main thread for action:" << name;
-					QJSValue callResult = callback.call({QJSValue(jsonString)});
-					if (callResult.isError()) {
-						qWarning() << "JavaScript callback error:" << callResult.toString();
-					} // else qDebug() << "NodeJS::msg JS callback executed successfully";
-				},
-				Qt::QueuedConnection);
-		});
-	} else {
-		msg(name, params);
+bool NodeJS::cancel(quint64 requestId) {
+	if (!requestId) return false;
+	QMutexLocker locker(&m_initMutex);
+	return m_nodeThread && m_nodeThread->cancel(requestId);
+}
+
+void NodeJS::scheduleSnapshotSave() {
+	// The timer lives on the main thread; a write already pending takes this change along
+	QMetaObject::invokeMethod(m_snapshotTimer, [this]() {
+		if (!m_snapshotTimer->isActive()) m_snapshotTimer->start();
+	}, Qt::QueuedConnection);
+}
+
+void NodeJS::setEventCoalescing(const QString &type, bool enabled) {
+	if (enabled) m_coalescedEventTypes.insert(type);
+	else m_coalescedEventTypes.remove(type);
+	if (m_nodeThread) m_nodeThread->setEventCoalescing(type, enabled);
+}
+
+void NodeJS::dispatchEvents() {
+	if (!m_nodeThread) return;
+	const QList<NodeEvent> events = m_nodeThread->takeEvents();
+	for (const NodeEvent &event : events) emit eventReceived(event.type, event.value);
+}
+
+NativeHandlerRegistry &NodeJS::nativeHandlers() {
+	return m_nativeHandlers;
+}
+
+void NodeJS::setEngine(QJSEngine *engine) {
+	m_engine = engine;
+}
+
+bool NodeJS::batchCallbacks() const {
+	return m_batchCallbacks;
+}
+
+void NodeJS::setBatchCallbacks(bool enabled) {
+	if (m_batchCallbacks.exchange(enabled) == enabled) return;
+	// Don't strand anything queued under the previous mode
+	if (!enabled) flushPendingCallbacks();
+	emit batchCallbacksChanged();
+}
+
+void NodeJS::deliverToQml(const QJSValue &callback, const QJsonObject &result, ActionMetrics *metrics) {
+	const qint64 completedUs = BridgeMetrics::nowUs();
+	if (m_batchCallbacks) {
+		bool first;
+		{
+			QMutexLocker locker(&m_pendingMutex);
+			first = m_pendingCallbacks.isEmpty();
+			m_pendingCallbacks.append(PendingCallback{callback, result, metrics, completedUs});
+		}
+		// The timer lives on the main thread, so it has to be started from there
+		if (first) QMetaObject::invokeMethod(m_batchTimer, qOverload<>(&QTimer::start), Qt::QueuedConnection);
+		return;
+	}
+
+	// Marshal the callback execution to the main thread
+	QMetaObject::invokeMethod(
+		this,
+		[this, callback, result, metrics, completedUs]() mutable {
+			invokeQmlCallback(callback, result, metrics, completedUs);
+		},
+		Qt::QueuedConnection);
+}
+
+void NodeJS::invokeQmlCallback(QJSValue &callback, const QJsonObject &result, ActionMetrics *metrics, qint64 completedUs) {
+	if (metrics) metrics->delivery.record(BridgeMetrics::nowUs() - completedUs);
+	if (!m_engine) {
+		qWarning() << "NodeJS: No QML engine set, dropping callback result";
+		return;
+	}
+	// The result is built once, directly as a JS object, so QML callers don't have to JSON.parse() it
+	QJSValue callResult = callback.call({m_engine->toScriptValue(result)});
+	if (callResult.isError()) {
+		qWarning() << "JavaScript callback error:" << callResult.toString();
+	} // else qDebug() << "NodeJS::msg JS callback executed successfully";
+}
+
+void NodeJS::flushPendingCallbacks() {
+	QList<PendingCallback> pending;
+	{
+		QMutexLocker locker(&m_pendingMutex);
+		pending.swap(m_pendingCallbacks);
 	}
+	for (PendingCallback &entry : pending) invokeQmlCallback(entry.callback, entry.result, entry.metrics, entry.completedUs);
 }
 
-void NodeJS::msg(const QString &name, const QJsonObject &params) {
-	msg(name, params, [this](const QJsonObject &result) { emit messageResponse(result); });
+quint64 NodeJS::msg(const QString &name, const QJsonObject &params) {
+	return msg(name, params, [this](const QJsonObject &result) { emit messageResponse(result); });
 }
 
 #endif // ENABLE_NODEJS
@@ -2,20 +2,149 @@
 
 #ifdef ENABLE_NODEJS
 
+#include "include/bridge_metrics.h"
+#include "include/code_cache.h"
+#include "include/native_crypto.h"
+#include "include/v8_json.h"
+
+#include <QCborValue>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
-#include <QTextStream>
+#include <QRegularExpression>
+#include <QResource>
 #include <QTime>
 
 NodeThread *NodeThread::s_instance = nullptr;
 
-NodeThread::NodeThread(QObject *parent) : QThread(parent), m_isolate(nullptr), m_env(nullptr), m_running(false) {
+// Exposes bundle bytes to V8 as an external Latin-1 string. The data either lives in the
+// binary (uncompressed QRC entry) or in the implicitly shared QByteArray kept here.
+class BundleSourceResource : public v8::String::ExternalOneByteStringResource {
+public:
+	BundleSourceResource(const char *data, size_t length, const QByteArray &owner) : m_data(data), m_length(length), m_owner(owner) {}
+	const char *data() const override { return m_data; }
+	size_t length() const override { return m_length; }
+
+private:
+	const char *m_data;
+	size_t m_length;
+	QByteArray m_owner;
+};
+
+// External one-byte strings are Latin-1, so only pure ASCII UTF-8 can be used as-is
+static bool isAscii(const char *data, qsizetype size) {
+	for (qsizetype i = 0; i < size; i++) {
+		if (static_cast<unsigned char>(data[i]) >= 0x80) return false;
+	}
+	return true;
+}
+
+// A script from the QRC. Uncompressed resources are used in place, straight from the binary's data segment
+struct EmbeddedSource {
+	const char *data = nullptr;
+	qsizetype size = 0;
+	QByteArray owned; // only filled when the resource has to be decompressed
+};
+
+static bool loadEmbeddedSource(const QString &path, EmbeddedSource *source) {
+	QResource resource(path);
+	if (!resource.isValid()) return false;
+	if (resource.compressionAlgorithm() == QResource::NoCompression) {
+		source->data = reinterpret_cast<const char *>(resource.data());
+		source->size = qsizetype(resource.size());
+	} else {
+		QFile file(path);
+		if (!file.open(QIODevice::ReadOnly)) return false;
+		source->owned = file.readAll();
+		source->data = source->owned.constData();
+		source->size = source->owned.size();
+	}
+	return source->data && source->size > 0;
+}
+
+// Compiles source as a CommonJS module, function(exports, require, module, __filename, __dirname),
+// runs it and returns its result; module.exports holds what it exported. Failures are logged
+// and the exception is left pending for the caller.
+static v8::MaybeLocal<v8::Value> runCommonJSModule(v8::Local<v8::Context> context, const EmbeddedSource &embedded, const QString &filename, v8::Local<v8::Function> require, v8::Local<v8::Object> module) {
+	v8::Isolate *isolate = context->GetIsolate();
+	v8::TryCatch try_catch(isolate);
+
+	// Pure ASCII sources are handed to V8 as an external string, so they are never copied onto the V8 heap
+	v8::Local<v8::String> source;
+	if (isAscii(embedded.data, embedded.size)) {
+		source = v8::String::NewExternalOneByte(isolate, new BundleSourceResource(embedded.data, size_t(embedded.size), embedded.owned)).ToLocalChecked();
+	} else {
+		source = v8::String::NewFromUtf8(isolate, embedded.data, v8::NewStringType::kNormal, int(embedded.size)).ToLocalChecked();
+	}
+	v8::Local<v8::String> filenameStr = v8::String::NewFromUtf8(isolate, filename.toUtf8().constData()).ToLocalChecked();
+
+	// Compile with a persisted code cache when one matches this source
+	CodeCache codeCache(QString(filename).replace('/', '-'));
+	const bool useCodeCache = CodeCache::enabled();
+	const QByteArray cacheKey = useCodeCache ? CodeCache::sourceKey(embedded.data, embedded.size) : QByteArray();
+	v8::ScriptCompiler::CachedData *cachedData = useCodeCache ? codeCache.load(cacheKey) : nullptr;
+
+	// The CommonJS wrapper is supplied as the function's parameter list instead of by string concatenation
+	v8::Local<v8::String> wrapperParams[] = {
+		v8::String::NewFromUtf8Literal(isolate, "exports"),
+		v8::String::NewFromUtf8Literal(isolate, "require"),
+		v8::String::NewFromUtf8Literal(isolate, "module"),
+		v8::String::NewFromUtf8Literal(isolate, "__filename"),
+		v8::String::NewFromUtf8Literal(isolate, "__dirname"),
+	};
+
+	v8::ScriptOrigin origin(isolate, filenameStr);
+	v8::ScriptCompiler::Source scriptSource(source, origin, cachedData); // takes ownership of cachedData
+	QElapsedTimer compileTimer;
+	compileTimer.start();
+	v8::Local<v8::Function> moduleFunc;
+	if (!v8::ScriptCompiler::CompileFunction(context, &scriptSource, 5, wrapperParams, 0, nullptr, cachedData ? v8::ScriptCompiler::kConsumeCodeCache : v8::ScriptCompiler::kNoCompileOptions).ToLocal(&moduleFunc)) {
+		if (try_catch.HasCaught()) {
+			v8::String::Utf8Value exception(isolate, try_catch.Exception());
+			qCritical() << "NodeThread:" << filename << "compilation failed:" << *exception;
+			try_catch.ReThrow();
+		}
+		return v8::MaybeLocal<v8::Value>();
+	}
+	const qint64 compileUs = compileTimer.nsecsElapsed() / 1000;
+	const bool cacheRejected = cachedData && scriptSource.GetCachedData()->rejected;
+	const char *cacheState = !useCodeCache ? "disabled" : !cachedData ? "miss" : cacheRejected ? "rejected" : "hit";
+	qInfo().noquote() << "NodeThread:" << filename << "(" << embedded.size / 1024 << "KiB," << (source->IsExternalOneByte() ? "external" : "copied") << ") compiled in" << compileUs / 1000.0 << "ms, code cache:" << cacheState;
+
+	v8::Local<v8::Value> exports;
+	if (!module->Get(context, v8::String::NewFromUtf8Literal(isolate, "exports")).ToLocal(&exports)) return v8::MaybeLocal<v8::Value>();
+	v8::Local<v8::String> dirnameStr = v8::String::NewFromUtf8Literal(isolate, ".");
+
+	// Call the module function with CommonJS parameters
+	v8::Local<v8::Value> args[] = {exports, require, module, filenameStr, dirnameStr};
+
+	v8::Local<v8::Value> result;
+	if (!moduleFunc->Call(context, context->Global(), 5, args).ToLocal(&result)) {
+		if (try_catch.HasCaught()) {
+			v8::String::Utf8Value exception(isolate, try_catch.Exception());
+			qCritical() << "NodeThread:" << filename << "execution failed:" << *exception;
+			try_catch.ReThrow();
+		}
+		return v8::MaybeLocal<v8::Value>();
+	}
+
+	// (Re)build the cache after the module ran, so functions compiled during startup are included
+	if (useCodeCache && (!cachedData || cacheRejected)) {
+		std::unique_ptr<v8::ScriptCompiler::CachedData> freshCache(v8::ScriptCompiler::CreateCodeCacheForFunction(moduleFunc));
+		if (codeCache.save(cacheKey, freshCache.get())) qInfo() << "NodeThread: code cache written to" << codeCache.path();
+	}
+	return result;
+}
+
+NodeThread::NodeThread(QObject *parent) : QThread(parent), m_isolate(nullptr), m_env(nullptr), m_interactiveStreak(0), m_heapSampledAt(0), m_running(false), m_loopMode(LoopMode::EventDriven), m_wakeReady(false), m_execReady(false), m_nextExecId(0), m_droppedEvents(0) {
 	s_instance = this;
+	if (qEnvironmentVariable("NODE_LOOP_MODE") == QLatin1String("poll")) m_loopMode = LoopMode::Polling;
+	m_recorder = BridgeRecorder::fromEnvironment();
 }
 
 NodeThread::~NodeThread() {
@@ -32,11 +161,26 @@ bool NodeThread::initialize() {
 	return true;
 }
 
+void NodeThread::setLoopMode(LoopMode mode) {
+	if (isRunning()) {
+		qWarning() << "NodeThread: Loop mode can only be changed before initialize()";
+		return;
+	}
+	m_loopMode = mode;
+}
+
+NodeThread::LoopMode NodeThread::loopMode() const {
+	return m_loopMode;
+}
+
 void NodeThread::shutdown() {
 	if (m_running) {
 		// qDebug() << "NodeThread: Shutting down Node.js thread";
 		m_running = false;
-		m_messageCondition.wakeAll();
+		{
+			QMutexLocker locker(&m_messageMutex);
+			wakeLoop();
+		}
 
 		if (!wait(5000)) {
 			qWarning() << "NodeThread: Thread didn't stop gracefully, terminating";
@@ -46,27 +190,86 @@ void NodeThread::shutdown() {
 	}
 }
 
-void NodeThread::sendMessage(const QString &action, const QJsonObject &params, std::function<void(const QJsonObject &)> callback) {
-	// Generate unique message ID
-	QString messageId = QUuid::createUuid().toString();
-
-	// Store callback with message ID
-	{
-		QMutexLocker callbackLocker(&m_callbackMutex);
-		m_callbacks[messageId] = callback;
+quint64 NodeThread::sendMessage(const QString &action, const QJsonObject &params, std::function<void(const QJsonObject &)> callback, const NodeRequestOptions &options) {
+	// Store callback, the slot ID doubles as the message ID
+	const qint64 deadline = options.timeoutMs > 0 ? CallbackRegistry::now() + options.timeoutMs : 0;
+	CallbackTrace trace;
+	trace.tag = BridgeMetrics::instance().action(action);
+	trace.enqueuedUs = BridgeMetrics::nowUs();
+	quint64 messageId = m_callbacks.add(std::move(callback), deadline, trace);
+	if (!messageId) {
+		qWarning() << "NodeThread: Too many pending messages, rejecting action:" << action;
+		callback(QJsonObject{{"status", "error"}, {"message", "Too many pending requests"}});
+		return 0;
 	}
 
+	// Before enqueueing, so the send is always recorded ahead of its completion
+	if (m_recorder) m_recorder->recordSend(messageId, action, params, options.priority == NodeRequestOptions::Priority::Background, options.timeoutMs);
+
 	NodeMessage message;
 	message.messageId = messageId;
 	message.action = action;
 	message.params = params;
-	message.callback = callback; // Keep for compatibility, but we'll use the map
 
 	QMutexLocker locker(&m_messageMutex);
-	m_messageQueue.enqueue(message);
-	m_messageCondition.wakeAll();
+	if (options.priority == NodeRequestOptions::Priority::Background) m_backgroundQueue.enqueue(message);
+	else m_interactiveQueue.enqueue(message);
+	BridgeMetrics::instance().setQueueDepth(m_interactiveQueue.size(), m_backgroundQueue.size());
+	// Also re-arms the deadline timer on the Node thread
+	wakeLoop();
 
 	// qDebug() << "NodeThread: Queued message" << messageId << "with action:" << action;
+	return messageId;
+}
+
+bool NodeThread::cancel(quint64 messageId) {
+	// The queued message stays where it is and is skipped once dequeued
+	if (!m_callbacks.take(messageId)) return false;
+	if (m_recorder) m_recorder->recordCancel(messageId);
+	return true;
+}
+
+void NodeThread::setEventCoalescing(const QString &type, bool enabled) {
+	QMutexLocker locker(&m_eventMutex);
+	if (enabled) m_coalescedEventTypes.insert(type);
+	else m_coalescedEventTypes.remove(type);
+}
+
+QList<NodeEvent> NodeThread::takeEvents() {
+	QList<NodeEvent> events;
+	QMutexLocker locker(&m_eventMutex);
+	events.swap(m_events);
+	return events;
+}
+
+void NodeThread::pushEvent(const QString &type, const QJsonValue &value) {
+	bool wasEmpty;
+	{
+		QMutexLocker locker(&m_eventMutex);
+		if (m_coalescedEventTypes.contains(type)) {
+			for (NodeEvent &pending : m_events) {
+				if (pending.type == type) {
+					pending.value = value;
+					return;
+				}
+			}
+		}
+		if (m_events.size() >= kMaxPendingEvents) {
+			m_events.removeFirst();
+			if (m_droppedEvents++ % kMaxPendingEvents == 0) qWarning() << "NodeThread: Event queue full, dropping oldest events (" << m_droppedEvents << "dropped so far)";
+		}
+		wasEmpty = m_events.isEmpty();
+		m_events.append(NodeEvent{type, value});
+	}
+	// One notification per batch; the main thread drains everything queued until then
+	if (wasEmpty) emit eventsAvailable();
+}
+
+void NodeThread::failMessage(quint64 messageId, const QString &error) {
+	std::function<void(const QJsonObject &)> callback = m_callbacks.take(messageId);
+	if (!callback) return;
+	if (m_recorder) m_recorder->recordComplete(messageId, 0, 0, false);
+	callback(QJsonObject{{"status", "error"}, {"message", error}});
 }
 
 void NodeThread::run() {
@@ -80,7 +283,12 @@ void NodeThread::run() {
 	}
 
 	// qDebug() << "NodeThread: Node.js environment initialized, starting message loop";
+	emit ready();
+	m_watchdog.start(m_setup->event_loop(), m_isolate, LoopWatchdog::thresholdFromEnvironment());
 	processMessages();
+	m_watchdog.stop();
+	closeCommandBroker();
+	if (m_recorder) m_recorder->flush();
 
 	// Cleanup when thread exits
 	if (m_env) {
@@ -106,6 +314,15 @@ void NodeThread::run() {
 	// qDebug() << "NodeThread: Thread cleanup completed";
 }
 
+// NODE_PLATFORM_THREADS overrides the number of V8 platform threads; the default
+// leaves the GUI thread and the Node thread a core each on small boards
+static int platformThreadCount() {
+	bool ok = false;
+	const int threads = qEnvironmentVariableIntValue("NODE_PLATFORM_THREADS", &ok);
+	if (ok && threads > 0) return threads;
+	return qBound(1, QThread::idealThreadCount() - 1, 4);
+}
+
 bool NodeThread::initializeNodeEnvironment() {
 	try {
 		// Initialize Node.js platform with V8 flags but keep platform control
@@ -117,8 +334,11 @@ bool NodeThread::initializeNodeEnvironment() {
 			return false;
 		}
 
-		// Create V8 platform
-		m_platform = node::MultiIsolatePlatform::Create(1);
+		// Create V8 platform. Its worker threads run V8 background work (GC, compilation) for
+		// the main isolate and for the worker_threads used by the JS worker pool.
+		const int platformThreads = platformThreadCount();
+		qInfo() << "NodeThread: V8 platform threads:" << platformThreads;
+		m_platform = node::MultiIsolatePlatform::Create(platformThreads);
 		if (!m_platform) {
 			qWarning() << "NodeThread: Failed to create V8 platform";
 			return false;
@@ -162,27 +382,69 @@ bool NodeThread::loadJSEntryPoint() {
 	v8::HandleScope handle_scope(m_isolate);
 	v8::Context::Scope context_scope(m_setup->context());
 
-	// Load bundle file from Qt resources
-	QFile bundleFile(":/js/js/dist/bundle.cjs");
-	if (!bundleFile.exists()) {
-		qCritical() << "NodeThread: Bundle file not found in resources";
+	// Load bundle bytes from Qt resources
+	EmbeddedSource bundle;
+	if (!loadEmbeddedSource(":/js/js/dist/bundle.cjs", &bundle)) {
+		qCritical() << "NodeThread: Bundle file not found in resources or empty";
 		return false;
 	}
 
-	if (!bundleFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-		qCritical() << "NodeThread: Failed to open bundle file from resources";
+	// qDebug() << "NodeThread: Loading CommonJS bundle with Node.js integration";
+
+	v8::Local<v8::Context> globalContext = m_setup->context();
+
+	// Set up __nativeCallback for JS -> C++ communication, before the bundle runs so module-level code can use the bindings
+	v8::Local<v8::String> callbackName = v8::String::NewFromUtf8(m_isolate, "__nativeCallback").ToLocalChecked();
+	v8::Local<v8::Function> callbackFunc = v8::Function::New(globalContext, nativeCallback).ToLocalChecked();
+
+	if (!globalContext->Global()->Set(globalContext, callbackName, callbackFunc).FromMaybe(false)) {
+		qCritical() << "NodeThread: Failed to set __nativeCallback";
 		return false;
 	}
 
-	QString bundleCode = QTextStream(&bundleFile).readAll();
-	bundleFile.close();
+	// Set up __nativeEmit for pushing events from JS to the main thread
+	v8::Local<v8::String> emitName = v8::String::NewFromUtf8(m_isolate, "__nativeEmit").ToLocalChecked();
+	v8::Local<v8::Function> emitFunc = v8::Function::New(globalContext, nativeEmit).ToLocalChecked();
 
-	if (bundleCode.isEmpty()) {
-		qCritical() << "NodeThread: Bundle file is empty";
+	if (!globalContext->Global()->Set(globalContext, emitName, emitFunc).FromMaybe(false)) {
+		qCritical() << "NodeThread: Failed to set __nativeEmit";
 		return false;
 	}
 
-	// qDebug() << "NodeThread: Loading CommonJS bundle with Node.js integration";
+	// Set up __nativeExec for running external commands off the Node thread
+	uv_async_init(m_setup->event_loop(), &m_execAsync, onExecAsync);
+	m_execAsync.data = this;
+	// Outstanding commands must not keep the loop alive on their own
+	uv_unref(reinterpret_cast<uv_handle_t *>(&m_execAsync));
+	{
+		QMutexLocker locker(&m_execMutex);
+		m_execReady = true;
+	}
+	v8::Local<v8::String> execName = v8::String::NewFromUtf8(m_isolate, "__nativeExec").ToLocalChecked();
+	v8::Local<v8::Function> execFunc = v8::Function::New(globalContext, nativeExec).ToLocalChecked();
+
+	if (!globalContext->Global()->Set(globalContext, execName, execFunc).FromMaybe(false)) {
+		qCritical() << "NodeThread: Failed to set __nativeExec";
+		return false;
+	}
+
+	// Set up __nativeCrypto, the wallet primitives crypto0.js would otherwise load ethers for
+	if (NativeCrypto::enabled()) {
+		v8::Local<v8::String> cryptoName = v8::String::NewFromUtf8(m_isolate, "__nativeCrypto").ToLocalChecked();
+		if (!globalContext->Global()->Set(globalContext, cryptoName, NativeCrypto::createBinding(m_isolate, globalContext)).FromMaybe(false)) {
+			qCritical() << "NodeThread: Failed to set __nativeCrypto";
+			return false;
+		}
+	}
+
+	// Set up __nativeRequireChunk, which serves the lazily loaded parts of the bundle (see ChunkLoader.ts)
+	v8::Local<v8::String> requireChunkName = v8::String::NewFromUtf8(m_isolate, "__nativeRequireChunk").ToLocalChecked();
+	v8::Local<v8::Function> requireChunkFunc = v8::Function::New(globalContext, nativeRequireChunk).ToLocalChecked();
+
+	if (!globalContext->Global()->Set(globalContext, requireChunkName, requireChunkFunc).FromMaybe(false)) {
+		qCritical() << "NodeThread: Failed to set __nativeRequireChunk";
+		return false;
+	}
 
 	// Load environment and execute CommonJS bundle with proper context
 	auto loadenv_ret = node::LoadEnvironment(m_env, [&](const node::StartExecutionCallbackInfo &info) -> v8::MaybeLocal<v8::Value> {
@@ -190,32 +452,6 @@ bool NodeThread::loadJSEntryPoint() {
 		v8::Isolate *isolate = context->GetIsolate();
 		v8::TryCatch try_catch(isolate);
 
-		// Wrap the CommonJS module code in a function
-		QString wrappedCode = QString("(function(exports, require, module, __filename, __dirname) {\n%1\n});").arg(bundleCode);
-
-		v8::Local<v8::String> source = v8::String::NewFromUtf8(isolate, wrappedCode.toStdString().c_str()).ToLocalChecked();
-		v8::Local<v8::String> filename = v8::String::NewFromUtf8(isolate, "bundle.cjs").ToLocalChecked();
-
-		v8::ScriptOrigin origin(isolate, filename);
-		v8::Local<v8::Script> script;
-		if (!v8::Script::Compile(context, source, &origin).ToLocal(&script)) {
-			if (try_catch.HasCaught()) {
-				v8::String::Utf8Value exception(isolate, try_catch.Exception());
-				qCritical() << "NodeThread: CommonJS compilation failed:" << *exception;
-			}
-			return v8::MaybeLocal<v8::Value>();
-		}
-
-		// Execute to get the module function
-		v8::Local<v8::Value> moduleFunction;
-		if (!script->Run(context).ToLocal(&moduleFunction)) {
-			if (try_catch.HasCaught()) {
-				v8::String::Utf8Value exception(isolate, try_catch.Exception());
-				qCritical() << "NodeThread: CommonJS wrapper execution failed:" << *exception;
-			}
-			return v8::MaybeLocal<v8::Value>();
-		}
-
 		// Create CommonJS environment
 		v8::Local<v8::Object> exports = v8::Object::New(isolate);
 		v8::Local<v8::Object> module = v8::Object::New(isolate);
@@ -259,21 +495,9 @@ bool NodeThread::loadJSEntryPoint() {
 
 		v8::Local<v8::Function> require = wrappedRequireValue.As<v8::Function>();
 		// qDebug() << "NodeThread: Created require wrapper to handle node: prefixes";
-		v8::Local<v8::String> filenameStr = v8::String::NewFromUtf8(isolate, "bundle.cjs").ToLocalChecked();
-		v8::Local<v8::String> dirnameStr = v8::String::NewFromUtf8(isolate, ".").ToLocalChecked();
-
-		// Call the module function with CommonJS parameters
-		v8::Local<v8::Function> moduleFunc = moduleFunction.As<v8::Function>();
-		v8::Local<v8::Value> args[] = {exports, require, module, filenameStr, dirnameStr};
 
 		v8::Local<v8::Value> result;
-		if (!moduleFunc->Call(context, context->Global(), 5, args).ToLocal(&result)) {
-			if (try_catch.HasCaught()) {
-				v8::String::Utf8Value exception(isolate, try_catch.Exception());
-				qCritical() << "NodeThread: CommonJS module execution failed:" << *exception;
-			}
-			return v8::MaybeLocal<v8::Value>();
-		}
+		if (!runCommonJSModule(context, bundle, "bundle.cjs", require, module).ToLocal(&result)) return v8::MaybeLocal<v8::Value>();
 
 		// qDebug() << "NodeThread: CommonJS bundle executed successfully";
 		return result;
@@ -311,20 +535,148 @@ bool NodeThread::loadJSEntryPoint() {
 	// Cache the handleMessage function
 	m_handleMessageFunction.Reset(m_isolate, handleMessageValue.As<v8::Function>());
 
-	// Set up __nativeCallback for JS -> C++ communication
-	v8::Local<v8::String> callbackName = v8::String::NewFromUtf8(m_isolate, "__nativeCallback").ToLocalChecked();
-	v8::Local<v8::Function> callbackFunc = v8::Function::New(context, nativeCallback).ToLocalChecked();
-
-	if (!context->Global()->Set(context, callbackName, callbackFunc).FromMaybe(false)) {
-		qCritical() << "NodeThread: Failed to set __nativeCallback";
-		return false;
-	}
-
 	// qDebug() << "NodeThread: JavaScript environment loaded successfully via native require()";
 	return true;
 }
 
 void NodeThread::processMessages() {
+	if (m_loopMode == LoopMode::Polling) processMessagesPolling();
+	else processMessagesEventDriven();
+}
+
+void NodeThread::wakeLoop() {
+	// Both wake paths are cheap and coalesce, so just poke whichever loop is running
+	if (m_wakeReady) uv_async_send(&m_wakeAsync);
+	m_messageCondition.wakeAll();
+}
+
+void NodeThread::onWakeAsync(uv_async_t *handle) {
+	// Messages are drained by the loop right after uv_run() returns; the async only has to interrupt the poll
+	(void)handle;
+}
+
+bool NodeThread::dequeueMessage(NodeMessage &message) {
+	const bool takeBackground = !m_backgroundQueue.isEmpty() && (m_interactiveQueue.isEmpty() || m_interactiveStreak >= kInteractiveBurst);
+	if (takeBackground) {
+		message = m_backgroundQueue.dequeue();
+		m_interactiveStreak = 0;
+	} else {
+		if (m_interactiveQueue.isEmpty()) return false;
+		message = m_interactiveQueue.dequeue();
+		if (!m_backgroundQueue.isEmpty()) m_interactiveStreak++;
+	}
+	BridgeMetrics::instance().setQueueDepth(m_interactiveQueue.size(), m_backgroundQueue.size());
+	return true;
+}
+
+bool NodeThread::drainMessageQueue() {
+	bool didWork = false;
+	while (m_running) {
+		// Don't hold the lock while executing JS
+		NodeMessage message;
+		{
+			QMutexLocker locker(&m_messageMutex);
+			if (!dequeueMessage(message)) break;
+		}
+		handleNodeMessage(message);
+		didWork = true;
+	}
+	return didWork;
+}
+
+void NodeThread::expireRequests() {
+	const qint64 now = CallbackRegistry::now();
+	quint64 messageId = 0;
+	CallbackTrace trace;
+	while (std::function<void(const QJsonObject &)> callback = m_callbacks.takeExpired(now, &messageId, &trace)) {
+		qWarning() << "NodeThread: Request" << messageId << "timed out";
+		if (m_recorder) m_recorder->recordTimeout(messageId);
+		if (auto *metrics = static_cast<ActionMetrics *>(trace.tag)) metrics->timeouts.fetch_add(1, std::memory_order_relaxed);
+		callback(QJsonObject{{"status", "error"}, {"message", "Request timed out"}});
+	}
+}
+
+void NodeThread::scheduleDeadlineTimer() {
+	const qint64 deadline = m_callbacks.nextDeadline();
+	if (deadline < 0) {
+		uv_timer_stop(&m_deadlineTimer);
+		return;
+	}
+	uv_timer_start(&m_deadlineTimer, onDeadlineTimer, quint64(qMax<qint64>(0, deadline - CallbackRegistry::now())), 0);
+}
+
+void NodeThread::sampleHeapStatistics() {
+	// GetHeapStatistics() is cheap but there is no point doing it on every loop pass
+	const qint64 now = CallbackRegistry::now();
+	if (now - m_heapSampledAt < kHeapSampleIntervalMs) return;
+	m_heapSampledAt = now;
+
+	v8::Locker locker(m_isolate);
+	v8::HeapStatistics stats;
+	m_isolate->GetHeapStatistics(&stats);
+	BridgeMetrics::HeapStatistics heap;
+	heap.used = stats.used_heap_size();
+	heap.total = stats.total_heap_size();
+	heap.limit = stats.heap_size_limit();
+	heap.external = stats.external_memory();
+	BridgeMetrics::instance().setHeapStatistics(heap);
+}
+
+quint32 NodeThread::pendingRequests() const {
+	return m_callbacks.size();
+}
+
+void NodeThread::onDeadlineTimer(uv_timer_t *handle) {
+	static_cast<NodeThread *>(handle->data)->expireRequests();
+}
+
+void NodeThread::processMessagesEventDriven() {
+	uv_loop_t *loop = m_setup->event_loop();
+	uv_async_init(loop, &m_wakeAsync, onWakeAsync);
+	m_wakeAsync.data = this;
+	uv_timer_init(loop, &m_deadlineTimer);
+	m_deadlineTimer.data = this;
+	// Pending deadlines must not keep the loop alive on their own
+	uv_unref(reinterpret_cast<uv_handle_t *>(&m_deadlineTimer));
+	{
+		QMutexLocker locker(&m_messageMutex);
+		m_wakeReady = true;
+	}
+
+	while (m_running) {
+		// Anything queued before the async was armed (or while JS was running) is handled here
+		drainMessageQueue();
+		if (!m_running) break;
+		scheduleDeadlineTimer();
+
+		v8::Locker lock(m_isolate);
+		v8::Isolate::Scope isolate_scope(m_isolate);
+		v8::HandleScope handle_scope(m_isolate);
+		v8::Context::Scope context_scope(m_setup->context());
+
+		// Blocks in the backend poll until a message (m_wakeAsync), a timer, I/O or a
+		// platform task (Node's per-isolate flush async) needs attention
+		uv_run(loop, UV_RUN_ONCE);
+		m_platform->DrainTasks(m_isolate);
+		m_isolate->PerformMicrotaskCheckpoint();
+		sampleHeapStatistics();
+	}
+
+	{
+		QMutexLocker locker(&m_messageMutex);
+		m_wakeReady = false;
+	}
+
+	v8::Locker lock(m_isolate);
+	v8::Isolate::Scope isolate_scope(m_isolate);
+	v8::HandleScope handle_scope(m_isolate);
+	v8::Context::Scope context_scope(m_setup->context());
+	uv_close(reinterpret_cast<uv_handle_t *>(&m_wakeAsync), nullptr);
+	uv_close(reinterpret_cast<uv_handle_t *>(&m_deadlineTimer), nullptr);
+	uv_run(loop, UV_RUN_NOWAIT);
+}
+
+void NodeThread::processMessagesPolling() {
 	// qDebug() << "NodeThread: Starting non-blocking pump for Node/Qt integration";
 
 	while (m_running) {
@@ -333,14 +685,18 @@ void NodeThread::processMessages() {
 		// 0) Pull exactly one message if present (don’t hold the lock while executing JS)
 		{
 			QMutexLocker locker(&m_messageMutex);
-			if (!m_messageQueue.isEmpty()) {
-				NodeMessage message = m_messageQueue.dequeue();
+			NodeMessage message;
+			if (dequeueMessage(message)) {
 				locker.unlock();
 				handleNodeMessage(message);
 				didWork = true;
 			}
 		}
 
+		// Requests past their deadline; the event-driven loop uses a timer for this instead
+		expireRequests();
+		sampleHeapStatistics();
+
 		// 1..4) Pump Node/V8 once (non-blocking) and note if anything progressed
 		didWork = pumpNodeOnce() || didWork;
 
@@ -409,8 +765,16 @@ bool NodeThread::pumpNodeOnce() {
 }
 
 void NodeThread::handleNodeMessage(const NodeMessage &message) {
+	// Cancelled or timed out while waiting in the queue
+	CallbackTrace trace;
+	if (!m_callbacks.markStarted(message.messageId, BridgeMetrics::nowUs(), &trace)) return;
+	if (auto *metrics = static_cast<ActionMetrics *>(trace.tag)) {
+		metrics->count.fetch_add(1, std::memory_order_relaxed);
+		metrics->queue.record(trace.startedUs - trace.enqueuedUs);
+	}
+
 	if (!m_env || !m_isolate) {
-		message.callback(QJsonObject{{"status", "error"}, {"message", "Node.js not initialized"}});
+		failMessage(message.messageId, "Node.js not initialized");
 		return;
 	}
 
@@ -423,46 +787,22 @@ void NodeThread::handleNodeMessage(const NodeMessage &message) {
 
 	v8::Local<v8::Context> context = m_setup->context();
 
-	// Create message object with messageId
-	QJsonObject jsObject;
-	jsObject["messageId"] = message.messageId;
-	jsObject["action"] = message.action;
-	jsObject["data"] = message.params;
-
-	QJsonDocument doc(jsObject);
-	QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
-
-	v8::Local<v8::String> jsonStr = v8::String::NewFromUtf8(m_isolate, jsonData.constData(), v8::NewStringType::kNormal).ToLocalChecked();
-
-	// Parse JSON
-	v8::Local<v8::Value> jsonObj;
-	if (!context->Global()->Get(context, v8::String::NewFromUtf8(m_isolate, "JSON").ToLocalChecked()).ToLocal(&jsonObj)) {
-		message.callback(QJsonObject{{"status", "error"}, {"message", "Failed to get JSON object"}});
-		return;
-	}
-
-	v8::Local<v8::Object> json = jsonObj->ToObject(context).ToLocalChecked();
-	v8::Local<v8::Value> parseFunc;
-	if (!json->Get(context, v8::String::NewFromUtf8(m_isolate, "parse").ToLocalChecked()).ToLocal(&parseFunc)) {
-		message.callback(QJsonObject{{"status", "error"}, {"message", "Failed to get JSON.parse"}});
-		return;
-	}
-
-	v8::Local<v8::Function> parse = parseFunc.As<v8::Function>();
-	v8::Local<v8::Value> parseArgs[] = {jsonStr};
-	v8::Local<v8::Value> jsValue;
-	if (!parse->Call(context, json, 1, parseArgs).ToLocal(&jsValue)) {
-		message.callback(QJsonObject{{"status", "error"}, {"message", "Failed to parse JSON"}});
-		return;
-	}
+	// Build the message object directly in V8, no JSON text in between
+	v8::Local<v8::Object> jsValue = v8::Object::New(m_isolate);
+	jsValue->CreateDataProperty(context, v8::String::NewFromUtf8Literal(m_isolate, "messageId"), v8::Number::New(m_isolate, double(message.messageId))).Check();
+	jsValue->CreateDataProperty(context, v8::String::NewFromUtf8Literal(m_isolate, "action"), V8Json::toV8(m_isolate, message.action)).Check();
+	jsValue->CreateDataProperty(context, v8::String::NewFromUtf8Literal(m_isolate, "data"), V8Json::toV8(m_isolate, context, message.params)).Check();
 
 	// Call handleMessage
 	v8::Local<v8::Function> handleMessage = m_handleMessageFunction.Get(m_isolate);
 	v8::Local<v8::Value> args[] = {jsValue};
 
 	v8::Local<v8::Value> result;
-	if (!handleMessage->Call(context, context->Global(), 1, args).ToLocal(&result)) {
-		message.callback(QJsonObject{{"status", "error"}, {"message", "Failed to call handleMessage"}});
+	m_watchdog.enterAction(message.action);
+	const bool called = handleMessage->Call(context, context->Global(), 1, args).ToLocal(&result);
+	m_watchdog.leaveAction();
+	if (!called) {
+		failMessage(message.messageId, "Failed to call handleMessage");
 		return;
 	}
 
@@ -485,81 +825,47 @@ void NodeThread::nativeCallback(const v8::FunctionCallbackInfo<v8::Value> &args)
 		v8::Isolate *isolate = args.GetIsolate();
 		v8::HandleScope handle_scope(isolate);
 
-		if (args.Length() > 1 && args[0]->IsString() && args[1]->IsObject()) {
+		if (args.Length() > 1 && args[0]->IsNumber() && args[1]->IsObject()) {
 			v8::Local<v8::Context> context = isolate->GetCurrentContext();
 
 			// Get messageId from first argument
-			v8::String::Utf8Value messageIdStr(isolate, args[0]);
-			QString messageId = QString(*messageIdStr);
+			quint64 messageId = quint64(args[0].As<v8::Number>()->Value());
 			// qDebug() << "NodeThread::nativeCallback: Processing callback for messageId:" << messageId;
 
-			// Find the callback for this message
-			std::function<void(const QJsonObject &)> callback;
-			{
-				QMutexLocker locker(&s_instance->m_callbackMutex);
-				if (s_instance->m_callbacks.contains(messageId)) {
-					callback = s_instance->m_callbacks.take(messageId);
-					// qDebug() << "NodeThread::nativeCallback: Found and removed callback for messageId:" << messageId;
-				} else {
-					qWarning() << "NodeThread: No callback found for messageId:" << messageId;
-					return;
-				}
-			}
-
-			// Convert result object to JSON
-			v8::Local<v8::Value> jsonObj;
-			if (!context->Global()->Get(context, v8::String::NewFromUtf8(isolate, "JSON").ToLocalChecked()).ToLocal(&jsonObj)) {
-				qWarning() << "NodeThread::nativeCallback: Failed to get JSON object";
+			// Find and release the callback for this message
+			CallbackTrace trace;
+			std::function<void(const QJsonObject &)> callback = s_instance->m_callbacks.take(messageId, &trace);
+			if (!callback) {
+				// Late reply for a request that timed out or was cancelled
 				return;
 			}
 
-			v8::Local<v8::Object> json = jsonObj->ToObject(context).ToLocalChecked();
-			v8::Local<v8::Value> stringifyFunc;
-			if (!json->Get(context, v8::String::NewFromUtf8(isolate, "stringify").ToLocalChecked()).ToLocal(&stringifyFunc)) {
-				qWarning() << "NodeThread::nativeCallback: Failed to get JSON.stringify function";
-				return;
+			// Convert the result straight from V8 values - let QML handle the structure
+			QJsonValue result = V8Json::fromV8(isolate, context, args[1]);
+			const qint64 jsUs = BridgeMetrics::nowUs() - trace.startedUs;
+			const bool failed = result.toObject().value("status").toString() == QLatin1String("error");
+			if (auto *metrics = static_cast<ActionMetrics *>(trace.tag)) {
+				metrics->js.record(jsUs);
+				if (failed) metrics->errors.fetch_add(1, std::memory_order_relaxed);
 			}
+			// Result size as CBOR, close enough to what crosses the bridge for replay
+			if (s_instance->m_recorder) s_instance->m_recorder->recordComplete(messageId, jsUs, QCborValue::fromJsonValue(result).toCbor().size(), !failed);
 
-			v8::Local<v8::Function> stringify = stringifyFunc.As<v8::Function>();
-			v8::Local<v8::Value> argv[] = {args[1]}; // Use second argument (result object)
-			v8::Local<v8::Value> result;
-			if (!stringify->Call(context, json, 1, argv).ToLocal(&result)) {
-				qWarning() << "NodeThread::nativeCallback: Failed to stringify result object";
-				return;
-			}
-
-			v8::String::Utf8Value jsonStr(isolate, result);
-
-			// Just parse and pass through - let QML handle the structure
-			QJsonParseError error;
-			QJsonDocument doc = QJsonDocument::fromJson(QByteArray(*jsonStr), &error);
-
-			if (error.error == QJsonParseError::NoError) {
-				// qDebug() << "NodeThread::nativeCallback: callback'ing for messageId:" << messageId;
-				//  Only pass objects - wrap arrays and other types
-				if (doc.isObject()) {
-					callback(doc.object());
-				} else {
-					// Wrap non-object responses in a standardized object
-					QJsonObject wrapper;
-					wrapper["status"] = "success";
-					if (doc.isArray()) {
-						wrapper["data"] = doc.array();
-					} else {
-						// Handle primitive types
-						wrapper["data"] = QJsonValue::fromVariant(doc.toVariant());
-					}
-					callback(wrapper);
-				}
-				// qDebug() << "NodeThread::nativeCallback: Callback executed successfully for messageId:" << messageId;
+			// qDebug() << "NodeThread::nativeCallback: callback'ing for messageId:" << messageId;
+			//  Only pass objects - wrap arrays in a standardized object
+			if (result.isObject()) {
+				callback(result.toObject());
 			} else {
-				qWarning() << "NodeThread::nativeCallback: Failed to parse JSON for messageId:" << messageId << "Error:" << error.errorString();
-				qWarning() << "NodeThread::nativeCallback: Raw JSON string:" << QString(*jsonStr);
+				QJsonObject wrapper;
+				wrapper["status"] = "success";
+				wrapper["data"] = result.isUndefined() ? QJsonValue(QJsonValue::Null) : result;
+				callback(wrapper);
 			}
+			// qDebug() << "NodeThread::nativeCallback: Callback executed successfully for messageId:" << messageId;
 		} else {
-			qWarning() << "NodeThread::nativeCallback: Invalid arguments - expected (string, object), got" << args.Length() << "arguments";
+			qWarning() << "NodeThread::nativeCallback: Invalid arguments - expected (number, object), got" << args.Length() << "arguments";
 			if (args.Length() > 0) {
-				qWarning() << "NodeThread::nativeCallback: First arg is string:" << args[0]->IsString();
+				qWarning() << "NodeThread::nativeCallback: First arg is number:" << args[0]->IsNumber();
 			}
 			if (args.Length() > 1) {
 				qWarning() << "NodeThread::nativeCallback: Second arg is object:" << args[1]->IsObject();
@@ -572,4 +878,173 @@ void NodeThread::nativeCallback(const v8::FunctionCallbackInfo<v8::Value> &args)
 	}
 }
 
+void NodeThread::nativeEmit(const v8::FunctionCallbackInfo<v8::Value> &args) {
+	if (!s_instance) return;
+
+	v8::Isolate *isolate = args.GetIsolate();
+	v8::HandleScope handle_scope(isolate);
+
+	if (args.Length() < 1 || !args[0]->IsString()) {
+		qWarning() << "NodeThread::nativeEmit: Invalid arguments - expected (string, value)";
+		return;
+	}
+
+	QString type = V8Json::toQString(isolate, args[0].As<v8::String>());
+	QJsonValue value = args.Length() > 1 ? V8Json::fromV8(isolate, isolate->GetCurrentContext(), args[1]) : QJsonValue();
+	s_instance->pushEvent(type, value.isUndefined() ? QJsonValue(QJsonValue::Null) : value);
+}
+
+void NodeThread::nativeRequireChunk(const v8::FunctionCallbackInfo<v8::Value> &args) {
+	v8::Isolate *isolate = args.GetIsolate();
+	v8::HandleScope handle_scope(isolate);
+	v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+	if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsFunction()) {
+		isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8Literal(isolate, "__nativeRequireChunk: expected (name, require)")));
+		return;
+	}
+	const QString name = QString::fromUtf8(*v8::String::Utf8Value(isolate, args[0]));
+	static const QRegularExpression validName("^[a-z0-9_-]+$");
+	EmbeddedSource chunk;
+	if (!validName.match(name).hasMatch() || !loadEmbeddedSource(":/js/js/dist/chunks/" + name + ".cjs", &chunk)) {
+		isolate->ThrowException(v8::Exception::Error(v8::String::NewFromUtf8(isolate, QString("Bundle chunk not found: %1").arg(name).toUtf8().constData()).ToLocalChecked()));
+		return;
+	}
+
+	v8::Local<v8::String> exportsName = v8::String::NewFromUtf8Literal(isolate, "exports");
+	v8::Local<v8::Object> module = v8::Object::New(isolate);
+	module->Set(context, exportsName, v8::Object::New(isolate)).Check();
+	if (runCommonJSModule(context, chunk, "chunks/" + name + ".cjs", args[1].As<v8::Function>(), module).IsEmpty()) return;
+
+	v8::Local<v8::Value> exports;
+	if (module->Get(context, exportsName).ToLocal(&exports)) args.GetReturnValue().Set(exports);
+}
+
+void NodeThread::nativeExec(const v8::FunctionCallbackInfo<v8::Value> &args) {
+	if (!s_instance) return;
+
+	v8::Isolate *isolate = args.GetIsolate();
+	v8::HandleScope handle_scope(isolate);
+	v8::Local<v8::Context> context = isolate->GetCurrentContext();
+
+	if (args.Length() < 1 || !args[0]->IsString()) {
+		isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8Literal(isolate, "__nativeExec: expected (file, args, options)")));
+		return;
+	}
+
+	CommandBroker::Request request;
+	request.program = V8Json::toQString(isolate, args[0].As<v8::String>());
+	if (args.Length() > 1 && args[1]->IsArray()) {
+		v8::Local<v8::Array> arguments = args[1].As<v8::Array>();
+		for (uint32_t i = 0; i < arguments->Length(); i++) {
+			v8::Local<v8::Value> argument;
+			v8::Local<v8::String> text;
+			if (!arguments->Get(context, i).ToLocal(&argument) || !argument->ToString(context).ToLocal(&text)) return; // exception pending
+			request.arguments.append(V8Json::toQString(isolate, text));
+		}
+	}
+	v8::Local<v8::Function> onData;
+	if (args.Length() > 2 && args[2]->IsObject()) {
+		v8::Local<v8::Object> options = args[2].As<v8::Object>();
+		v8::Local<v8::Value> value;
+		if (options->Get(context, v8::String::NewFromUtf8Literal(isolate, "timeout")).ToLocal(&value) && value->IsNumber()) request.timeoutMs = int(value.As<v8::Number>()->Value());
+		if (options->Get(context, v8::String::NewFromUtf8Literal(isolate, "cacheTtl")).ToLocal(&value) && value->IsNumber()) request.cacheTtlMs = int(value.As<v8::Number>()->Value());
+		if (options->Get(context, v8::String::NewFromUtf8Literal(isolate, "invalidate")).ToLocal(&value)) request.invalidate = value->BooleanValue(isolate);
+		if (options->Get(context, v8::String::NewFromUtf8Literal(isolate, "onData")).ToLocal(&value) && value->IsFunction()) onData = value.As<v8::Function>();
+	}
+
+	v8::Local<v8::Promise::Resolver> resolver;
+	if (!v8::Promise::Resolver::New(context).ToLocal(&resolver)) return;
+	args.GetReturnValue().Set(resolver->GetPromise());
+
+	NodeThread *self = s_instance;
+	const quint64 execId = ++self->m_nextExecId;
+	PendingExec &pending = self->m_pendingExecs[execId];
+	pending.resolver.Reset(isolate, resolver);
+	CommandBroker::OutputCallback output;
+	if (!onData.IsEmpty()) {
+		pending.onData.Reset(isolate, onData);
+		output = [self, execId](const QByteArray &chunk) { self->pushExecEvent(ExecEvent{execId, false, chunk, {}}); };
+	}
+	self->m_commandBroker.run(request, std::move(output), [self, execId](const CommandBroker::Result &result) { self->pushExecEvent(ExecEvent{execId, true, QByteArray(), result}); });
+}
+
+void NodeThread::pushExecEvent(ExecEvent event) {
+	QMutexLocker locker(&m_execMutex);
+	m_execEvents.append(std::move(event));
+	if (m_execReady) uv_async_send(&m_execAsync);
+}
+
+static v8::Local<v8::String> utf8String(v8::Isolate *isolate, const QByteArray &bytes) {
+	return v8::String::NewFromUtf8(isolate, bytes.constData(), v8::NewStringType::kNormal, int(bytes.size())).ToLocalChecked();
+}
+
+void NodeThread::onExecAsync(uv_async_t *handle) {
+	auto *self = static_cast<NodeThread *>(handle->data);
+	QList<ExecEvent> events;
+	{
+		QMutexLocker locker(&self->m_execMutex);
+		events.swap(self->m_execEvents);
+	}
+
+	// Runs inside uv_run(), which the loops call with the isolate locked and the context entered
+	v8::Isolate *isolate = self->m_isolate;
+	v8::HandleScope handle_scope(isolate);
+	v8::Local<v8::Context> context = self->m_setup->context();
+	for (const ExecEvent &event : std::as_const(events)) {
+		const auto pending = self->m_pendingExecs.find(event.execId);
+		if (pending == self->m_pendingExecs.end()) continue;
+
+		if (!event.finished) {
+			v8::TryCatch tryCatch(isolate);
+			v8::Local<v8::Value> chunk[] = {utf8String(isolate, event.chunk)};
+			if (pending->second.onData.Get(isolate)->Call(context, context->Global(), 1, chunk).IsEmpty() && tryCatch.HasCaught()) {
+				v8::String::Utf8Value exception(isolate, tryCatch.Exception());
+				qWarning() << "NodeThread: __nativeExec onData threw:" << *exception;
+			}
+			continue;
+		}
+
+		v8::Local<v8::Promise::Resolver> resolver = pending->second.resolver.Get(isolate);
+		self->m_pendingExecs.erase(pending);
+		const CommandBroker::Result &result = event.result;
+		if (!result.error.isEmpty()) {
+			resolver->Reject(context, v8::Exception::Error(V8Json::toV8(isolate, result.error))).Check();
+			continue;
+		}
+		v8::Local<v8::Object> object = v8::Object::New(isolate);
+		// Like child_process: code is null when the command was killed by a signal
+		v8::Local<v8::Value> code = v8::Null(isolate);
+		if (!result.signal) code = v8::Integer::New(isolate, result.exitCode);
+		object->CreateDataProperty(context, v8::String::NewFromUtf8Literal(isolate, "code"), code).Check();
+		object->CreateDataProperty(context, v8::String::NewFromUtf8Literal(isolate, "signal"), v8::Integer::New(isolate, result.signal)).Check();
+		object->CreateDataProperty(context, v8::String::NewFromUtf8Literal(isolate, "stdout"), utf8String(isolate, result.standardOutput)).Check();
+		object->CreateDataProperty(context, v8::String::NewFromUtf8Literal(isolate, "stderr"), utf8String(isolate, result.standardError)).Check();
+		object->CreateDataProperty(context, v8::String::NewFromUtf8Literal(isolate, "timedOut"), v8::Boolean::New(isolate, result.timedOut)).Check();
+		object->CreateDataProperty(context, v8::String::NewFromUtf8Literal(isolate, "cached"), v8::Boolean::New(isolate, result.cached)).Check();
+		object->CreateDataProperty(context, v8::String::NewFromUtf8Literal(isolate, "durationMs"), v8::Number::New(isolate, result.durationUs / 1000.0)).Check();
+		resolver->Resolve(context, object).Check();
+	}
+}
+
+void NodeThread::closeCommandBroker() {
+	// Kills what is still running; its completions land in m_execEvents and are dropped
+	m_commandBroker.shutdown();
+	{
+		QMutexLocker locker(&m_execMutex);
+		if (!m_execReady) return;
+		m_execReady = false;
+		m_execEvents.clear();
+	}
+
+	v8::Locker lock(m_isolate);
+	v8::Isolate::Scope isolate_scope(m_isolate);
+	v8::HandleScope handle_scope(m_isolate);
+	v8::Context::Scope context_scope(m_setup->context());
+	m_pendingExecs.clear();
+	uv_close(reinterpret_cast<uv_handle_t *>(&m_execAsync), nullptr);
+	// Also completes the close of the watchdog's handles
+	uv_run(m_setup->event_loop(), UV_RUN_NOWAIT);
+}
+
 #endif // ENABLE_NODEJS
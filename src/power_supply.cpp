@@ -0,0 +1,38 @@
+#include "include/power_supply.h"
+
+#include <QDir>
+#include <QFile>
+
+QByteArray readSysfsAttribute(const QString &path) {
+	// sysfs attributes are tiny; read() on them is a single syscall
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+	return file.read(4096).trimmed();
+}
+
+PowerSupplyState readPowerSupply(const QString &root) {
+	PowerSupplyState state;
+	const QDir dir(root);
+	if (!dir.exists()) return state;
+	state.available = true;
+
+	// Class entries are symlinks to the device directories
+	for (const QString &device : dir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot, QDir::Name)) {
+		const QString base = dir.filePath(device) + '/';
+		const QByteArray type = readSysfsAttribute(base + "type");
+		if (type == "Mains" || type == "USB") {
+			if (readSysfsAttribute(base + "online") == "1") state.acConnected = true;
+			continue;
+		}
+		// Skip peripherals (mice, keyboards) that report their own battery
+		if (type != "Battery" || state.hasBattery || readSysfsAttribute(base + "scope") == "Device") continue;
+
+		bool ok = false;
+		const int level = readSysfsAttribute(base + "capacity").toInt(&ok);
+		if (!ok) continue;
+		state.hasBattery = true;
+		state.level = qBound(0, level, 100);
+		state.charging = readSysfsAttribute(base + "status").toLower() == "charging";
+	}
+	return state;
+}
@@ -10,8 +10,11 @@ Rectangle {
 	anchors.left: parent.left
 	anchors.right: parent.right
 
+	// WifiMonitor (C++) pushes strength only when the bucket changes; otherwise poll Node
+	readonly property bool nativeWifi: typeof WifiMonitor !== 'undefined'
+
 	// Properties for connection states
-	property int wifiStrength: 0    // WiFi signal strength (0-4)
+	property int wifiStrength: nativeWifi ? WifiMonitor.strength : 0    // WiFi signal strength (0-4)
 	property int loraStrength: 0    // LoRa signal strength (0-4)
 	property int gsmStrength: 0     // GSM signal strength (0-4)
 	property int batteryLevel: 0  // Battery level (0-100)
@@ -52,14 +55,14 @@ Rectangle {
 	// Update WiFi strength periodically
 	Timer {
 		interval: 5000 // Update every 5 seconds
-		running: true
+		running: !statusBar.nativeWifi
 		repeat: true
 		onTriggered: updateWifiStrength()
 	}
 
 	Component.onCompleted: {
 		updateCurrentTime();
-		updateWifiStrength();
+		if (!nativeWifi) updateWifiStrength();
 	}
 
 	// WiFi Rectangle
@@ -65,6 +65,24 @@ BaseMenu {
 		});
 	}
 
+	// External mixer changes (hardware keys, alsamixer) pushed by the C++ mixer
+	Connections {
+		target: typeof AudioMixer !== 'undefined' ? AudioMixer : null
+		function onVolumeChanged() {
+			if (!root.volumeLoaded || AudioMixer.volume === root.soundVolume)
+				return;
+			root.updatingFromSystem = true;
+			root.soundVolume = AudioMixer.volume;
+			if (AudioMixer.volume === 0) {
+				root.isMuted = true;
+				if (root.volumeBeforeMute === 0)
+					root.volumeBeforeMute = 50;
+			} else
+				root.isMuted = false;
+			root.updatingFromSystem = false;
+		}
+	}
+
 	function toggleMute() {
 		if (root.isMuted) {
 			// Unmute - restore previous volume
@@ -22,6 +22,11 @@ Rectangle {
 	function scanNetworks() {
 		isScanning = true;
 		NodeUtils.msg('wifiScanNetworks', {}, function (response) {
+			// Networks from the last run come first, while the scan goes on
+			if (response.stale) {
+				networks = response.data.networks || [];
+				return;
+			}
 			isScanning = false;
 			if (response.status === 'success') {
 				networks = response.data.networks || [];
@@ -11,6 +11,8 @@ Rectangle {
 	// WiFi state
 	property var networks: []
 	property bool isScanning: false
+	// Handle of the scan in flight, cancelled when the page goes away
+	property var scanRequest: 0
 
 	// Timer for timeout protection
 	Timer {
@@ -18,6 +20,8 @@ Rectangle {
 		interval: 10000
 		onTriggered: {
 			console.log("QML: WiFi scan timeout");
+			NodeUtils.cancel(scanRequest);
+			scanRequest = 0;
 			isScanning = false;
 		}
 	}
@@ -34,8 +38,15 @@ Rectangle {
 		scanTimeoutTimer.start();
 
 		console.log("QML: About to call NodeUtils.msg for wifiScanNetworks");
-		NodeUtils.msg("wifiScanNetworks", {}, function (response) {
+		NodeUtils.cancel(scanRequest);
+		scanRequest = NodeUtils.msg("wifiScanNetworks", {}, function (response) {
+			// Networks from the last run come first, while the scan goes on
+			if (response.stale) {
+				networks = response.data.networks || [];
+				return;
+			}
 			console.log("QML: WiFi scan callback executed!");
+			scanRequest = 0;
 			console.log("QML: WiFi scan response received:", JSON.stringify(response));
 			scanTimeoutTimer.stop();
 			isScanning = false;
@@ -85,6 +96,10 @@ Rectangle {
 		scanNetworks();
 	}
 
+	Component.onDestruction: {
+		NodeUtils.cancel(scanRequest);
+	}
+
 	ScrollView {
 		anchors.fill: parent
 		contentHeight: contentColumn.height
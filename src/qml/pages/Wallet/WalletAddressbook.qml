@@ -8,8 +8,16 @@ Rectangle {
 	color: colors.primaryBackground
 	property string title: tr("wallet.addressbook.title")
 
-	property var addressBookItems: []
+	// Rows as {guid, name, address}; patched from crypto2getAddressBookChanges instead of reloaded
+	ListModel {
+		id: addressBookModel
+	}
+	property int addressBookVersion: -1
+	readonly property int pageSize: 200
 	property bool isLoading: false
+	property bool isSyncing: false
+	property int loadGeneration: 0
+	property bool syncAgain: false
 	property string editingItemGuid: ""
 	property bool showAddDialog: false
 	property bool showEditDialog: false
@@ -22,8 +30,8 @@ Rectangle {
 		function onEventReceived(eventType, data) {
 			switch (eventType) {
 			case "crypto2.addressBook.subscribe":
-				console.log("Address book updated:", data);
-				loadAddressBook();
+				if (!data || data.version !== addressBookVersion)
+					syncAddressBook();
 				break;
 			}
 		}
@@ -33,15 +41,110 @@ Rectangle {
 		loadAddressBook();
 	}
 
+	// Full load, one page per message so the first rows show up before the rest arrive
 	function loadAddressBook() {
 		isLoading = true;
-		Node.msg("crypto2getAddressBookItems", {}, function (response) {
-			console.log("Address book items:", JSON.stringify(response, null, 2));
-			addressBookItems = response.data || [];
-			isLoading = false;
+		syncAgain = false;
+		addressBookModel.clear();
+		loadAddressBookPage(++loadGeneration, 0);
+	}
+
+	function loadAddressBookPage(generation, offset) {
+		Node.msg("crypto2getAddressBookItems", {
+			offset: offset,
+			limit: pageSize
+		}, function (response) {
+			if (generation !== loadGeneration)
+				return;
+			var items = response.data || [];
+			if (offset > 0 && response.version !== addressBookVersion) {
+				// Changed between pages, start over
+				loadAddressBook();
+				return;
+			}
+			addressBookVersion = response.version !== undefined ? response.version : -1;
+			for (var i = 0; i < items.length; i++)
+				addressBookModel.append(items[i]);
+			if (items.length > 0 && offset + items.length < (response.total || 0))
+				loadAddressBookPage(generation, offset + items.length);
+			else {
+				isLoading = false;
+				if (syncAgain) {
+					syncAgain = false;
+					syncAddressBook();
+				}
+			}
+		});
+	}
+
+	// Applies the rows changed since the version shown
+	function syncAddressBook() {
+		if (isLoading || isSyncing) {
+			syncAgain = true;
+			return;
+		}
+		isSyncing = true;
+		Node.msg("crypto2getAddressBookChanges", {
+			since: addressBookVersion
+		}, function (response) {
+			isSyncing = false;
+			if (response.status !== "success" || response.reset) {
+				loadAddressBook();
+				return;
+			}
+			applyAddressBookChanges(response);
+			if (syncAgain) {
+				syncAgain = false;
+				syncAddressBook();
+			}
 		});
 	}
 
+	function applyAddressBookChanges(changes) {
+		// Usual case, edits and additions at the end: no need to look at the other rows
+		if (changes.removed.length === 0 && applyAddressBookEdits(changes.changed)) {
+			addressBookVersion = changes.version;
+			return;
+		}
+		var removed = {};
+		for (var r = 0; r < changes.removed.length; r++)
+			removed[changes.removed[r]] = true;
+		var changed = {};
+		for (var c = 0; c < changes.changed.length; c++)
+			changed[changes.changed[c].item.guid] = true;
+		// Drop removed rows and the old copies of changed ones, then put the changed rows at their new index
+		for (var i = addressBookModel.count - 1; i >= 0; i--) {
+			var guid = addressBookModel.get(i).guid;
+			if (removed[guid] || changed[guid])
+				addressBookModel.remove(i);
+		}
+		for (var j = 0; j < changes.changed.length; j++) {
+			var row = changes.changed[j];
+			addressBookModel.insert(Math.min(row.index, addressBookModel.count), row.item);
+		}
+		addressBookVersion = changes.version;
+		if (addressBookModel.count !== changes.total)
+			loadAddressBook();
+	}
+
+	function applyAddressBookEdits(rows) {
+		// Rows come by ascending index: edits of rows shown, then new rows right after the last one
+		var count = addressBookModel.count;
+		var next = count;
+		for (var i = 0; i < rows.length; i++) {
+			var index = rows[i].index;
+			if (index < count ? addressBookModel.get(index).guid !== rows[i].item.guid : index !== next++)
+				return false;
+		}
+		for (var j = 0; j < rows.length; j++) {
+			if (rows[j].index < count)
+				addressBookModel.set(rows[j].index, rows[j].item);
+			else
+				addressBookModel.append(rows[j].item);
+		}
+		return true;
+	}
+
 	function addAddressBookItem(name, address) {
 		Node.msg("crypto2addAddressBookItem", {
 			name: name,
@@ -50,7 +153,7 @@ Rectangle {
 			console.log("Add address book item response:", JSON.stringify(response, null, 2));
 			if (response.isValid) {
 				showAddDialog = false;
-				loadAddressBook();
+				syncAddressBook();
 			} else {
 				addDialog.errorMessage = response.error || "Failed to add item";
 			}
@@ -67,7 +170,7 @@ Rectangle {
 			if (response.isValid) {
 				showEditDialog = false;
 				editingItemGuid = "";
-				loadAddressBook();
+				syncAddressBook();
 			} else {
 				editDialog.errorMessage = response.error || "Failed to edit item";
 			}
@@ -82,7 +185,7 @@ Rectangle {
 			showDeleteDialog = false;
 			deleteItemGuid = "";
 			deleteItemName = "";
-			loadAddressBook();
+			syncAddressBook();
 		});
 	}
 
@@ -127,7 +230,7 @@ Rectangle {
 
 				ListView {
 					id: listView
-					model: addressBookItems
+					model: addressBookModel
 					spacing: 10
 
 					delegate: Rectangle {
@@ -148,7 +251,7 @@ Rectangle {
 								spacing: 5
 
 								Text {
-									text: modelData.name || "Unnamed"
+									text: model.name || "Unnamed"
 									font.pixelSize: 16
 									font.bold: true
 									color: colors.primaryText
@@ -156,7 +259,7 @@ Rectangle {
 								}
 
 								Text {
-									text: modelData.address || ""
+									text: model.address || ""
 									font.pixelSize: 12
 									color: colors.secondaryText
 									wrapMode: Text.Wrap
@@ -169,9 +272,9 @@ Rectangle {
 								width: 60
 								height: 30
 								onClicked: {
-									editingItemGuid = modelData.guid;
-									editDialog.nameField = modelData.name;
-									editDialog.addressField = modelData.address;
+									editingItemGuid = model.guid;
+									editDialog.nameField = model.name;
+									editDialog.addressField = model.address;
 									showEditDialog = true;
 								}
 							}
@@ -181,8 +284,8 @@ Rectangle {
 								width: 60
 								height: 30
 								onClicked: {
-									deleteItemGuid = modelData.guid;
-									deleteItemName = modelData.name || "Unnamed";
+									deleteItemGuid = model.guid;
+									deleteItemName = model.name || "Unnamed";
 									showDeleteDialog = true;
 								}
 							}
@@ -191,10 +294,10 @@ Rectangle {
 
 					Text {
 						anchors.centerIn: parent
-						text: isLoading ? tr("common.loading") : (addressBookItems.length === 0 ? tr("wallet.addressbook.empty") : "")
+						text: isLoading ? tr("common.loading") : (addressBookModel.count === 0 ? tr("wallet.addressbook.empty") : "")
 						color: colors.secondaryText
 						font.pixelSize: 16
-						visible: isLoading || addressBookItems.length === 0
+						visible: isLoading || addressBookModel.count === 0
 					}
 				}
 			}
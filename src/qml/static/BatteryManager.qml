@@ -3,15 +3,19 @@ import QtQuick 6.8
 Item {
 	id: batteryManager
 
+	// Pushed by the native BatteryMonitor when it is available, polled through NodeJS otherwise
+	readonly property bool nativeMonitor: typeof BatteryMonitor !== 'undefined'
+
 	// Properties
-	property int batteryLevel: 0
-	property bool hasBattery: false
-	property bool charging: false
+	property int batteryLevel: nativeMonitor ? BatteryMonitor.level : 0
+	property bool hasBattery: nativeMonitor ? BatteryMonitor.hasBattery : false
+	property bool charging: nativeMonitor ? BatteryMonitor.charging : false
+	property bool acConnected: nativeMonitor ? BatteryMonitor.acConnected : false
 
 	// Internal timer for periodic updates
 	property Timer updateTimer: Timer {
 		interval: batteryStatusUpdateInterval
-		running: true
+		running: !batteryManager.nativeMonitor
 		repeat: true
 		onTriggered: batteryManager.updateBatteryStatus()
 	}
@@ -58,6 +62,6 @@ Item {
 
 	// Initialize battery info when component is created
 	Component.onCompleted: {
-		getBatteryInfo();
+		if (!nativeMonitor) getBatteryInfo();
 	}
 }
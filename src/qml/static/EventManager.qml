@@ -1,26 +1,20 @@
 import QtQuick 6.8
-import "../utils/NodeUtils.js" as Node
 
 QtObject {
 	id: eventManager
 
 	signal eventReceived(string eventType, var data)
 
-	property Timer eventTimer: Timer {
-		interval: eventsPollInterval
-		running: true
-		repeat: true
-		onTriggered: pollEvents()
+	// Events are pushed from Node.js as they happen (__nativeEmit), no polling
+	property Connections nodeEvents: Connections {
+		target: NodeJS
+		function onEventReceived(eventType, value) {
+			eventManager.eventReceived(eventType, value);
+		}
 	}
 
-	function pollEvents() {
-		Node.msg("popEvents", {}, function (response) {
-			if (response && response.length > 0) {
-				for (var i = 0; i < response.length; i++) {
-					var event = response[i];
-					eventReceived(event.type, event.value);
-				}
-			}
-		});
+	Component.onCompleted: {
+		// Only the latest address book snapshot matters to listeners
+		NodeJS.setEventCoalescing("crypto2.addressBook.subscribe", true);
 	}
 }
@@ -1,20 +1,21 @@
-// Simple wrapper for Node.js communication
-function msg(action, params, callback) {
+// Simple wrapper for Node.js communication.
+// options (optional): {timeout: ms, priority: "interactive" | "background"}.
+// Returns a handle for cancel(); 0 when there is nothing to cancel.
+// Actions with a persisted snapshot may call back twice on their first request: first with
+// the previous run's result (result.stale is true), then with the fresh one.
+function msg(action, params, callback, options) {
 	//console.log('NodeUtils.msg', action, params);
-	NodeJS.msg(action, params || {}, function (resultJson) {
-		//console.log('NodeUtils callback received JSON:', resultJson);
-		let error = null;
-		try {
-			var result = JSON.parse(resultJson);
-			//console.log('NodeUtils JSON parsed successfully:', JSON.stringify(result));
-		} catch (e) {
-			error = e;
-			console.error('NodeUtils JSON parse error:', e.message);
-			console.error('Raw JSON was:', resultJson);
-		}
-		if (!error && callback) {
+	return NodeJS.msg(action, params || {}, function (result) {
+		// Results arrive as native JS objects, no JSON.parse() on the GUI thread
+		//console.log('NodeUtils callback received:', JSON.stringify(result));
+		if (callback) {
 			//console.log('NodeUtils calling callback with result:', result);
 			callback(result);
 		}
-	});
+	}, options || {});
+}
+
+// Drop a pending request's callback, e.g. when the page that started it is closed
+function cancel(requestId) {
+	return requestId ? NodeJS.cancel(requestId) : false;
 }
@@ -0,0 +1,137 @@
+#include "include/response_cache.h"
+
+#include "include/callback_registry.h"
+
+#include <QJsonDocument>
+#include <QMutexLocker>
+
+void ResponseCache::setPolicy(const QString &action, int ttlMs) {
+	QMutexLocker locker(&m_mutex);
+	m_ttl.insert(action, qMax(0, ttlMs));
+}
+
+void ResponseCache::setInvalidation(const QString &writeAction, const QStringList &readActions) {
+	QMutexLocker locker(&m_mutex);
+	m_invalidates.insert(writeAction, readActions);
+}
+
+void ResponseCache::setEnabled(bool enabled) {
+	QMutexLocker locker(&m_mutex);
+	m_enabled = enabled;
+	if (!enabled) m_entries.clear();
+}
+
+bool ResponseCache::isCacheable(const QString &action) const {
+	QMutexLocker locker(&m_mutex);
+	return m_enabled && m_ttl.contains(action);
+}
+
+bool ResponseCache::isInvalidating(const QString &writeAction) const {
+	QMutexLocker locker(&m_mutex);
+	return m_invalidates.contains(writeAction);
+}
+
+QString ResponseCache::key(const QString &action, const QJsonObject &params) {
+	// QJsonObject keeps its keys sorted, so equal params always give the same text
+	return action + QLatin1Char('\n') + QString::fromUtf8(QJsonDocument(params).toJson(QJsonDocument::Compact));
+}
+
+ResponseCache::Lookup ResponseCache::lookup(const QString &key, const QString &action, Callback &callback, QJsonObject *result, quint64 *ticket) {
+	const qint64 now = CallbackRegistry::now();
+	QMutexLocker locker(&m_mutex);
+	Counters &counters = m_counters[action];
+
+	auto entry = m_entries.constFind(key);
+	if (entry != m_entries.constEnd()) {
+		if (entry->expires > now) {
+			counters.hits++;
+			*result = entry->result;
+			return Lookup::Hit;
+		}
+		m_entries.erase(entry);
+	}
+
+	auto inFlight = m_inFlight.find(key);
+	if (inFlight != m_inFlight.end()) {
+		counters.coalesced++;
+		inFlight->waiters.append(std::move(callback));
+		return Lookup::Joined;
+	}
+
+	counters.misses++;
+	InFlight &request = m_inFlight[key];
+	request.ticket = m_nextTicket++;
+	request.waiters.append(std::move(callback));
+	*ticket = request.ticket;
+	return Lookup::Miss;
+}
+
+void ResponseCache::complete(const QString &key, quint64 ticket, const QString &action, const QJsonObject &result) {
+	QList<Callback> waiters;
+	{
+		QMutexLocker locker(&m_mutex);
+		auto inFlight = m_inFlight.find(key);
+		if (inFlight == m_inFlight.end() || inFlight->ticket != ticket) {
+			// Retired by invalidate(): may predate the write, so it only goes to its own waiters
+			waiters = m_retired.take(ticket);
+			locker.unlock();
+			for (const Callback &waiter : waiters) waiter(result);
+			return;
+		}
+		waiters.swap(inFlight->waiters);
+		m_inFlight.erase(inFlight);
+
+		const int ttl = m_ttl.value(action);
+		if (m_enabled && ttl > 0 && result.value("status").toString() == QLatin1String("success")) {
+			const qint64 now = CallbackRegistry::now();
+			if (m_entries.size() >= kMaxEntries) purgeExpired(now);
+			if (m_entries.size() < kMaxEntries) m_entries.insert(key, Entry{result, now + ttl});
+		}
+	}
+	for (const Callback &waiter : waiters) waiter(result);
+}
+
+void ResponseCache::invalidate(const QString &writeAction) {
+	QMutexLocker locker(&m_mutex);
+	auto reads = m_invalidates.constFind(writeAction);
+	if (reads == m_invalidates.constEnd()) return;
+
+	m_invalidations++;
+	for (const QString &action : *reads) {
+		const QString prefix = action + QLatin1Char('\n');
+		for (auto it = m_entries.begin(); it != m_entries.end();) {
+			if (it.key().startsWith(prefix)) it = m_entries.erase(it);
+			else ++it;
+		}
+		for (auto it = m_inFlight.begin(); it != m_inFlight.end();) {
+			if (it.key().startsWith(prefix)) {
+				m_retired.insert(it->ticket, std::move(it->waiters));
+				it = m_inFlight.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+}
+
+QVariantMap ResponseCache::stats() const {
+	QMutexLocker locker(&m_mutex);
+	quint64 hits = 0, misses = 0, coalesced = 0;
+	QVariantMap actions;
+	for (auto it = m_counters.constBegin(); it != m_counters.constEnd(); ++it) {
+		hits += it->hits;
+		misses += it->misses;
+		coalesced += it->coalesced;
+		actions.insert(it.key(), QVariantMap{{"hits", it->hits}, {"misses", it->misses}, {"coalesced", it->coalesced}});
+	}
+	return QVariantMap{
+		{"enabled", m_enabled}, {"hits", hits}, {"misses", misses}, {"coalesced", coalesced}, {"invalidations", m_invalidations}, {"entries", m_entries.size()}, {"actions", actions},
+	};
+}
+
+void ResponseCache::purgeExpired(qint64 now) {
+	for (auto it = m_entries.begin(); it != m_entries.end();) {
+		if (it->expires <= now) it = m_entries.erase(it);
+		else ++it;
+	}
+}
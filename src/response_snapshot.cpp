@@ -0,0 +1,187 @@
+#include "include/response_snapshot.h"
+
+#include <QCborValue>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+
+// File layout, native byte order (the file never leaves the device):
+// FileHeader, FileEntry[count], then the UTF-8 keys and CBOR responses the entries point at
+static const char kSnapshotMagic[4] = {'M', 'B', 'R', 'S'};
+static const quint32 kSnapshotFormat = 1;
+// Larger responses are not worth a stale preview
+static const qsizetype kMaxResponseBytes = 512 * 1024;
+// Older responses are not shown at all
+static const qint64 kMaxAgeMs = qint64(7) * 24 * 60 * 60 * 1000;
+// An unchanged response is written again once its stored time is this old, so it doesn't age out
+static const qint64 kRefreshAgeMs = kMaxAgeMs / 7;
+
+struct FileHeader {
+	char magic[4];
+	quint32 format;
+	quint32 count;
+	quint32 reserved;
+};
+
+struct FileEntry {
+	quint32 keyOffset;
+	quint32 keyLength;
+	quint32 responseOffset;
+	quint32 responseLength;
+	qint64 savedAt;
+};
+
+ResponseSnapshot::ResponseSnapshot(const QString &path) : m_path(path) {}
+
+QString ResponseSnapshot::defaultPath() {
+	QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+	if (dir.isEmpty() || !QDir().mkpath(dir)) dir = QCoreApplication::applicationDirPath();
+	return QDir(dir).filePath("responses.snapshot");
+}
+
+void ResponseSnapshot::setPersistent(const QString &action) {
+	QMutexLocker locker(&m_mutex);
+	m_actions.insert(action);
+}
+
+void ResponseSnapshot::setEnabled(bool enabled) {
+	QMutexLocker locker(&m_mutex);
+	m_enabled = enabled;
+}
+
+bool ResponseSnapshot::isPersistent(const QString &action) const {
+	QMutexLocker locker(&m_mutex);
+	return m_enabled && m_actions.contains(action);
+}
+
+bool ResponseSnapshot::load() {
+	QMutexLocker locker(&m_mutex);
+	if (!m_enabled || m_file.isOpen()) return false;
+	m_file.setFileName(m_path);
+	if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+	const qint64 size = m_file.size();
+	const uchar *map = size >= qint64(sizeof(FileHeader)) ? m_file.map(0, size) : nullptr;
+	FileHeader header;
+	if (map) std::memcpy(&header, map, sizeof(header));
+	if (!map || std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0 || header.format != kSnapshotFormat || header.count > kMaxEntries || sizeof(FileHeader) + quint64(header.count) * sizeof(FileEntry) > quint64(size)) {
+		qWarning() << "ResponseSnapshot: Ignoring unreadable snapshot" << m_path;
+		m_file.close();
+		return false;
+	}
+
+	for (quint32 i = 0; i < header.count; i++) {
+		FileEntry entry;
+		std::memcpy(&entry, map + sizeof(FileHeader) + i * sizeof(FileEntry), sizeof(entry));
+		if (quint64(entry.keyOffset) + entry.keyLength > quint64(size) || quint64(entry.responseOffset) + entry.responseLength > quint64(size)) {
+			qWarning() << "ResponseSnapshot: Ignoring damaged snapshot" << m_path;
+			m_entries.clear();
+			m_file.close();
+			return false;
+		}
+		const QString key = QString::fromUtf8(reinterpret_cast<const char *>(map + entry.keyOffset), entry.keyLength);
+		m_entries.insert(key, Entry{QByteArray::fromRawData(reinterpret_cast<const char *>(map + entry.responseOffset), entry.responseLength), entry.savedAt, false});
+	}
+	qInfo() << "ResponseSnapshot: Mapped" << m_entries.size() << "responses from" << m_path;
+	return true;
+}
+
+bool ResponseSnapshot::takeStale(const QString &key, QJsonObject *result) {
+	QMutexLocker locker(&m_mutex);
+	if (!m_enabled) return false;
+	auto entry = m_entries.find(key);
+	if (entry == m_entries.end() || entry->served) return false;
+	entry->served = true;
+	if (QDateTime::currentMSecsSinceEpoch() - entry->savedAt > kMaxAgeMs) return false;
+
+	QCborParserError error;
+	const QCborValue response = QCborValue::fromCbor(entry->cbor, &error);
+	if (error.error != QCborError::NoError || !response.isMap()) return false;
+	*result = response.toJsonValue().toObject();
+	result->insert("stale", true);
+	result->insert("savedAt", entry->savedAt);
+	m_served++;
+	return true;
+}
+
+bool ResponseSnapshot::store(const QString &key, const QString &action, const QJsonObject &result) {
+	if (result.value("status").toString() != QLatin1String("success")) return false;
+	const QByteArray cbor = QCborValue::fromJsonValue(result).toCbor();
+	if (cbor.size() > kMaxResponseBytes) return false;
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+	QMutexLocker locker(&m_mutex);
+	if (!m_enabled || !m_actions.contains(action)) return false;
+	Entry &entry = m_entries[key];
+	// From here on the caller has fresh data, the stored response is no use this run
+	entry.served = true;
+	if (entry.cbor == cbor) {
+		// Still current; savedAt stays the time in the file until that is worth refreshing
+		if (now - entry.savedAt < kRefreshAgeMs) return false;
+		entry.savedAt = now;
+		m_dirty = true;
+		return true;
+	}
+	entry.cbor = cbor;
+	entry.savedAt = now;
+
+	if (m_entries.size() > kMaxEntries) {
+		auto oldest = std::min_element(m_entries.begin(), m_entries.end(), [](const Entry &a, const Entry &b) { return a.savedAt < b.savedAt; });
+		m_entries.erase(oldest);
+	}
+	m_dirty = true;
+	return true;
+}
+
+bool ResponseSnapshot::save() {
+	QByteArray data;
+	{
+		QMutexLocker locker(&m_mutex);
+		if (!m_dirty) return true;
+		m_dirty = false;
+
+		FileHeader header;
+		std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+		header.format = kSnapshotFormat;
+		header.count = quint32(m_entries.size());
+		header.reserved = 0;
+		data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+
+		QByteArray payload;
+		quint32 offset = quint32(sizeof(FileHeader) + m_entries.size() * sizeof(FileEntry));
+		for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+			const QByteArray key = it.key().toUtf8();
+			FileEntry entry{offset, quint32(key.size()), quint32(offset + key.size()), quint32(it->cbor.size()), it->savedAt};
+			data.append(reinterpret_cast<const char *>(&entry), sizeof(entry));
+			payload.append(key);
+			payload.append(it->cbor);
+			offset += quint32(key.size() + it->cbor.size());
+		}
+		data.append(payload);
+	}
+
+	// The mapped file stays valid: QSaveFile writes a new file and renames it over the old one
+	QSaveFile file(m_path);
+	if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+		qWarning() << "ResponseSnapshot: Cannot write" << m_path << file.errorString();
+		QMutexLocker locker(&m_mutex);
+		m_dirty = true;
+		return false;
+	}
+	QMutexLocker locker(&m_mutex);
+	m_saves++;
+	return true;
+}
+
+QVariantMap ResponseSnapshot::stats() const {
+	QMutexLocker locker(&m_mutex);
+	return QVariantMap{
+		{"enabled", m_enabled}, {"entries", m_entries.size()}, {"served", m_served}, {"saves", m_saves}, {"path", m_path},
+	};
+}
@@ -0,0 +1,93 @@
+#include "include/sysfs_handlers.h"
+
+#include "include/power_supply.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QSet>
+#include <algorithm>
+
+static const char kBacklightPath[] = "/sys/class/backlight";
+static const char kZoneInfoPath[] = "/usr/share/zoneinfo";
+
+static QStringList classDevices(const QString &path) {
+	// Class entries are symlinks to the device directories
+	return QDir(path).entryList(QDir::AllEntries | QDir::NoDotAndDotDot, QDir::Name);
+}
+
+// Same result as BatteryManager.checkBatteryStatus()
+static std::optional<QJsonObject> batteryCheckStatus(const QJsonObject &) {
+	const PowerSupplyState state = readPowerSupply();
+	if (!state.available) return std::nullopt;
+	return QJsonObject{
+		{"status", "success"},
+		{"data", QJsonObject{{"batteryLevel", state.level}, {"charging", state.charging}, {"hasBattery", state.hasBattery}}},
+	};
+}
+
+// Same result as DisplayManager.getBrightness(); brightnessctl also picks the first backlight device
+static std::optional<QJsonObject> displayGetBrightness(const QJsonObject &) {
+	const QStringList devices = classDevices(kBacklightPath);
+	if (devices.isEmpty()) return std::nullopt;
+
+	const QString base = QString(kBacklightPath) + '/' + devices.first() + '/';
+	bool currentOk = false, maxOk = false;
+	const int current = readSysfsAttribute(base + "brightness").toInt(&currentOk);
+	const int max = readSysfsAttribute(base + "max_brightness").toInt(&maxOk);
+	if (!currentOk || !maxOk || max <= 0) return std::nullopt;
+	return QJsonObject{
+		{"status", "success"},
+		{"message", "Brightness retrieved successfully"},
+		{"data", QJsonObject{{"brightness", qBound(0, qRound(current * 100.0 / max), 100)}}},
+	};
+}
+
+// Same result as TimeManager.getCurrentTimezone(); timedatectl reads the same symlink
+static std::optional<QJsonObject> timeGetCurrentTimezone(const QJsonObject &) {
+	const QString target = QFileInfo("/etc/localtime").symLinkTarget();
+	const QLatin1String marker("/zoneinfo/");
+	const qsizetype index = target.indexOf(marker);
+	if (index < 0) return std::nullopt;
+	return QJsonObject{
+		{"status", "success"},
+		{"data", QJsonObject{{"timezone", target.mid(index + marker.size())}}},
+	};
+}
+
+// Same list as TimeManager.listTimeZones(): what timedatectl list-timezones reads from
+// tzdata.zi (zones and links, plus UTC), limited to names that have a zone file, sorted
+static std::optional<QJsonObject> timeListTimeZones(const QJsonObject &) {
+	QFile file(QString(kZoneInfoPath) + "/tzdata.zi");
+	if (!file.open(QIODevice::ReadOnly)) return std::nullopt;
+
+	QSet<QString> names{QStringLiteral("UTC")};
+	while (!file.atEnd()) {
+		const QByteArray line = file.readLine();
+		if (line.size() < 3 || line[1] != ' ' || (line[0] != 'Z' && line[0] != 'L')) continue;
+		const QList<QByteArray> fields = line.simplified().split(' ');
+		// Z <zone> ... / L <target> <link>
+		const int nameField = line[0] == 'Z' ? 1 : 2;
+		if (fields.size() > nameField) names.insert(QString::fromLatin1(fields[nameField]));
+	}
+
+	QStringList zones;
+	zones.reserve(names.size());
+	for (const QString &name : std::as_const(names)) {
+		if (QFileInfo(QString(kZoneInfoPath) + '/' + name).isFile()) zones.append(name);
+	}
+	if (zones.isEmpty()) return std::nullopt;
+	// Plain code point order, like Array.prototype.sort() on the JS side
+	std::sort(zones.begin(), zones.end());
+	return QJsonObject{
+		{"status", "success"},
+		{"data", QJsonArray::fromStringList(zones)},
+	};
+}
+
+void registerSysfsHandlers(NativeHandlerRegistry &registry) {
+	registry.registerHandler("batteryCheckStatus", batteryCheckStatus);
+	registry.registerHandler("displayGetBrightness", displayGetBrightness);
+	registry.registerHandler("timeGetCurrentTimezone", timeGetCurrentTimezone);
+	registry.registerHandler("timeListTimeZones", timeListTimeZones);
+}
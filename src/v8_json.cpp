@@ -0,0 +1,151 @@
+#include "include/v8_json.h"
+
+#ifdef ENABLE_NODEJS
+
+#include <QDebug>
+#include <cmath>
+
+v8::Local<v8::Value> V8Json::toV8(v8::Isolate *isolate, v8::Local<v8::Context> context, const QJsonValue &value) {
+	switch (value.type()) {
+	case QJsonValue::Bool:
+		return v8::Boolean::New(isolate, value.toBool());
+	case QJsonValue::Double:
+		return v8::Number::New(isolate, value.toDouble());
+	case QJsonValue::String:
+		return toV8(isolate, value.toString());
+	case QJsonValue::Array:
+		return toV8(isolate, context, value.toArray());
+	case QJsonValue::Object:
+		return toV8(isolate, context, value.toObject());
+	case QJsonValue::Undefined:
+		return v8::Undefined(isolate);
+	case QJsonValue::Null:
+	default:
+		return v8::Null(isolate);
+	}
+}
+
+v8::Local<v8::Object> V8Json::toV8(v8::Isolate *isolate, v8::Local<v8::Context> context, const QJsonObject &object) {
+	v8::Local<v8::Object> result = v8::Object::New(isolate);
+	for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+		result->CreateDataProperty(context, toV8(isolate, it.key()), toV8(isolate, context, it.value())).Check();
+	}
+	return result;
+}
+
+v8::Local<v8::Array> V8Json::toV8(v8::Isolate *isolate, v8::Local<v8::Context> context, const QJsonArray &array) {
+	v8::Local<v8::Array> result = v8::Array::New(isolate, int(array.size()));
+	for (qsizetype i = 0; i < array.size(); i++) {
+		result->CreateDataProperty(context, uint32_t(i), toV8(isolate, context, array.at(i))).Check();
+	}
+	return result;
+}
+
+v8::Local<v8::String> V8Json::toV8(v8::Isolate *isolate, const QString &string) {
+	return v8::String::NewFromTwoByte(isolate, reinterpret_cast<const uint16_t *>(string.utf16()), v8::NewStringType::kNormal, int(string.size())).ToLocalChecked();
+}
+
+QString V8Json::toQString(v8::Isolate *isolate, v8::Local<v8::String> string) {
+	const int length = string->Length();
+	QString result(length, Qt::Uninitialized);
+	string->Write(isolate, reinterpret_cast<uint16_t *>(result.data()), 0, length, v8::String::NO_NULL_TERMINATION);
+	return result;
+}
+
+QJsonValue V8Json::fromV8(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value) {
+	// Throwing property getters only cost their property (see fromV8Children())
+	v8::TryCatch tryCatch(isolate);
+	std::vector<v8::Local<v8::Object>> ancestors;
+	return fromV8(isolate, context, value, 0, ancestors);
+}
+
+QJsonValue V8Json::fromV8(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Value> value, int depth, std::vector<v8::Local<v8::Object>> &ancestors) {
+	if (value.IsEmpty() || value->IsUndefined() || value->IsFunction() || value->IsSymbol()) return QJsonValue(QJsonValue::Undefined);
+	if (value->IsNull()) return QJsonValue(QJsonValue::Null);
+	if (value->IsBoolean()) return QJsonValue(value->BooleanValue(isolate));
+	if (value->IsInt32()) return QJsonValue(qint64(value.As<v8::Int32>()->Value()));
+	if (value->IsNumber()) {
+		double number = value.As<v8::Number>()->Value();
+		return std::isfinite(number) ? QJsonValue(number) : QJsonValue(QJsonValue::Null);
+	}
+	if (value->IsString()) return QJsonValue(toQString(isolate, value.As<v8::String>()));
+	if (value->IsBigInt()) {
+		v8::Local<v8::String> decimal;
+		if (!value->ToString(context).ToLocal(&decimal)) return QJsonValue(QJsonValue::Null);
+		return QJsonValue(toQString(isolate, decimal));
+	}
+	if (!value->IsObject()) return QJsonValue(QJsonValue::Undefined);
+
+	if (depth >= kMaxDepth) {
+		qWarning() << "V8Json: Maximum nesting depth exceeded, value replaced with null";
+		return QJsonValue(QJsonValue::Null);
+	}
+
+	v8::Local<v8::Object> object = value.As<v8::Object>();
+
+	// An object that contains itself; JSON.stringify() throws here, and walking on would
+	// go through every path to it up to kMaxDepth, exponential when it is referenced twice
+	for (const v8::Local<v8::Object> &ancestor : ancestors) {
+		if (ancestor == object) {
+			qWarning() << "V8Json: Circular structure, value replaced with null";
+			return QJsonValue(QJsonValue::Null);
+		}
+	}
+
+	// Honour toJSON() like JSON.stringify() does (Date, ethers' BigNumber-like types, ...).
+	// A throwing getter or toJSON() drops the value; the exception is not left to the caller.
+	v8::Local<v8::Value> replacement;
+	bool replaced = false;
+	{
+		v8::TryCatch tryCatch(isolate);
+		v8::Local<v8::Value> toJSON;
+		if (object->Get(context, v8::String::NewFromUtf8Literal(isolate, "toJSON")).ToLocal(&toJSON) && toJSON->IsFunction()) {
+			if (!toJSON.As<v8::Function>()->Call(context, object, 0, nullptr).ToLocal(&replacement)) {
+				qWarning() << "V8Json: toJSON() threw, value dropped";
+				return QJsonValue(QJsonValue::Undefined);
+			}
+			replaced = true;
+		}
+	}
+	if (replaced && (!replacement->IsObject() || replacement != value)) return fromV8(isolate, context, replacement, depth + 1, ancestors);
+
+	ancestors.push_back(object);
+	QJsonValue result = fromV8Children(isolate, context, object, depth, ancestors);
+	ancestors.pop_back();
+	return result;
+}
+
+QJsonValue V8Json::fromV8Children(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Object> object, int depth, std::vector<v8::Local<v8::Object>> &ancestors) {
+	if (object->IsArray()) {
+		v8::Local<v8::Array> array = object.As<v8::Array>();
+		const uint32_t length = array->Length();
+		QJsonArray result;
+		for (uint32_t i = 0; i < length; i++) {
+			v8::Local<v8::Value> element;
+			if (!array->Get(context, i).ToLocal(&element)) {
+				result.append(QJsonValue(QJsonValue::Null));
+				continue;
+			}
+			QJsonValue converted = fromV8(isolate, context, element, depth + 1, ancestors);
+			result.append(converted.isUndefined() ? QJsonValue(QJsonValue::Null) : converted);
+		}
+		return result;
+	}
+
+	v8::Local<v8::Array> keys;
+	if (!object->GetOwnPropertyNames(context, static_cast<v8::PropertyFilter>(v8::ONLY_ENUMERABLE | v8::SKIP_SYMBOLS), v8::KeyConversionMode::kConvertToString).ToLocal(&keys)) return QJsonValue(QJsonObject());
+
+	QJsonObject result;
+	const uint32_t keyCount = keys->Length();
+	for (uint32_t i = 0; i < keyCount; i++) {
+		v8::Local<v8::Value> key;
+		v8::Local<v8::Value> property;
+		if (!keys->Get(context, i).ToLocal(&key) || !key->IsString()) continue;
+		if (!object->Get(context, key).ToLocal(&property)) continue;
+		QJsonValue converted = fromV8(isolate, context, property, depth + 1, ancestors);
+		if (!converted.isUndefined()) result.insert(toQString(isolate, key.As<v8::String>()), converted);
+	}
+	return result;
+}
+
+#endif // ENABLE_NODEJS
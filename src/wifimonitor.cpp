@@ -0,0 +1,408 @@
+#include "include/wifimonitor.h"
+
+#include "include/power_supply.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QSocketNotifier>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <linux/genetlink.h>
+#include <linux/netlink.h>
+#include <linux/nl80211.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+// One association produces several RTM_NEWLINK messages in a row
+static const int kLinkSettleMs = 200;
+// Replies to our own requests are immediate; anything slower means nl80211 is stuck
+static const int kReplyTimeoutMs = 250;
+
+WifiMonitor::WifiMonitor(QObject *parent) : QObject(parent), m_strength(0), m_genericSocket(-1), m_nl80211Family(-1), m_sequence(0), m_linkSocket(-1), m_linkNotifier(nullptr), m_reading(false), m_refreshAgain(false) {
+	m_reader.setMaxThreadCount(1);
+	m_pollTimer.setInterval(kDefaultPollIntervalMs);
+	connect(&m_pollTimer, &QTimer::timeout, this, &WifiMonitor::refresh);
+	m_linkTimer.setSingleShot(true);
+	m_linkTimer.setInterval(kLinkSettleMs);
+	connect(&m_linkTimer, &QTimer::timeout, this, &WifiMonitor::refresh);
+
+	openLinkSocket();
+	refresh();
+	m_pollTimer.start();
+}
+
+WifiMonitor::~WifiMonitor() {
+	m_reader.waitForDone();
+#ifdef Q_OS_LINUX
+	if (m_genericSocket >= 0) ::close(m_genericSocket);
+	if (m_linkSocket >= 0) ::close(m_linkSocket);
+#endif
+}
+
+int WifiMonitor::pollInterval() const {
+	return m_pollTimer.interval();
+}
+
+void WifiMonitor::setPollInterval(int ms) {
+	if (ms <= 0 || ms == m_pollTimer.interval()) return;
+	m_pollTimer.start(ms);
+	emit pollIntervalChanged();
+}
+
+void WifiMonitor::refresh() {
+	if (m_reading) {
+		m_refreshAgain = true;
+		return;
+	}
+	m_reading = true;
+	m_reader.start([this]() {
+		const std::optional<Link> nl80211 = readNl80211();
+		const Link link = nl80211 ? *nl80211 : readProcFallback();
+		QMetaObject::invokeMethod(
+			this,
+			[this, link]() {
+				m_reading = false;
+				apply(link);
+				if (m_refreshAgain) {
+					m_refreshAgain = false;
+					refresh();
+				}
+			},
+			Qt::QueuedConnection);
+	});
+}
+
+void WifiMonitor::apply(const Link &link) {
+	const Link previous = m_link;
+	m_link = link;
+	if (!link.connected) m_link.quality = 0;
+
+	if (m_link.connected != previous.connected) emit connectedChanged();
+	if (m_link.interfaceName != previous.interfaceName) emit interfaceNameChanged();
+	if (m_link.ssid != previous.ssid) emit ssidChanged();
+	if (m_link.quality != previous.quality) emit qualityChanged();
+
+	const int strength = strengthWithHysteresis(m_link.quality, m_strength);
+	if (strength != m_strength) {
+		m_strength = strength;
+		emit strengthChanged();
+	}
+}
+
+int WifiMonitor::qualityFromDbm(int dbm) {
+	// -40 dBm and better is 100%, -100 dBm and worse is 0%, linear in between
+	const int clamped = qBound(-100, dbm, -40);
+	return 100 - (qAbs(clamped + 40) * 100) / 60;
+}
+
+int WifiMonitor::strengthFromQuality(int quality) {
+	// Same buckets as signalStrengthToBars() in wifi.js
+	if (quality <= 0) return 0;
+	if (quality >= 75) return 4;
+	if (quality >= 50) return 3;
+	if (quality >= 25) return 2;
+	return 1;
+}
+
+int WifiMonitor::strengthWithHysteresis(int quality, int previous) {
+	const int strength = strengthFromQuality(quality);
+	// Connecting and disconnecting show up at once
+	if (strength == previous || strength == 0 || previous == 0) return strength;
+	if (strength > previous) return qMax(previous, strengthFromQuality(quality - kHysteresis));
+	return qMin(previous, strengthFromQuality(quality + kHysteresis));
+}
+
+QList<WifiMonitor::ProcEntry> WifiMonitor::parseProcNetWireless(const QByteArray &text) {
+	// Inter-| sta-|   Quality        |   Discarded packets               | Missed | WE
+	//  face | tus | link level noise |  nwid  crypt   frag  retry   misc | beacon | 22
+	//  wlan0: 0000   54.  -56.  -256        0      0      0      0      0        0
+	QList<ProcEntry> entries;
+	const QList<QByteArray> lines = text.split('\n');
+	for (qsizetype i = 2; i < lines.size(); i++) {
+		const qsizetype colon = lines[i].indexOf(':');
+		if (colon < 0) continue;
+		const QList<QByteArray> fields = lines[i].mid(colon + 1).simplified().split(' ');
+		if (fields.size() < 3) continue;
+
+		auto number = [](QByteArray field) {
+			if (field.endsWith('.')) field.chop(1);
+			return field.toInt();
+		};
+		ProcEntry entry;
+		entry.interfaceName = QString::fromLatin1(lines[i].left(colon).trimmed());
+		entry.link = number(fields[1]);
+		entry.levelDbm = number(fields[2]);
+		// Some drivers report the level as an unsigned byte (256 + dBm)
+		if (entry.levelDbm > 63) entry.levelDbm -= 256;
+		entries.append(entry);
+	}
+	return entries;
+}
+
+#ifdef Q_OS_LINUX
+
+static quint32 attributeU32(const QByteArray &payload) {
+	quint32 value = 0;
+	if (payload.size() >= qsizetype(sizeof(value))) memcpy(&value, payload.constData(), sizeof(value));
+	return value;
+}
+
+static QHash<int, QByteArray> parseAttributes(const char *data, qsizetype length) {
+	QHash<int, QByteArray> attributes;
+	while (length >= qsizetype(NLA_HDRLEN)) {
+		nlattr attribute;
+		memcpy(&attribute, data, sizeof(attribute));
+		if (attribute.nla_len < NLA_HDRLEN || attribute.nla_len > length) break;
+		attributes.insert(attribute.nla_type & NLA_TYPE_MASK, QByteArray(data + NLA_HDRLEN, attribute.nla_len - NLA_HDRLEN));
+		const qsizetype step = qMin<qsizetype>(NLA_ALIGN(attribute.nla_len), length);
+		data += step;
+		length -= step;
+	}
+	return attributes;
+}
+
+// Top-level attributes of every generic netlink message in a reply
+static QList<QHash<int, QByteArray>> parseGenericMessages(const QByteArray &messages) {
+	QList<QHash<int, QByteArray>> result;
+	const char *data = messages.constData();
+	qsizetype remaining = messages.size();
+	while (remaining >= qsizetype(NLMSG_HDRLEN)) {
+		nlmsghdr header;
+		memcpy(&header, data, sizeof(header));
+		if (header.nlmsg_len < NLMSG_HDRLEN || header.nlmsg_len > remaining) break;
+		const qsizetype payload = qsizetype(header.nlmsg_len) - NLMSG_HDRLEN - GENL_HDRLEN;
+		if (payload >= 0) result.append(parseAttributes(data + NLMSG_HDRLEN + GENL_HDRLEN, payload));
+		const qsizetype step = qMin<qsizetype>(NLMSG_ALIGN(header.nlmsg_len), remaining);
+		data += step;
+		remaining -= step;
+	}
+	return result;
+}
+
+static QString attributeString(const QByteArray &payload) {
+	const qsizetype end = payload.indexOf('\0');
+	return QString::fromUtf8(end < 0 ? payload : payload.left(end));
+}
+
+QList<WifiMonitor::Interface> WifiMonitor::parseInterfaceDump(const QByteArray &messages) {
+	QList<Interface> interfaces;
+	for (const QHash<int, QByteArray> &attributes : parseGenericMessages(messages)) {
+		if (!attributes.contains(NL80211_ATTR_IFINDEX)) continue;
+		Interface entry;
+		entry.index = int(attributeU32(attributes.value(NL80211_ATTR_IFINDEX)));
+		entry.name = attributeString(attributes.value(NL80211_ATTR_IFNAME));
+		// Present while associated; the SSID is raw bytes, normally UTF-8
+		entry.ssid = QString::fromUtf8(attributes.value(NL80211_ATTR_SSID));
+		entry.station = attributeU32(attributes.value(NL80211_ATTR_IFTYPE)) == NL80211_IFTYPE_STATION;
+		interfaces.append(entry);
+	}
+	return interfaces;
+}
+
+std::optional<int> WifiMonitor::parseStationSignal(const QByteArray &messages) {
+	for (const QHash<int, QByteArray> &attributes : parseGenericMessages(messages)) {
+		const QByteArray stationInfo = attributes.value(NL80211_ATTR_STA_INFO);
+		const QByteArray signal = parseAttributes(stationInfo.constData(), stationInfo.size()).value(NL80211_STA_INFO_SIGNAL);
+		if (!signal.isEmpty()) return int(qint8(signal[0]));
+	}
+	return std::nullopt;
+}
+
+std::optional<QByteArray> WifiMonitor::genericRequest(quint16 family, quint8 command, quint16 flags, const QByteArray &attributes) {
+	nlmsghdr header = {};
+	header.nlmsg_len = NLMSG_HDRLEN + GENL_HDRLEN + quint32(attributes.size());
+	header.nlmsg_type = family;
+	header.nlmsg_flags = NLM_F_REQUEST | flags;
+	header.nlmsg_seq = ++m_sequence;
+	genlmsghdr genl = {};
+	genl.cmd = command;
+	genl.version = 1;
+
+	QByteArray request;
+	request.append(reinterpret_cast<const char *>(&header), sizeof(header));
+	request.append(reinterpret_cast<const char *>(&genl), sizeof(genl));
+	request.append(attributes);
+
+	sockaddr_nl kernel = {};
+	kernel.nl_family = AF_NETLINK;
+	if (::sendto(m_genericSocket, request.constData(), size_t(request.size()), 0, reinterpret_cast<sockaddr *>(&kernel), sizeof(kernel)) < 0) return std::nullopt;
+
+	QByteArray replies;
+	char buffer[32768];
+	for (;;) {
+		const ssize_t size = ::recv(m_genericSocket, buffer, sizeof(buffer), 0);
+		if (size <= 0) return std::nullopt;
+
+		bool done = false;
+		const char *data = buffer;
+		qsizetype remaining = size;
+		while (remaining >= qsizetype(NLMSG_HDRLEN)) {
+			nlmsghdr reply;
+			memcpy(&reply, data, sizeof(reply));
+			if (reply.nlmsg_len < NLMSG_HDRLEN || reply.nlmsg_len > remaining) break;
+			if (reply.nlmsg_seq == m_sequence) {
+				if (reply.nlmsg_type == NLMSG_DONE) {
+					done = true;
+				} else if (reply.nlmsg_type == NLMSG_ERROR) {
+					nlmsgerr error;
+					memcpy(&error, data + NLMSG_HDRLEN, qMin(sizeof(error), size_t(reply.nlmsg_len - NLMSG_HDRLEN)));
+					if (error.error != 0) return std::nullopt;
+					done = true;
+				} else {
+					replies.append(data, NLMSG_ALIGN(reply.nlmsg_len) <= remaining ? NLMSG_ALIGN(reply.nlmsg_len) : reply.nlmsg_len);
+					if (!(reply.nlmsg_flags & NLM_F_MULTI)) done = true;
+				}
+			}
+			const qsizetype step = qMin<qsizetype>(NLMSG_ALIGN(reply.nlmsg_len), remaining);
+			data += step;
+			remaining -= step;
+		}
+		if (done) return replies;
+	}
+}
+
+static QByteArray attribute(quint16 type, const void *payload, int size) {
+	nlattr header;
+	header.nla_len = quint16(NLA_HDRLEN + size);
+	header.nla_type = type;
+	QByteArray data(reinterpret_cast<const char *>(&header), sizeof(header));
+	data.append(static_cast<const char *>(payload), size);
+	data.append(QByteArray(NLA_ALIGN(size) - size, '\0'));
+	return data;
+}
+
+bool WifiMonitor::resolveNl80211() {
+	if (m_nl80211Family >= 0) return true;
+	if (m_genericSocket < 0) {
+		m_genericSocket = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+		if (m_genericSocket < 0) return false;
+		sockaddr_nl local = {};
+		local.nl_family = AF_NETLINK;
+		timeval timeout = {0, kReplyTimeoutMs * 1000};
+		if (::bind(m_genericSocket, reinterpret_cast<sockaddr *>(&local), sizeof(local)) != 0 || ::setsockopt(m_genericSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0) {
+			::close(m_genericSocket);
+			m_genericSocket = -1;
+			return false;
+		}
+	}
+
+	static const char name[] = NL80211_GENL_NAME;
+	const std::optional<QByteArray> reply = genericRequest(GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 0, attribute(CTRL_ATTR_FAMILY_NAME, name, sizeof(name)));
+	if (!reply) return false;
+	for (const QHash<int, QByteArray> &attributes : parseGenericMessages(*reply)) {
+		const QByteArray id = attributes.value(CTRL_ATTR_FAMILY_ID);
+		if (id.size() < 2) continue;
+		quint16 family;
+		memcpy(&family, id.constData(), sizeof(family));
+		m_nl80211Family = family;
+		return true;
+	}
+	return false;
+}
+
+std::optional<WifiMonitor::Link> WifiMonitor::readNl80211() {
+	if (!resolveNl80211()) return std::nullopt;
+	const std::optional<QByteArray> dump = genericRequest(quint16(m_nl80211Family), NL80211_CMD_GET_INTERFACE, NLM_F_DUMP, QByteArray());
+	if (!dump) return std::nullopt;
+
+	Link link;
+	for (const Interface &wifi : parseInterfaceDump(*dump)) {
+		if (!wifi.station) continue;
+		link.interfaceName = wifi.name;
+		link.ssid = wifi.ssid;
+		// In managed mode the only station entry is the access point we're associated with
+		const quint32 index = quint32(wifi.index);
+		const std::optional<QByteArray> stations = genericRequest(quint16(m_nl80211Family), NL80211_CMD_GET_STATION, NLM_F_DUMP, attribute(NL80211_ATTR_IFINDEX, &index, sizeof(index)));
+		link.signalDbm = stations ? parseStationSignal(*stations) : std::nullopt;
+		link.connected = link.signalDbm.has_value();
+		link.quality = link.signalDbm ? qualityFromDbm(*link.signalDbm) : 0;
+		break;
+	}
+	return link;
+}
+
+void WifiMonitor::openLinkSocket() {
+	m_linkSocket = ::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (m_linkSocket < 0) return;
+	sockaddr_nl local = {};
+	local.nl_family = AF_NETLINK;
+	local.nl_groups = RTMGRP_LINK;
+	if (::bind(m_linkSocket, reinterpret_cast<sockaddr *>(&local), sizeof(local)) != 0) {
+		::close(m_linkSocket);
+		m_linkSocket = -1;
+		qWarning() << "WifiMonitor: No rtnetlink, link changes are picked up by the poll only";
+		return;
+	}
+	m_linkNotifier = new QSocketNotifier(m_linkSocket, QSocketNotifier::Read, this);
+	connect(m_linkNotifier, &QSocketNotifier::activated, this, &WifiMonitor::readLinkEvents);
+}
+
+void WifiMonitor::readLinkEvents() {
+	char buffer[8192];
+	bool changed = false;
+	for (;;) {
+		const ssize_t size = ::recv(m_linkSocket, buffer, sizeof(buffer), 0);
+		if (size <= 0) break;
+		const char *data = buffer;
+		qsizetype remaining = size;
+		while (remaining >= qsizetype(NLMSG_HDRLEN)) {
+			nlmsghdr header;
+			memcpy(&header, data, sizeof(header));
+			if (header.nlmsg_len < NLMSG_HDRLEN || header.nlmsg_len > remaining) break;
+			if (header.nlmsg_type == RTM_NEWLINK || header.nlmsg_type == RTM_DELLINK) changed = true;
+			const qsizetype step = qMin<qsizetype>(NLMSG_ALIGN(header.nlmsg_len), remaining);
+			data += step;
+			remaining -= step;
+		}
+	}
+	if (changed && !m_linkTimer.isActive()) m_linkTimer.start();
+}
+
+#else
+
+QList<WifiMonitor::Interface> WifiMonitor::parseInterfaceDump(const QByteArray &) {
+	return {};
+}
+
+std::optional<int> WifiMonitor::parseStationSignal(const QByteArray &) {
+	return std::nullopt;
+}
+
+std::optional<QByteArray> WifiMonitor::genericRequest(quint16, quint8, quint16, const QByteArray &) {
+	return std::nullopt;
+}
+
+bool WifiMonitor::resolveNl80211() {
+	return false;
+}
+
+std::optional<WifiMonitor::Link> WifiMonitor::readNl80211() {
+	return std::nullopt;
+}
+
+void WifiMonitor::openLinkSocket() {}
+
+void WifiMonitor::readLinkEvents() {}
+
+#endif
+
+WifiMonitor::Link WifiMonitor::readProcFallback() {
+	Link link;
+	QFile file("/proc/net/wireless");
+	if (!file.open(QIODevice::ReadOnly)) return link;
+	const QList<ProcEntry> entries = parseProcNetWireless(file.readAll());
+	if (entries.isEmpty()) return link;
+
+	const ProcEntry &entry = entries.first();
+	link.interfaceName = entry.interfaceName;
+	link.connected = readSysfsAttribute("/sys/class/net/" + entry.interfaceName + "/operstate") == "up";
+	// Drivers without a dBm level only give the link quality, usually out of 70
+	link.signalDbm = entry.levelDbm < 0 ? std::optional<int>(entry.levelDbm) : std::nullopt;
+	link.quality = link.signalDbm ? qualityFromDbm(entry.levelDbm) : qBound(0, entry.link * 100 / 70, 100);
+	return link;
+}
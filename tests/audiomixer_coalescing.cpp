@@ -0,0 +1,71 @@
+// AudioMixer without a card (the in-memory volume used headless): a burst of setVolume()
+// calls, as a slider drag produces, ends up as one write and one volumeChanged carrying
+// the last value. Sets from another thread are folded the same way.
+
+#include "include/audiomixer.h"
+
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+
+static int s_failures = 0;
+
+static void check(bool ok, const QString &what) {
+	QTextStream out(stdout);
+	out << (ok ? "  ok      " : "  FAILED  ") << what << Qt::endl;
+	if (!ok) s_failures++;
+}
+
+// Runs the event loop for well over kApplyDelayMs, so a queued apply has happened
+static void settle(QCoreApplication &app) {
+	QTimer::singleShot(200, &app, &QCoreApplication::quit);
+	app.exec();
+}
+
+int main(int argc, char *argv[]) {
+	QCoreApplication app(argc, argv);
+
+	AudioMixer mixer(QString(), nullptr);
+	check(!mixer.available(), "no card: not available");
+	check(mixer.volume() == AudioMixer::kDefaultVolume, "starts at kDefaultVolume");
+
+	int changes = 0;
+	int announced = -1;
+	QObject::connect(&mixer, &AudioMixer::volumeChanged, [&] {
+		changes++;
+		announced = mixer.volume();
+	});
+
+	for (int volume = 10; volume <= 73; volume++) mixer.setVolume(volume);
+	check(mixer.volume() == 73, "the pending set is read back before it is applied");
+	check(changes == 0, "nothing announced before the event loop runs");
+	settle(app);
+	check(changes == 1, QString("one volumeChanged for 64 sets (got %1)").arg(changes));
+	check(announced == 73 && mixer.volume() == 73, "announced the last value");
+
+	changes = 0;
+	mixer.setVolume(73);
+	settle(app);
+	check(changes == 0, "setting the current volume announces nothing");
+
+	changes = 0;
+	mixer.setVolume(140);
+	mixer.setVolume(-5);
+	settle(app);
+	check(changes == 1 && mixer.volume() == 0, "out-of-range sets are clamped, only the last is applied");
+
+	// Native handlers call setVolume() from their worker pool
+	changes = 0;
+	QThread *worker = QThread::create([&mixer] {
+		for (int volume = 100; volume >= 40; volume--) mixer.setVolume(volume);
+	});
+	worker->start();
+	worker->wait();
+	delete worker;
+	settle(app);
+	check(changes == 1 && announced == 40, "a burst from another thread is one volumeChanged with the last value");
+
+	if (s_failures) QTextStream(stdout) << s_failures << " check(s) failed" << Qt::endl;
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+// BatteryMonitor on a fake power_supply tree: BAT0 and AC in a temporary directory, read
+// through the same readPowerSupply() as /sys/class/power_supply. Files are rewritten and
+// refresh() called by hand, so the poll timer never has to fire.
+
+#include "include/batterymonitor.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVariant>
+
+static int s_failures = 0;
+
+static void check(bool ok, const QString &what) {
+	QTextStream out(stdout);
+	out << (ok ? "  ok      " : "  FAILED  ") << what << Qt::endl;
+	if (!ok) s_failures++;
+}
+
+static void write(const QString &path, const QByteArray &value) {
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		check(false, "write " + path);
+		return;
+	}
+	// sysfs attributes end in a newline
+	file.write(value + '\n');
+}
+
+// Signals emitted by one monitor since the last reset()
+struct Emitted {
+	int hasBattery = 0;
+	int level = 0;
+	int charging = 0;
+	int acConnected = 0;
+
+	void reset() { *this = Emitted(); }
+};
+
+int main(int argc, char *argv[]) {
+	QCoreApplication app(argc, argv);
+
+	QTemporaryDir root;
+	if (!root.isValid()) {
+		check(false, "temporary directory");
+		return 1;
+	}
+	const QDir dir(root.path());
+	dir.mkdir("BAT0");
+	dir.mkdir("AC");
+	const QString battery = dir.filePath("BAT0") + '/';
+	const QString ac = dir.filePath("AC") + '/';
+	write(battery + "type", "Battery");
+	write(battery + "capacity", "57");
+	write(battery + "status", "Discharging");
+	write(ac + "type", "Mains");
+	write(ac + "online", "0");
+
+	BatteryMonitor monitor(root.path(), nullptr);
+	check(!monitor.isListening(), "no uevent socket for a fake tree");
+	check(monitor.hasBattery(), "hasBattery");
+	check(monitor.level() == 57, "level 57");
+	check(!monitor.charging(), "discharging");
+	check(!monitor.acConnected(), "AC offline");
+	check(monitor.property("level").toInt() == 57 && monitor.property("hasBattery").toBool(), "read through the QML properties");
+
+	Emitted emitted;
+	QObject::connect(&monitor, &BatteryMonitor::hasBatteryChanged, [&] { emitted.hasBattery++; });
+	QObject::connect(&monitor, &BatteryMonitor::levelChanged, [&] { emitted.level++; });
+	QObject::connect(&monitor, &BatteryMonitor::chargingChanged, [&] { emitted.charging++; });
+	QObject::connect(&monitor, &BatteryMonitor::acConnectedChanged, [&] { emitted.acConnected++; });
+
+	monitor.refresh();
+	check(emitted.hasBattery + emitted.level + emitted.charging + emitted.acConnected == 0, "refresh without changes emits nothing");
+
+	// Plugged in: AC online and charging, capacity unchanged
+	write(ac + "online", "1");
+	write(battery + "status", "Charging");
+	monitor.refresh();
+	check(monitor.acConnected() && monitor.charging(), "plugged in: AC online, charging");
+	check(emitted.acConnected == 1 && emitted.charging == 1, "plugged in: acConnectedChanged and chargingChanged once");
+	check(emitted.level == 0 && emitted.hasBattery == 0, "plugged in: level and hasBattery not signalled");
+
+	emitted.reset();
+	write(battery + "capacity", "58");
+	monitor.refresh();
+	check(monitor.level() == 58, "level 58");
+	check(emitted.level == 1 && emitted.charging == 0 && emitted.acConnected == 0, "only levelChanged for a new capacity");
+
+	// Out-of-range capacity is clamped
+	emitted.reset();
+	write(battery + "capacity", "104");
+	monitor.refresh();
+	check(monitor.level() == 100 && emitted.level == 1, "capacity 104 clamped to 100");
+
+	// Battery removed
+	emitted.reset();
+	QFile::remove(battery + "capacity");
+	monitor.refresh();
+	check(!monitor.hasBattery() && emitted.hasBattery == 1, "battery without capacity: hasBatteryChanged");
+	check(monitor.acConnected() && emitted.acConnected == 0, "AC still online");
+
+	if (s_failures) QTextStream(stdout) << s_failures << " check(s) failed" << Qt::endl;
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+// NativeCrypto against published test vectors: keccak-256 (including inputs around the
+// 136-byte rate), the EIP-55 examples, the BIP-39 "TREZOR" seed, BIP-32 test vector 1 and
+// the Hardhat/Anvil default account every Ethereum developer can check by hand.
+
+#include "include/native_crypto.h"
+
+#include <QTextStream>
+
+static int s_failures = 0;
+
+static void check(bool ok, const QString &what) {
+	QTextStream out(stdout);
+	out << (ok ? "  ok      " : "  FAILED  ") << what << Qt::endl;
+	if (!ok) s_failures++;
+}
+
+static QString hex(const QByteArray &data) {
+	return QString::fromLatin1(data.toHex());
+}
+
+static void keccak() {
+	check(hex(NativeCrypto::keccak256(QByteArray())) == "c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470", "keccak256 of the empty string");
+	check(hex(NativeCrypto::keccak256("hello world")) == "47173285a8d7341e5e972fc677286384f802f8ef42a5ec5f03bbfa254cb01fad", "keccak256 of \"hello world\"");
+	// One byte short of a block, exactly one (padding gets a block of its own) and one over
+	check(hex(NativeCrypto::keccak256(QByteArray(135, 'a'))) == "34367dc248bbd832f4e3e69dfaac2f92638bd0bbd18f2912ba4ef454919cf446", "keccak256 of 135 bytes");
+	check(hex(NativeCrypto::keccak256(QByteArray(136, 'a'))) == "a6c4d403279fe3e0af03729caada8374b5ca54d8065329a3ebcaeb4b60aa386e", "keccak256 of 136 bytes");
+	check(hex(NativeCrypto::keccak256(QByteArray(137, 'a'))) == "d869f639c7046b4929fc92a4d988a8b22c55fbadb802c0c66ebcd484f1915f39", "keccak256 of 137 bytes");
+	check(hex(NativeCrypto::keccak256(QByteArray(272, 'a'))) == "cf7fcd4f705ee749930d19ca84561a9bf62516bd90a471545fa2f49fdc7e63c8", "keccak256 of two full blocks");
+}
+
+static void eip55() {
+	// From EIP-55 itself
+	static const char *const kAddresses[] = {
+		"0x5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAed",
+		"0xfB6916095ca1df60bB79Ce92cE3Ea74c37c5d359",
+		"0xdbF03B407c01E7cD3CBea99509d93f8DDDC8C6FB",
+		"0xD1220A0cf47c7B9Be7A2E6BA89F429762e7b9aDb",
+	};
+	for (const char *address : kAddresses) {
+		const QString expected = QString::fromLatin1(address);
+		check(NativeCrypto::checksumAddress(expected.toLower()) == expected, "EIP-55 " + expected);
+		check(NativeCrypto::checksumAddress(expected) == expected, "EIP-55 " + expected + " accepted as is");
+	}
+	check(NativeCrypto::checksumAddress("0x5aAeb6053F3E94C9b9A09f33669435E7Ef1BeAeD").isEmpty(), "EIP-55 wrong checksum rejected");
+	check(NativeCrypto::checksumAddress("0x5aaeb6053f3e94c9b9a09f33669435e7ef1beae").isEmpty(), "EIP-55 39 digits rejected");
+}
+
+static void bip39() {
+	const QByteArray seed = NativeCrypto::mnemonicToSeed("abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about", "TREZOR");
+	check(hex(seed) == "c55257c360c07c72029aebc1b53c05ed0362ada38ead3e3e9efa3708e53495531f09a6987599d18264c1e1c92f2cf141630c7a3c4ab7c81b2f001698e7463b04", "BIP-39 seed, passphrase TREZOR");
+}
+
+static void bip32() {
+	// Test vector 1: hardened (') and normal steps alternate
+	const QByteArray seed = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f");
+	static const struct {
+		const char *path;
+		const char *privateKey;
+	} kChain[] = {
+		{"m", "e8f32e723decf4051aefac8e2c93c9c5b214313817cdb01a1494b917c8436b35"},
+		{"m/0'", "edb2e14f9ee77d26dd93b4ecede8d16ed408ce149b6cd80b0715a2d911a0afea"},
+		{"m/0'/1", "3c6cb8d0f6a264c91ea8b5030fadaa8e538b020f0a387421a12de9319dc93368"},
+		{"m/0'/1/2'", "cbce0d719ecf7431d88e6a89fa1483e02e35092af60c042b1df2ff59fa424dca"},
+		{"m/0'/1/2'/2", "0f479245fb19a38a1954c5c7c0ebab2f9bdfd96a17563ef28a6a4b1a2a764ef4"},
+		{"m/0'/1/2'/2/1000000000", "471b76e389e528d6de6d816857e012c5455051cad6660850e58372a6c3e6e7c8"},
+	};
+	for (const auto &step : kChain) {
+		QString error;
+		const QByteArray key = NativeCrypto::deriveKey(seed, QString::fromLatin1(step.path), &error);
+		check(hex(key) == QLatin1String(step.privateKey), QString("BIP-32 vector 1 %1").arg(QString::fromLatin1(step.path)));
+	}
+	QString error;
+	check(NativeCrypto::deriveKey(seed, "m/0'/x", &error).isEmpty() && !error.isEmpty(), "BIP-32 malformed path rejected");
+	check(hex(NativeCrypto::publicKey(NativeCrypto::deriveKey(seed, "m"), true)) == "0339a36013301597daef41fbe593a02cc513d0b55527ec2df1050e2e8ff49c85c2", "BIP-32 vector 1 m public key");
+}
+
+static void defaultAccount() {
+	const QByteArray seed = NativeCrypto::mnemonicToSeed("test test test test test test test test test test test junk");
+	const QByteArray privateKey = NativeCrypto::deriveKey(seed, NativeCrypto::kDefaultPath);
+	check(hex(privateKey) == "ac0974bec39a17e36ba4a6b4d238ff944bacb478cbed5efcae784d7bf4f2ff80", "test...junk private key at m/44'/60'/0'/0/0");
+	check(NativeCrypto::address(NativeCrypto::publicKey(privateKey)) == "0xf39Fd6e51aad88F6F4ce6aB8827279cffFb92266", "test...junk address");
+
+	// Keys are taken with or without 0x, like new ethers.Wallet(key)
+	check(NativeCrypto::parsePrivateKey("0xac0974bec39a17e36ba4a6b4d238ff944bacb478cbed5efcae784d7bf4f2ff80") == privateKey, "private key with 0x");
+	check(NativeCrypto::parsePrivateKey("ac0974bec39a17e36ba4a6b4d238ff944bacb478cbed5efcae784d7bf4f2ff80") == privateKey, "private key without 0x");
+	check(NativeCrypto::parsePrivateKey("0xac0974bec39a17e36ba4a6b4d238ff944bacb478cbed5efcae784d7bf4f2ff8").isEmpty(), "private key of 63 digits rejected");
+	check(NativeCrypto::parsePrivateKey("0xzc0974bec39a17e36ba4a6b4d238ff944bacb478cbed5efcae784d7bf4f2ff80").isEmpty(), "private key with a non-hex digit rejected");
+	check(NativeCrypto::parsePrivateKey(QString(64, QLatin1Char('0'))).isEmpty(), "private key 0 rejected");
+	check(NativeCrypto::parsePrivateKey("fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141").isEmpty(), "private key n rejected");
+}
+
+int main() {
+	keccak();
+	eip55();
+	bip39();
+	bip32();
+	defaultAccount();
+	if (s_failures) QTextStream(stdout) << s_failures << " check(s) failed" << Qt::endl;
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+// WifiMonitor parsers against the replies in tests/fixtures: nl80211 interface and station
+// dumps as genericRequest() returns them, and /proc/net/wireless as the kernel prints it.
+//
+// The .hex fixtures are one netlink message per block, '#' starts a comment.
+
+#include "include/wifimonitor.h"
+
+#include <QFile>
+#include <QTextStream>
+
+static int s_failures = 0;
+
+static void check(bool ok, const QString &what) {
+	QTextStream out(stdout);
+	out << (ok ? "  ok      " : "  FAILED  ") << what << Qt::endl;
+	if (!ok) s_failures++;
+}
+
+static QByteArray fixture(const QString &name) {
+	QFile file(QStringLiteral(WALLET_TEST_FIXTURES "/") + name);
+	if (!file.open(QIODevice::ReadOnly)) {
+		check(false, "open " + file.fileName());
+		return QByteArray();
+	}
+	const QByteArray data = file.readAll();
+	if (!name.endsWith(".hex")) return data;
+
+	QByteArray hex;
+	for (const QByteArray &line : data.split('\n')) {
+		const qsizetype comment = line.indexOf('#');
+		hex += (comment < 0 ? line : line.left(comment)).simplified().replace(' ', "");
+	}
+	return QByteArray::fromHex(hex);
+}
+
+static void interfaceDump() {
+	const QList<WifiMonitor::Interface> interfaces = WifiMonitor::parseInterfaceDump(fixture("nl80211_interface_dump.hex"));
+	// The P2P device has no netdev and so no ifindex
+	check(interfaces.size() == 1, "interface dump: P2P device without ifindex skipped");
+	if (interfaces.isEmpty()) return;
+	check(interfaces[0].index == 3, "interface dump: ifindex");
+	check(interfaces[0].name == "wlan0", "interface dump: name");
+	check(interfaces[0].ssid == QString::fromUtf8("Café 5G"), "interface dump: UTF-8 SSID");
+	check(interfaces[0].station, "interface dump: station");
+
+	const QList<WifiMonitor::Interface> idle = WifiMonitor::parseInterfaceDump(fixture("nl80211_interface_dump_disconnected.hex"));
+	check(idle.size() == 2, "disconnected dump: both interfaces");
+	if (idle.size() != 2) return;
+	check(idle[0].name == "wlan0" && idle[0].station && idle[0].ssid.isEmpty(), "disconnected dump: station without SSID");
+	check(idle[1].name == "ap0" && idle[1].index == 5 && !idle[1].station && idle[1].ssid == "Hotspot", "disconnected dump: access point is not a station");
+
+	check(WifiMonitor::parseInterfaceDump(QByteArray()).isEmpty(), "interface dump: empty reply");
+	const QByteArray full = fixture("nl80211_interface_dump.hex");
+	check(WifiMonitor::parseInterfaceDump(full.left(full.size() - 7)).size() == 1, "interface dump: truncated last message dropped");
+}
+
+static void stationSignal() {
+	const std::optional<int> signal = WifiMonitor::parseStationSignal(fixture("nl80211_station_dump.hex"));
+	check(signal == -52, "station dump: signal from nested STA_INFO");
+	check(!WifiMonitor::parseStationSignal(fixture("nl80211_station_dump_nosignal.hex")), "station dump: no SIGNAL attribute");
+	check(!WifiMonitor::parseStationSignal(QByteArray()), "station dump: not associated");
+	check(WifiMonitor::qualityFromDbm(-52) == 80, "quality of -52 dBm");
+}
+
+static void procNetWireless() {
+	const QList<WifiMonitor::ProcEntry> entries = WifiMonitor::parseProcNetWireless(fixture("proc_net_wireless.txt"));
+	check(entries.size() == 1, "/proc/net/wireless: one row");
+	if (!entries.isEmpty()) check(entries[0].interfaceName == "wlan0" && entries[0].link == 54 && entries[0].levelDbm == -56, "/proc/net/wireless: wlan0 link 54 level -56");
+
+	const QList<WifiMonitor::ProcEntry> unsignedLevel = WifiMonitor::parseProcNetWireless(fixture("proc_net_wireless_unsigned.txt"));
+	check(unsignedLevel.size() == 2, "/proc/net/wireless unsigned: two rows");
+	if (unsignedLevel.size() == 2) {
+		check(unsignedLevel[0].levelDbm == -61, "/proc/net/wireless unsigned: 195 is -61 dBm");
+		check(unsignedLevel[1].interfaceName == "wlp2s0" && unsignedLevel[1].link == 60 && unsignedLevel[1].levelDbm == 0, "/proc/net/wireless: no level, link only");
+	}
+
+	check(WifiMonitor::parseProcNetWireless(fixture("proc_net_wireless_empty.txt")).isEmpty(), "/proc/net/wireless: header only");
+}
+
+int main() {
+	interfaceDump();
+	stationSignal();
+	procNetWireless();
+	if (s_failures) QTextStream(stdout) << s_failures << " check(s) failed" << Qt::endl;
+	return s_failures ? 1 : 0;
+}